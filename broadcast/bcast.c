@@ -0,0 +1,334 @@
+#include "bcast.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../hierarchy/hierarchy.h"
+
+#define BCAST_TAG 40
+// Bytes per round through the node window (two rounds are in flight)
+#define HIERARCHY_CHUNK (1 << 20)
+// Shorter messages go through the leaders as messages: two node barriers
+// cost more than copying them through the MPI stack
+#define HIERARCHY_WINDOW_MIN (64 << 10)
+
+// Position of a rank in a broadcast tree, in ranks relative to the root
+typedef struct {
+    int parent;     // -1 on the root
+    int* children;  // in the order they are served
+    int n_children;
+} TreeNode;
+
+static int absolute(int relative, int root, int n_processes) {
+    return (relative + root) % n_processes;
+}
+
+// Children of `relative` in the tree of `algorithm`; the binomial tree
+// serves the largest subtree first
+static int build_node(TreeNode* node, BcastAlgorithm algorithm,
+                      int relative, int n_processes) {
+    int max_children = 1;
+    if (algorithm == BCAST_LINEAR) {
+        max_children = n_processes;
+    } else if (algorithm == BCAST_BINOMIAL) {
+        while ((1 << max_children) < n_processes) max_children++;
+    }
+    node->children = malloc(sizeof(int) * max_children);
+    if (!node->children) return MPI_ERR_NO_MEM;
+    node->n_children = 0;
+    node->parent = -1;
+
+    if (algorithm == BCAST_LINEAR) {
+        if (relative == 0) {
+            for (int r = 1; r < n_processes; r++) {
+                node->children[node->n_children++] = r;
+            }
+        } else {
+            node->parent = 0;
+        }
+    } else if (algorithm == BCAST_CHAIN) {
+        if (relative > 0) node->parent = relative - 1;
+        if (relative + 1 < n_processes) {
+            node->children[node->n_children++] = relative + 1;
+        }
+    } else {
+        // The parent clears the lowest set bit; children set a lower bit
+        int mask = 1;
+        while (mask < n_processes && !(relative & mask)) mask <<= 1;
+        if (relative > 0) node->parent = relative - mask;
+        for (mask >>= 1; mask > 0; mask >>= 1) {
+            if (relative + mask < n_processes) {
+                node->children[node->n_children++] = relative + mask;
+            }
+        }
+    }
+    return MPI_SUCCESS;
+}
+
+// Segmented tree broadcast: receive a segment from the parent, forward it
+// to all children without waiting, and only wait for those sends after the
+// next segment was forwarded, so that two segments are in flight per link
+static int tree_bcast(char* buffer, int count, MPI_Datatype datatype,
+                      int root, MPI_Comm comm, BcastAlgorithm algorithm,
+                      int segment_size) {
+    int n_processes = 0, id = 0, type_size = 0;
+    MPI_Aint lower_bound = 0, extent = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Comm_rank(comm, &id);
+    MPI_Type_size(datatype, &type_size);
+    MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+    int relative = (id - root + n_processes) % n_processes;
+    TreeNode node;
+    int err = build_node(&node, algorithm, relative, n_processes);
+    if (err != MPI_SUCCESS) return err;
+
+    int segment_count = count;
+    if (segment_size > 0 && type_size > 0) {
+        segment_count = segment_size / type_size;
+        if (segment_count < 1) segment_count = 1;
+        if (segment_count > count) segment_count = count;
+    }
+    int n_segments =
+        segment_count > 0 ? (count + segment_count - 1) / segment_count : 0;
+
+    MPI_Request* requests =
+        malloc(sizeof(MPI_Request) * 2 * (node.n_children + 1));
+    if (!requests) {
+        free(node.children);
+        return MPI_ERR_NO_MEM;
+    }
+    MPI_Request* in_flight[2] = {requests, requests + node.n_children + 1};
+
+    for (int s = 0; s < n_segments && err == MPI_SUCCESS; s++) {
+        char* segment = buffer + (MPI_Aint)s * segment_count * extent;
+        int n = s == n_segments - 1 ? count - s * segment_count
+                                    : segment_count;
+        if (node.parent >= 0) {
+            err = MPI_Recv(segment, n, datatype,
+                           absolute(node.parent, root, n_processes),
+                           BCAST_TAG, comm, MPI_STATUS_IGNORE);
+        }
+        for (int c = 0; c < node.n_children && err == MPI_SUCCESS; c++) {
+            err = MPI_Isend(segment, n, datatype,
+                            absolute(node.children[c], root, n_processes),
+                            BCAST_TAG, comm, &in_flight[s % 2][c]);
+        }
+        if (s > 0 && err == MPI_SUCCESS) {
+            err = MPI_Waitall(node.n_children, in_flight[(s - 1) % 2],
+                              MPI_STATUSES_IGNORE);
+        }
+    }
+    if (n_segments > 0 && err == MPI_SUCCESS) {
+        err = MPI_Waitall(node.n_children, in_flight[(n_segments - 1) % 2],
+                          MPI_STATUSES_IGNORE);
+    }
+
+    free(requests);
+    free(node.children);
+    return err;
+}
+
+// Elements of block `block` when `count` elements are cut into blocks of
+// `block_count` (the last ones may be short or empty)
+static int block_length(int block, int block_count, int count) {
+    int first = block * block_count;
+    if (first >= count) return 0;
+    return first + block_count <= count ? block_count : count - first;
+}
+
+static int blocks_length(int first, int last, int block_count, int count) {
+    int length = 0;
+    for (int b = first; b < last; b++) {
+        length += block_length(b, block_count, count);
+    }
+    return length;
+}
+
+// van de Geijn: relative rank r ends the scatter owning block r, then p - 1
+// ring steps pass every block once around. About 2 * count elements cross
+// each link instead of log2(p) * count, which wins for long messages.
+static int scatter_allgather_bcast(char* buffer, int count,
+                                   MPI_Datatype datatype, int root,
+                                   MPI_Comm comm) {
+    int n_processes = 0, id = 0;
+    MPI_Aint lower_bound = 0, extent = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Comm_rank(comm, &id);
+    MPI_Type_get_extent(datatype, &lower_bound, &extent);
+    if (n_processes == 1 || count == 0) return MPI_SUCCESS;
+
+    int relative = (id - root + n_processes) % n_processes;
+    int block_count = (count + n_processes - 1) / n_processes;
+    int err = MPI_SUCCESS;
+
+    // Binomial scatter: the subtree of relative rank r holds blocks
+    // [r, r + subtree size)
+    int mask = 1;
+    while (mask < n_processes) {
+        if (relative & mask) {
+            int last = relative + mask < n_processes ? relative + mask
+                                                     : n_processes;
+            int n = blocks_length(relative, last, block_count, count);
+            err = MPI_Recv(buffer + (MPI_Aint)relative * block_count * extent,
+                           n, datatype,
+                           absolute(relative - mask, root, n_processes),
+                           BCAST_TAG, comm, MPI_STATUS_IGNORE);
+            break;
+        }
+        mask <<= 1;
+    }
+    for (mask >>= 1; mask > 0 && err == MPI_SUCCESS; mask >>= 1) {
+        int child = relative + mask;
+        if (child >= n_processes) continue;
+        int last = child + mask < n_processes ? child + mask : n_processes;
+        int n = blocks_length(child, last, block_count, count);
+        err = MPI_Send(buffer + (MPI_Aint)child * block_count * extent, n,
+                       datatype, absolute(child, root, n_processes),
+                       BCAST_TAG, comm);
+    }
+
+    // Ring allgather: in step s pass on the block received in step s - 1
+    int left = absolute((relative - 1 + n_processes) % n_processes, root,
+                        n_processes);
+    int right = absolute((relative + 1) % n_processes, root, n_processes);
+    for (int s = 0; s < n_processes - 1 && err == MPI_SUCCESS; s++) {
+        int send_block = (relative - s + n_processes) % n_processes;
+        int recv_block = (relative - s - 1 + n_processes) % n_processes;
+        err = MPI_Sendrecv(
+            buffer + (MPI_Aint)send_block * block_count * extent,
+            block_length(send_block, block_count, count), datatype, right,
+            BCAST_TAG, buffer + (MPI_Aint)recv_block * block_count * extent,
+            block_length(recv_block, block_count, count), datatype, left,
+            BCAST_TAG, comm, MPI_STATUS_IGNORE);
+    }
+    return err;
+}
+
+// Node rank of the rank `id` of `comm`
+static int node_rank_of(const Hierarchy* hierarchy, MPI_Comm comm, int id,
+                        int* node_rank) {
+    MPI_Group group, node_group;
+    MPI_Comm_group(comm, &group);
+    MPI_Comm_group(hierarchy->node_comm, &node_group);
+    int err = MPI_Group_translate_ranks(group, 1, &id, node_group, node_rank);
+    MPI_Group_free(&node_group);
+    MPI_Group_free(&group);
+    return err;
+}
+
+// Short messages: a binomial tree inside the root's node rooted at the root
+// itself, then one between the leaders and one inside every other node from
+// its leader. The root only sends, so its buffer stays read-only and the
+// leader of its node gets the message once.
+static int two_level_bcast(char* buffer, int count, MPI_Datatype datatype,
+                           int root, MPI_Comm comm, const Hierarchy* hierarchy,
+                           int segment_size) {
+    int id = 0, err = MPI_SUCCESS;
+    MPI_Comm_rank(comm, &id);
+    int root_node = hierarchy->node_of[root];
+    int on_root_node = hierarchy->node_of[id] == root_node;
+    if (on_root_node) {
+        int node_root = 0;
+        err = node_rank_of(hierarchy, comm, root, &node_root);
+        if (err == MPI_SUCCESS) {
+            err = tree_bcast(buffer, count, datatype, node_root,
+                             hierarchy->node_comm, BCAST_BINOMIAL,
+                             segment_size);
+        }
+    }
+    if (hierarchy->leader_comm != MPI_COMM_NULL && hierarchy->n_nodes > 1 &&
+        err == MPI_SUCCESS) {
+        err = tree_bcast(buffer, count, datatype, root_node,
+                         hierarchy->leader_comm, BCAST_BINOMIAL,
+                         segment_size);
+    }
+    if (on_root_node || err != MPI_SUCCESS) return err;
+    return tree_bcast(buffer, count, datatype, 0, hierarchy->node_comm,
+                      BCAST_BINOMIAL, segment_size);
+}
+
+// The root stores a chunk into its node's window, the leaders broadcast it
+// between the nodes straight from and into their windows, and every rank
+// copies it out: one store and one load per rank instead of MPI messages
+// inside the node. Chunk c uses half c % 2 of the window, so the sync that
+// opens chunk c + 1 is enough to know that all ranks finished loading c
+// before the root overwrites that half with c + 2.
+static int hierarchical_bcast(char* buffer, int count, MPI_Datatype datatype,
+                              int root, MPI_Comm comm, int segment_size) {
+    int n_processes = 0, id = 0, type_size = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Comm_rank(comm, &id);
+    MPI_Type_size(datatype, &type_size);
+    if (n_processes == 1 || count == 0) return MPI_SUCCESS;
+
+    Hierarchy* hierarchy = NULL;
+    int err = hierarchy_get(comm, &hierarchy);
+    if (err != MPI_SUCCESS) return err;
+    MPI_Aint bytes = (MPI_Aint)count * type_size;
+    if (bytes < HIERARCHY_WINDOW_MIN) {
+        return two_level_bcast(buffer, count, datatype, root, comm, hierarchy,
+                               segment_size);
+    }
+    MPI_Aint chunk = bytes < HIERARCHY_CHUNK ? bytes : HIERARCHY_CHUNK;
+    err = hierarchy_reserve(hierarchy, 2 * chunk);
+
+    int root_node = hierarchy->node_of[root];
+    int inter_node = hierarchy->leader_comm != MPI_COMM_NULL &&
+                     hierarchy->n_nodes > 1;
+    for (MPI_Aint offset = 0, c = 0; offset < bytes && err == MPI_SUCCESS;
+         offset += chunk, c++) {
+        int n = (int)(bytes - offset < chunk ? bytes - offset : chunk);
+        char* slot = hierarchy->base + (c % 2) * chunk;
+        if (id == root) memcpy(slot, buffer + offset, n);
+        err = hierarchy_sync(hierarchy);
+        if (inter_node && err == MPI_SUCCESS) {
+            err = tree_bcast(slot, n, MPI_BYTE, root_node,
+                             hierarchy->leader_comm, BCAST_BINOMIAL,
+                             segment_size);
+        }
+        if (err == MPI_SUCCESS) err = hierarchy_sync(hierarchy);
+        if (id != root) memcpy(buffer + offset, slot, n);
+    }
+    return err;
+}
+
+int bcast(void* buffer, int count, MPI_Datatype datatype, int root,
+          MPI_Comm comm, BcastAlgorithm algorithm, int segment_size) {
+    int n_processes = 0;
+    MPI_Comm_size(comm, &n_processes);
+    if (root < 0 || root >= n_processes || count < 0) return MPI_ERR_ARG;
+
+    switch (algorithm) {
+        case BCAST_LINEAR:
+        case BCAST_BINOMIAL:
+        case BCAST_CHAIN:
+            return tree_bcast(buffer, count, datatype, root, comm, algorithm,
+                              segment_size);
+        case BCAST_SCATTER_ALLGATHER:
+            return scatter_allgather_bcast(buffer, count, datatype, root,
+                                           comm);
+        case BCAST_HIERARCHICAL:
+            return hierarchical_bcast(buffer, count, datatype, root, comm,
+                                      segment_size);
+        default:
+            return MPI_ERR_ARG;
+    }
+}
+
+const char* bcast_algorithm_name(BcastAlgorithm algorithm) {
+    switch (algorithm) {
+        case BCAST_LINEAR:
+            return "linear";
+        case BCAST_BINOMIAL:
+            return "binomial";
+        case BCAST_CHAIN:
+            return "chain";
+        case BCAST_SCATTER_ALLGATHER:
+            return "scatter-allgather";
+        case BCAST_HIERARCHICAL:
+            return "hierarchical";
+        default:
+            return "unknown";
+    }
+}
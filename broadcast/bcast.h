@@ -0,0 +1,31 @@
+#ifndef BCAST_H
+#define BCAST_H
+
+#include <mpi.h>
+
+// Broadcast algorithms; all of them work for any root, process count and count
+typedef enum {
+    BCAST_LINEAR = 0,          // root sends to every other rank
+    BCAST_BINOMIAL,            // binomial tree, log2(p) rounds
+    BCAST_CHAIN,               // pipeline root -> root + 1 -> ... (any segment
+                               // is forwarded as soon as it arrives)
+    BCAST_SCATTER_ALLGATHER,   // binomial scatter of p blocks, then ring
+                               // allgather (van de Geijn)
+    BCAST_HIERARCHICAL,        // binomial tree between node leaders, shared
+                               // memory window inside every node
+    BCAST_NUM_ALGORITHMS
+} BcastAlgorithm;
+
+// Broadcast `count` elements of `datatype` from `root` to every rank of
+// `comm`, like MPI_Bcast. Linear, binomial and chain split the buffer into
+// segments of about `segment_size` bytes (0 = one segment) and forward each
+// segment to the children while the next one is still arriving.
+// Hierarchical uses the segment size for its trees; from 64 KB on it moves
+// the data through shared memory and needs a contiguous datatype.
+// Returns MPI_SUCCESS or the error code of the first failing MPI call.
+int bcast(void* buffer, int count, MPI_Datatype datatype, int root,
+          MPI_Comm comm, BcastAlgorithm algorithm, int segment_size);
+
+const char* bcast_algorithm_name(BcastAlgorithm algorithm);
+
+#endif  // BCAST_H
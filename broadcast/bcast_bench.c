@@ -0,0 +1,149 @@
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "bcast.h"
+
+// Compare the broadcast algorithms of bcast.c with MPI_Bcast for message
+// sizes from 4 B to 256 MB (powers of two).
+//
+//   bcast_bench [-r root] [-s segment bytes] [-m max bytes] [-i iterations]
+//
+// Every time is the average over the iterations of the slowest rank, in
+// microseconds. Before timing, every algorithm must deliver the root's
+// buffer unchanged to every rank.
+
+#define MIN_BYTES 4
+#define DEFAULT_MAX_BYTES (256 << 20)
+#define DEFAULT_SEGMENT (64 << 10)
+#define DEFAULT_ITERATIONS 100
+#define MIN_ITERATIONS 3
+#define BYTES_PER_SIZE (64 << 20)  // iterations shrink with the size
+
+// MPI_Bcast is column 0, the algorithms follow
+#define N_COLUMNS (BCAST_NUM_ALGORITHMS + 1)
+
+static int run(int column, char* buffer, int bytes, int root, int segment) {
+    if (column == 0) {
+        return MPI_Bcast(buffer, bytes, MPI_BYTE, root, MPI_COMM_WORLD);
+    }
+    return bcast(buffer, bytes, MPI_BYTE, root, MPI_COMM_WORLD,
+                 (BcastAlgorithm)(column - 1), segment);
+}
+
+static const char* column_name(int column) {
+    return column == 0 ? "MPI_Bcast"
+                       : bcast_algorithm_name((BcastAlgorithm)(column - 1));
+}
+
+static void fill(char* buffer, int bytes, int seed) {
+    for (int i = 0; i < bytes; i++) buffer[i] = (char)(i * 31 + seed);
+}
+
+// Whether every rank holds the root's pattern after one broadcast
+static int verify(int column, char* buffer, int bytes, int root, int segment,
+                  int id) {
+    if (id == root) {
+        fill(buffer, bytes, column + 1);
+    } else {
+        memset(buffer, 0, bytes);
+    }
+    int ok = run(column, buffer, bytes, root, segment) == MPI_SUCCESS;
+    for (int i = 0; i < bytes && ok; i++) {
+        ok = buffer[i] == (char)(i * 31 + column + 1);
+    }
+    int all_ok = 0;
+    MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    return all_ok;
+}
+
+static double time_column(int column, char* buffer, int bytes, int root,
+                          int segment, int iterations) {
+    run(column, buffer, bytes, root, segment);  // warmup
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = timer_now();
+    for (int i = 0; i < iterations; i++) {
+        run(column, buffer, bytes, root, segment);
+    }
+    double local = (timer_now() - start) / iterations, slowest = 0;
+    MPI_Reduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, root,
+               MPI_COMM_WORLD);
+    return slowest * 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int n_processes = 0;
+    int id = 0;
+    int root = 0;
+    int segment = DEFAULT_SEGMENT;
+    long max_bytes = DEFAULT_MAX_BYTES;
+    int max_iterations = DEFAULT_ITERATIONS;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    timer_init(TIMER_MPI);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            root = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            segment = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_bytes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            max_iterations = atoi(argv[++i]);
+        }
+    }
+    if (root < 0 || root >= n_processes) root = 0;
+    if (max_bytes > DEFAULT_MAX_BYTES) max_bytes = DEFAULT_MAX_BYTES;
+    if (max_iterations < MIN_ITERATIONS) max_iterations = MIN_ITERATIONS;
+
+    char* buffer = malloc(max_bytes > MIN_BYTES ? max_bytes : MIN_BYTES);
+    int have_buffer = buffer != NULL, all_have_buffer = 0;
+    MPI_Allreduce(&have_buffer, &all_have_buffer, 1, MPI_INT, MPI_LAND,
+                  MPI_COMM_WORLD);
+    if (!all_have_buffer) {
+        if (id == 0) printf("Error: could not allocate %ld bytes\n", max_bytes);
+        MPI_Finalize();
+        return 1;
+    }
+
+    if (id == root) {
+        printf("broadcast: %d processes, root %d, segments of %d bytes\n",
+               n_processes, root, segment);
+        printf("average time of the slowest rank [us]\n\n");
+        printf("%12s", "bytes");
+        for (int c = 0; c < N_COLUMNS; c++) printf(" %18s", column_name(c));
+        printf("\n");
+    }
+
+    int failed = 0;
+    for (long bytes = MIN_BYTES; bytes <= max_bytes; bytes *= 2) {
+        int iterations = (int)(BYTES_PER_SIZE / bytes);
+        if (iterations > max_iterations) iterations = max_iterations;
+        if (iterations < MIN_ITERATIONS) iterations = MIN_ITERATIONS;
+
+        if (id == root) printf("%12ld", bytes);
+        for (int c = 0; c < N_COLUMNS; c++) {
+            if (!verify(c, buffer, (int)bytes, root, segment, id)) {
+                failed = 1;
+                if (id == root) printf(" %18s", "WRONG");
+                continue;
+            }
+            double us = time_column(c, buffer, (int)bytes, root, segment,
+                                    iterations);
+            if (id == root) printf(" %18.2f", us);
+        }
+        if (id == root) {
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    free(buffer);
+    MPI_Finalize();
+    return failed;
+}
@@ -0,0 +1,20 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o every rank allocates a 256 MB buffer
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:20:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=4:ncpus=4:mem=2gb
+
+# get dependencies
+module load mpich-3.2
+# build
+mpicc ~/hpc/broadcast/bcast_bench.c ~/hpc/broadcast/bcast.c ~/hpc/hierarchy/hierarchy.c ~/hpc/timing/timer.c -DTIMER_WITH_MPI -O2 -Wall -std=c99 -o ~/hpc/broadcast/bcast_bench -lm
+# run
+mpirun.actual -n 16 ~/hpc/broadcast/bcast_bench
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include <mpi.h>
 #include <stdio.h>
 
+#include "bcast.h"
+
 int main() {
     int n_processes = 0;
     int id = 0;
@@ -12,14 +14,10 @@ int main() {
 
     // loop-based with linear complexity
     if (id == 0) {
-        for (int i = 1; i < n_processes; i++) {
-            printf("send value %d to process %d\n", v, i);
-            MPI_Send(&v, 1, MPI_INT, i, 0, MPI_COMM_WORLD);
-        }
-    } else {
-        MPI_Recv(&v, 1, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-        printf("received value %d on process %d\n", v, id);
+        v = 42;
     }
+    bcast(&v, 1, MPI_INT, 0, MPI_COMM_WORLD, BCAST_LINEAR, 0);
+    printf("received value %d on process %d\n", v, id);
 
     MPI_Finalize();
     return 0;
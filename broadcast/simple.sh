@@ -14,6 +14,6 @@
 # get dependencies
 module load mpich-3.2
 # build
-mpicc ~/hpc/broadcast/simple.c -g -Wall -std=c99 -o ~/hpc/broadcast/simple
+mpicc ~/hpc/broadcast/simple.c ~/hpc/broadcast/bcast.c ~/hpc/hierarchy/hierarchy.c -g -Wall -std=c99 -o ~/hpc/broadcast/simple
 # run
 mpirun.actual -n 4 ~/hpc/broadcast/simple
@@ -1,6 +1,8 @@
 #include <mpi.h>
 #include <stdio.h>
 
+#include "bcast.h"
+
 int main() {
     int n_processes = 0;
     int id = 0;
@@ -10,32 +12,12 @@ int main() {
     MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
     MPI_Comm_rank(MPI_COMM_WORLD, &id);
 
-    // tree-based with logarithmic complexity
+    // binomial tree with logarithmic complexity, any number of processes
     if (id == 0) {
-        printf("send value %d to process %d\n", v, 1);
-        MPI_Send(&v, 1, MPI_INT, 1, 0, MPI_COMM_WORLD);
-
-        printf("send value %d to process %d\n", v, 2);
-        MPI_Send(&v, 1, MPI_INT, 2, 0, MPI_COMM_WORLD);
-    } else {
-        if (id % 2 == 0) {
-            MPI_Recv(&v, 1, MPI_INT, id / 2 - 1, 0, MPI_COMM_WORLD,
-                     MPI_STATUS_IGNORE);
-        } else {
-            MPI_Recv(&v, 1, MPI_INT, id / 2, 0, MPI_COMM_WORLD,
-                     MPI_STATUS_IGNORE);
-        }
-        printf("received value %d on process %d\n", v, id);
-
-        if ((id * 2 + 1) < n_processes) {
-            printf("send value %d to process %d\n", v, id * 2 + 1);
-            MPI_Send(&v, 1, MPI_INT, id * 2 + 1, 0, MPI_COMM_WORLD);
-        }
-        if ((id * 2 + 2) < n_processes) {
-            printf("send value %d to process %d\n", v, id * 2 + 2);
-            MPI_Send(&v, 1, MPI_INT, id * 2 + 2, 0, MPI_COMM_WORLD);
-        }
+        v = 42;
     }
+    bcast(&v, 1, MPI_INT, 0, MPI_COMM_WORLD, BCAST_BINOMIAL, 0);
+    printf("received value %d on process %d\n", v, id);
 
     MPI_Finalize();
     return 0;
@@ -0,0 +1,314 @@
+#include "bigint.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define KARATSUBA_LIMBS 32  // schoolbook below
+#define TASK_LIMBS 1024     // Karatsuba spawns tasks from here on
+#define DECIMAL_CHUNK 10000000000000000000ULL  // 10^19, fits a limb
+#define DECIMAL_CHUNK_DIGITS 19
+
+typedef unsigned __int128 Wide;
+
+static void normalize(BigInt* x) {
+    while (x->size > 0 && x->limbs[x->size - 1] == 0) x->size--;
+}
+
+static bool reserve(BigInt* x, size_t capacity) {
+    if (x->capacity >= capacity) return true;
+    uint64_t* limbs = realloc(x->limbs, sizeof(uint64_t) * capacity);
+    if (!limbs) return false;
+    x->limbs = limbs;
+    x->capacity = capacity;
+    return true;
+}
+
+// r = a + b for an >= bn limbs, r has an limbs; returns the carry
+static uint64_t add_limbs(uint64_t* r, const uint64_t* a, size_t an,
+                          const uint64_t* b, size_t bn) {
+    uint64_t carry = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        Wide sum = (Wide)a[i] + b[i] + carry;
+        r[i] = (uint64_t)sum;
+        carry = (uint64_t)(sum >> 64);
+    }
+    for (; i < an; i++) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
+
+// r = a - b for an >= bn limbs, r has an limbs; returns the borrow
+static uint64_t sub_limbs(uint64_t* r, const uint64_t* a, size_t an,
+                          const uint64_t* b, size_t bn) {
+    uint64_t borrow = 0;
+    size_t i = 0;
+    for (; i < bn; i++) {
+        uint64_t d = a[i] - b[i];
+        uint64_t next = (a[i] < b[i]) | (d < borrow);
+        r[i] = d - borrow;
+        borrow = next;
+    }
+    for (; i < an; i++) {
+        r[i] = a[i] - borrow;
+        borrow = a[i] < borrow;
+    }
+    return borrow;
+}
+
+// Sign of a - b, leading zero limbs allowed
+static int compare_limbs(const uint64_t* a, size_t an, const uint64_t* b,
+                         size_t bn) {
+    for (; an > bn; an--) {
+        if (a[an - 1]) return 1;
+    }
+    for (; bn > an; bn--) {
+        if (b[bn - 1]) return -1;
+    }
+    for (size_t i = an; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// r = a * b, r has an + bn limbs and must not overlap a or b
+static void schoolbook(uint64_t* r, const uint64_t* a, size_t an,
+                       const uint64_t* b, size_t bn) {
+    memset(r, 0, sizeof(uint64_t) * (an + bn));
+    for (size_t j = 0; j < bn; j++) {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < an; i++) {
+            Wide t = (Wide)a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        r[j + an] = carry;
+    }
+}
+
+// r = |x - y| in h limbs for an h-limb x and an l-limb y, l <= h; true when
+// the difference is negative
+static bool abs_diff(uint64_t* r, const uint64_t* x, const uint64_t* y,
+                     size_t h, size_t l) {
+    if (compare_limbs(x, h, y, l) >= 0) {
+        sub_limbs(r, x, h, y, l);
+        return false;
+    }
+    sub_limbs(r, y, l, x, l);  // x < y, so x fits in l limbs
+    memset(r + l, 0, sizeof(uint64_t) * (h - l));
+    return true;
+}
+
+// r = a * b for n-limb a and b, r has 2n limbs. Subtractive Karatsuba with
+// a = a1 B^h + a0: a0 b1 + a1 b0 = a0 b0 + a1 b1 - (a0 - a1)(b0 - b1), so
+// no half grows by a carry limb. The three products are independent tasks.
+static bool karatsuba(uint64_t* r, const uint64_t* a, const uint64_t* b,
+                      size_t n) {
+    if (n < KARATSUBA_LIMBS) {
+        schoolbook(r, a, n, b, n);
+        return true;
+    }
+    size_t h = (n + 1) / 2, l = n - h;
+    uint64_t* scratch = malloc(sizeof(uint64_t) * (6 * h + 1));
+    if (!scratch) return false;
+    uint64_t* da = scratch;
+    uint64_t* db = scratch + h;
+    uint64_t* m = scratch + 2 * h;
+    uint64_t* middle = scratch + 4 * h;
+    bool negative = abs_diff(da, a, a + h, h, l) !=
+                    abs_diff(db, b, b + h, h, l);
+
+    // a0 b0 goes to r[0, 2h), a1 b1 to r[2h, 2n)
+    bool low_ok = true, high_ok = true, m_ok = true;
+    if (n >= TASK_LIMBS && omp_in_parallel()) {
+#pragma omp task shared(low_ok)
+        low_ok = karatsuba(r, a, b, h);
+#pragma omp task shared(high_ok)
+        high_ok = karatsuba(r + 2 * h, a + h, b + h, l);
+        m_ok = karatsuba(m, da, db, h);
+#pragma omp taskwait
+    } else {
+        low_ok = karatsuba(r, a, b, h);
+        high_ok = karatsuba(r + 2 * h, a + h, b + h, l);
+        m_ok = karatsuba(m, da, db, h);
+    }
+
+    if (low_ok && high_ok && m_ok) {
+        memcpy(middle, r, sizeof(uint64_t) * 2 * h);
+        middle[2 * h] = 0;
+        add_limbs(middle, middle, 2 * h + 1, r + 2 * h, 2 * l);
+        if (negative) {
+            add_limbs(middle, middle, 2 * h + 1, m, 2 * h);
+        } else {
+            sub_limbs(middle, middle, 2 * h + 1, m, 2 * h);
+        }
+        add_limbs(r + h, r + h, 2 * n - h, middle, 2 * h + 1);
+    }
+    free(scratch);
+    return low_ok && high_ok && m_ok;
+}
+
+// r = a * b for an >= bn, r has an + bn limbs and must not overlap a or b
+static bool mul_limbs(uint64_t* r, const uint64_t* a, size_t an,
+                      const uint64_t* b, size_t bn) {
+    if (bn < KARATSUBA_LIMBS) {
+        schoolbook(r, a, an, b, bn);
+        return true;
+    }
+    if (an == bn) return karatsuba(r, a, b, an);
+
+    // Unbalanced: bn-limb slices of a times b, added up
+    uint64_t* product = malloc(sizeof(uint64_t) * 2 * bn);
+    if (!product) return false;
+    memset(r, 0, sizeof(uint64_t) * (an + bn));
+    bool ok = true;
+    for (size_t offset = 0; offset < an && ok; offset += bn) {
+        size_t length = an - offset < bn ? an - offset : bn;
+        ok = length == bn ? karatsuba(product, a + offset, b, bn)
+                          : mul_limbs(product, b, bn, a + offset, length);
+        if (ok) {
+            add_limbs(r + offset, r + offset, an + bn - offset, product,
+                      length + bn);
+        }
+    }
+    free(product);
+    return ok;
+}
+
+void bigint_init(BigInt* x) {
+    x->limbs = NULL;
+    x->size = 0;
+    x->capacity = 0;
+}
+
+void bigint_free(BigInt* x) {
+    free(x->limbs);
+    bigint_init(x);
+}
+
+void bigint_swap(BigInt* x, BigInt* y) {
+    BigInt t = *x;
+    *x = *y;
+    *y = t;
+}
+
+bool bigint_set_u64(BigInt* x, uint64_t value) {
+    if (!reserve(x, 1)) return false;
+    x->limbs[0] = value;
+    x->size = value ? 1 : 0;
+    return true;
+}
+
+bool bigint_copy(BigInt* x, const BigInt* y) {
+    if (x == y) return true;
+    if (!reserve(x, y->size)) return false;
+    if (y->size) memcpy(x->limbs, y->limbs, sizeof(uint64_t) * y->size);
+    x->size = y->size;
+    return true;
+}
+
+int bigint_compare(const BigInt* x, const BigInt* y) {
+    return compare_limbs(x->limbs, x->size, y->limbs, y->size);
+}
+
+bool bigint_add(BigInt* result, const BigInt* x, const BigInt* y) {
+    if (x->size < y->size) {
+        const BigInt* t = x;
+        x = y;
+        y = t;
+    }
+    size_t n = x->size;
+    if (!reserve(result, n + 1)) return false;
+    // After reserve: result may be x or y, whose limbs could have moved
+    result->limbs[n] = add_limbs(result->limbs, x->limbs, n, y->limbs,
+                                 y->size);
+    result->size = n + 1;
+    normalize(result);
+    return true;
+}
+
+bool bigint_sub(BigInt* result, const BigInt* x, const BigInt* y) {
+    if (bigint_compare(x, y) < 0) return false;
+    size_t n = x->size;
+    if (!reserve(result, n)) return false;
+    sub_limbs(result->limbs, x->limbs, n, y->limbs, y->size);
+    result->size = n;
+    normalize(result);
+    return true;
+}
+
+bool bigint_mul(BigInt* result, const BigInt* x, const BigInt* y) {
+    if (x->size == 0 || y->size == 0) return bigint_set_u64(result, 0);
+    if (x->size < y->size) {
+        const BigInt* t = x;
+        x = y;
+        y = t;
+    }
+    size_t n = x->size + y->size;
+    uint64_t* limbs = malloc(sizeof(uint64_t) * n);
+    if (!limbs) return false;
+    if (!mul_limbs(limbs, x->limbs, x->size, y->limbs, y->size)) {
+        free(limbs);
+        return false;
+    }
+    free(result->limbs);
+    result->limbs = limbs;
+    result->size = n;
+    result->capacity = n;
+    normalize(result);
+    return true;
+}
+
+size_t bigint_bits(const BigInt* x) {
+    if (x->size == 0) return 0;
+    return 64 * x->size - __builtin_clzll(x->limbs[x->size - 1]);
+}
+
+uint64_t bigint_mod_u64(const BigInt* x, uint64_t modulus) {
+    Wide remainder = 0;
+    for (size_t i = x->size; i-- > 0;) {
+        remainder = ((remainder << 64) | x->limbs[i]) % modulus;
+    }
+    return (uint64_t)remainder;
+}
+
+char* bigint_to_decimal(const BigInt* x) {
+    // Every chunk of 19 digits takes more than 63 bits
+    size_t max_chunks = x->size + x->size / 63 + 1;
+    uint64_t* work = malloc(sizeof(uint64_t) * (x->size + 1));
+    uint64_t* chunks = malloc(sizeof(uint64_t) * max_chunks);
+    char* text = malloc(DECIMAL_CHUNK_DIGITS * max_chunks + 1);
+    if (!work || !chunks || !text) {
+        free(work);
+        free(chunks);
+        free(text);
+        return NULL;
+    }
+
+    // Repeated division by 10^19, lowest chunk first
+    size_t size = x->size, n_chunks = 0;
+    if (size) memcpy(work, x->limbs, sizeof(uint64_t) * size);
+    do {
+        Wide remainder = 0;
+        for (size_t i = size; i-- > 0;) {
+            Wide current = (remainder << 64) | work[i];
+            work[i] = (uint64_t)(current / DECIMAL_CHUNK);
+            remainder = current % DECIMAL_CHUNK;
+        }
+        chunks[n_chunks++] = (uint64_t)remainder;
+        while (size > 0 && work[size - 1] == 0) size--;
+    } while (size > 0);
+
+    char* end = text + sprintf(text, "%llu",
+                               (unsigned long long)chunks[n_chunks - 1]);
+    for (size_t c = n_chunks - 1; c-- > 0;) {
+        end += sprintf(end, "%019llu", (unsigned long long)chunks[c]);
+    }
+    free(chunks);
+    free(work);
+    return text;
+}
@@ -0,0 +1,45 @@
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Arbitrary-precision natural number: `size` 64-bit limbs, least
+// significant first, no leading zero limbs (zero has size 0). The
+// functions return false when memory runs out and leave the result
+// unchanged then. Results may alias the operands.
+typedef struct {
+    uint64_t* limbs;
+    size_t size;
+    size_t capacity;
+} BigInt;
+
+void bigint_init(BigInt* x);
+void bigint_free(BigInt* x);
+void bigint_swap(BigInt* x, BigInt* y);
+
+bool bigint_set_u64(BigInt* x, uint64_t value);
+bool bigint_copy(BigInt* x, const BigInt* y);
+
+int bigint_compare(const BigInt* x, const BigInt* y);
+
+bool bigint_add(BigInt* result, const BigInt* x, const BigInt* y);
+
+// x - y; false as well when y > x
+bool bigint_sub(BigInt* result, const BigInt* x, const BigInt* y);
+
+// Karatsuba above 32 limbs, schoolbook below. Inside an OpenMP parallel
+// region, the three half products of operands from 1024 limbs on run as
+// tasks; outside, the product is sequential.
+bool bigint_mul(BigInt* result, const BigInt* x, const BigInt* y);
+
+size_t bigint_bits(const BigInt* x);
+
+uint64_t bigint_mod_u64(const BigInt* x, uint64_t modulus);
+
+// Decimal digits, NUL-terminated, to free(); NULL without memory. Takes
+// quadratic time: seconds from about a million digits on.
+char* bigint_to_decimal(const BigInt* x);
+
+#endif  // BIGINT_H
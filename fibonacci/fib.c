@@ -0,0 +1,122 @@
+#include <inttypes.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "bigint.h"
+#include "fibonacci.h"
+
+// F(n) for large n by fast doubling (fibonacci.c).
+//
+//   fib [-n index] [-t threads] [-d] [-v]
+//
+// Prints the size of F(n), its last 19 decimal digits and the time; -d
+// prints all digits (quadratic conversion, slow from about n = 10^7).
+// -v verifies instead: F(0) ... F(VERIFY_ALL) and F(n) against the
+// iterative sum on one thread, or for n above ITERATIVE_LIMIT against
+// fast doubling on one thread.
+
+#define DEFAULT_INDEX 1000000
+#define VERIFY_ALL 3000      // beyond the Karatsuba threshold of bigint.c
+#define ITERATIVE_LIMIT 2000000
+#define LAST_DIGITS 10000000000000000000ULL  // 10^19
+
+static int verify(uint64_t n, int n_threads) {
+    BigInt expected, next, actual;
+    bigint_init(&expected);
+    bigint_init(&next);
+    bigint_init(&actual);
+    int failed = 0;
+
+    // The iterative sequence, one addition per index
+    bool ok = bigint_set_u64(&expected, 0) && bigint_set_u64(&next, 1);
+    for (uint64_t i = 0; i <= VERIFY_ALL && ok; i++) {
+        ok = fibonacci(i, &actual, n_threads);
+        if (ok && bigint_compare(&actual, &expected) != 0) {
+            printf("F(%" PRIu64 "): WRONG\n", i);
+            failed = 1;
+        }
+        ok = ok && bigint_add(&expected, &expected, &next);
+        bigint_swap(&expected, &next);
+    }
+    if (ok) {
+        printf("F(0) ... F(%d) against the iterative sum: %s\n", VERIFY_ALL,
+               failed ? "WRONG" : "ok");
+    }
+
+    const char* reference = n <= ITERATIVE_LIMIT ? "the iterative sum"
+                                                 : "fast doubling on 1 thread";
+    double start = timer_now();
+    ok = ok && (n <= ITERATIVE_LIMIT ? fibonacci_iterative(n, &expected)
+                                     : fibonacci(n, &expected, 1));
+    double reference_time = timer_now() - start;
+    start = timer_now();
+    ok = ok && fibonacci(n, &actual, n_threads);
+    double time = timer_now() - start;
+    if (ok) {
+        int same = bigint_compare(&actual, &expected) == 0;
+        printf("F(%" PRIu64 ") on %d threads against %s: %s "
+               "(%.3f s, reference %.3f s)\n",
+               n, n_threads, reference, same ? "ok" : "WRONG", time,
+               reference_time);
+        failed |= !same;
+    } else {
+        printf("Error: out of memory\n");
+        failed = 1;
+    }
+
+    bigint_free(&actual);
+    bigint_free(&next);
+    bigint_free(&expected);
+    return failed;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t n = DEFAULT_INDEX;
+    int n_threads = omp_get_max_threads();
+    int print_digits = 0;
+    int verify_mode = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            n_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            print_digits = 1;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verify_mode = 1;
+        }
+    }
+    if (n_threads < 1) n_threads = omp_get_max_threads();
+    if (verify_mode) return verify(n, n_threads);
+
+    BigInt result;
+    bigint_init(&result);
+    double start = timer_now();
+    if (!fibonacci(n, &result, n_threads)) {
+        printf("Error: out of memory\n");
+        return 1;
+    }
+    double elapsed = timer_now() - start;
+
+    printf("F(%" PRIu64 ") on %d threads: %zu bits, ends in ...%019" PRIu64
+           "\n",
+           n, n_threads, bigint_bits(&result),
+           bigint_mod_u64(&result, LAST_DIGITS));
+    printf("Elapsed time: %.6f s\n", elapsed);
+    if (print_digits) {
+        char* digits = bigint_to_decimal(&result);
+        if (!digits) {
+            printf("Error: out of memory\n");
+            bigint_free(&result);
+            return 1;
+        }
+        printf("%s\n", digits);
+        free(digits);
+    }
+    bigint_free(&result);
+    return 0;
+}
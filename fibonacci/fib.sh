@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o verification first (about 10 s of iterative sums), then F(10^9), whose
+#   operands take about 80 MB each
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:30:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=16:mem=4gb
+
+# get dependencies
+module load openmpi-4.0.4
+# build
+gcc ~/hpc/fibonacci/fib.c ~/hpc/fibonacci/fibonacci.c ~/hpc/fibonacci/bigint.c ~/hpc/timing/timer.c -O3 -march=native -Wall -fopenmp -std=c99 -o ~/hpc/fibonacci/fib -lm
+# run
+export OMP_NUM_THREADS=16
+~/hpc/fibonacci/fib -v -n 1000000
+~/hpc/fibonacci/fib -n 1000000000
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include <inttypes.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "bigint.h"
+#include "fibonacci.h"
+
+// Time fibonacci() for n = 10^4, 10^5, ... up to the maximum on 1, 2, 4,
+// ... threads, up to the maximum thread count.
+//
+//   fib_bench [-m max index] [-t max threads] [-r repetitions]
+//
+// Times are medians over the repetitions in seconds, followed by the
+// speedup over one thread. Every run must agree with the one-thread result.
+
+#define MIN_INDEX 10000
+#define DEFAULT_MAX_INDEX 100000000
+#define DEFAULT_REPETITIONS 3
+
+typedef struct {
+    uint64_t n;
+    int n_threads;
+    BigInt result;
+    bool ok;
+} Run;
+
+static void run(void* arg) {
+    Run* r = arg;
+    r->ok = fibonacci(r->n, &r->result, r->n_threads);
+}
+
+// 1, 2, 4, ... and max_threads itself
+static int next_thread_count(int threads, int max_threads) {
+    if (threads < max_threads && 2 * threads > max_threads) {
+        return max_threads;
+    }
+    return 2 * threads;
+}
+
+int main(int argc, char* argv[]) {
+    uint64_t max_index = DEFAULT_MAX_INDEX;
+    int max_threads = omp_get_max_threads();
+    int repetitions = DEFAULT_REPETITIONS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_index = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+        }
+    }
+    if (max_index < MIN_INDEX) max_index = MIN_INDEX;
+    if (max_threads < 1) max_threads = omp_get_max_threads();
+    if (repetitions < 1) repetitions = DEFAULT_REPETITIONS;
+
+    printf("fast doubling Fibonacci, median of %d runs [s] (speedup)\n\n",
+           repetitions);
+    printf("%12s %12s", "n", "bits");
+    for (int t = 1; t <= max_threads; t = next_thread_count(t, max_threads)) {
+        printf(" %10d threads", t);
+    }
+    printf("\n");
+
+    int failed = 0;
+    for (uint64_t n = MIN_INDEX; n <= max_index; n *= 10) {
+        Run reference = {n, 1, {NULL, 0, 0}, false};
+        double serial = timer_repeat(run, &reference, 0, repetitions).median;
+        if (!reference.ok) {
+            printf("Error: out of memory for F(%" PRIu64 ")\n", n);
+            return 1;
+        }
+        printf("%12" PRIu64 " %12zu %10.4f ( 1.00)", n,
+               bigint_bits(&reference.result), serial);
+
+        for (int t = next_thread_count(1, max_threads); t <= max_threads;
+             t = next_thread_count(t, max_threads)) {
+            Run parallel = {n, t, {NULL, 0, 0}, false};
+            double time = timer_repeat(run, &parallel, 0, repetitions).median;
+            if (!parallel.ok ||
+                bigint_compare(&parallel.result, &reference.result) != 0) {
+                printf(" %18s", "WRONG");
+                failed = 1;
+            } else {
+                printf(" %10.4f (%5.2f)", time, serial / time);
+            }
+            bigint_free(&parallel.result);
+        }
+        printf("\n");
+        fflush(stdout);
+        bigint_free(&reference.result);
+    }
+    return failed;
+}
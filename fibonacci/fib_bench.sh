@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o n up to 10^8, 1 to 16 threads
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=01:00:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=16:mem=2gb
+
+# get dependencies
+module load openmpi-4.0.4
+# build
+gcc ~/hpc/fibonacci/fib_bench.c ~/hpc/fibonacci/fibonacci.c ~/hpc/fibonacci/bigint.c ~/hpc/timing/timer.c -O3 -march=native -Wall -fopenmp -std=c99 -o ~/hpc/fibonacci/fib_bench -lm
+# run
+export OMP_PROC_BIND=close
+export OMP_PLACES=cores
+~/hpc/fibonacci/fib_bench -t 16
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "fibonacci.h"
+
+#include <omp.h>
+
+// (a, b) = (F(k), F(k + 1)) becomes (F(2k), F(2k + 1)), or (F(2k + 1),
+// F(2k + 2)) for a set bit, from the top bit of n down. The last step only
+// computes the one of F(2k), F(2k + 1) that is F(n).
+static bool doubling(uint64_t n, BigInt* a, BigInt* b) {
+    BigInt t, c, d, e;
+    bigint_init(&t);
+    bigint_init(&c);
+    bigint_init(&d);
+    bigint_init(&e);
+    bool ok = bigint_set_u64(a, 0) && bigint_set_u64(b, 1);
+
+    for (int bit = n ? 63 - __builtin_clzll(n) : -1; bit >= 0 && ok;
+         bit--) {
+        bool odd = (n >> bit) & 1, last = bit == 0;
+        bool c_ok = true, d_ok = true, e_ok = true;
+
+        // c = F(2k) = a (2b - a), d = F(2k + 1) = a^2 + b^2
+        if (!last || !odd) {
+            c_ok = bigint_add(&t, b, b) && bigint_sub(&t, &t, a);
+#pragma omp task shared(c_ok, c, t)
+            c_ok = c_ok && bigint_mul(&c, a, &t);
+        }
+        if (!last || odd) {
+#pragma omp task shared(d_ok, d)
+            d_ok = bigint_mul(&d, a, a);
+            e_ok = bigint_mul(&e, b, b);
+        }
+#pragma omp taskwait
+        ok = c_ok && d_ok && e_ok;
+        if (ok && (!last || odd)) ok = bigint_add(&d, &d, &e);
+
+        if (ok && odd) {
+            ok = last || bigint_add(&c, &c, &d);
+            bigint_swap(a, &d);
+            bigint_swap(b, &c);
+        } else if (ok) {
+            bigint_swap(a, &c);
+            bigint_swap(b, &d);
+        }
+    }
+
+    bigint_free(&t);
+    bigint_free(&c);
+    bigint_free(&d);
+    bigint_free(&e);
+    return ok;
+}
+
+bool fibonacci(uint64_t n, BigInt* result, int n_threads) {
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+    BigInt next;
+    bigint_init(&next);
+    bool ok = false;
+
+#pragma omp parallel num_threads(n_threads)
+#pragma omp single
+    ok = doubling(n, result, &next);
+
+    bigint_free(&next);
+    return ok;
+}
+
+bool fibonacci_iterative(uint64_t n, BigInt* result) {
+    BigInt next;
+    bigint_init(&next);
+    bool ok = bigint_set_u64(result, 0) && bigint_set_u64(&next, 1);
+    for (uint64_t i = 0; i < n && ok; i++) {
+        ok = bigint_add(result, result, &next);
+        bigint_swap(result, &next);
+    }
+    bigint_free(&next);
+    return ok;
+}
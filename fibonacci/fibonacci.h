@@ -0,0 +1,23 @@
+#ifndef FIBONACCI_H
+#define FIBONACCI_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "bigint.h"
+
+// F(0) = 0, F(1) = 1, F(n) = F(n - 1) + F(n - 2). Both functions store F(n)
+// into an initialized `result` and return false when memory runs out.
+
+// Fast doubling, one step per bit of n:
+//   F(2k)     = F(k) (2 F(k + 1) - F(k))
+//   F(2k + 1) = F(k)^2 + F(k + 1)^2
+// The three products of a step run as OpenMP tasks on `n_threads` threads
+// (0 = omp_get_max_threads()) and split further inside bigint_mul.
+bool fibonacci(uint64_t n, BigInt* result, int n_threads);
+
+// n additions on one thread, O(n^2) limb operations: the reference for
+// checking fibonacci() up to a few million
+bool fibonacci_iterative(uint64_t n, BigInt* result);
+
+#endif  // FIBONACCI_H
@@ -0,0 +1,319 @@
+#include "scan.h"
+
+#include <omp.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define JUMP 64  // elements filled from one state at once
+
+// State before x[i]: s[j] = x[i - 1 - j], the newest value first. The
+// block transitions of doubles are computed in long double: M^L of an
+// oscillating recurrence has entries far above its values, and the
+// squarings would lose their rounding errors into the carries otherwise.
+typedef long double MatrixDouble[SCAN_MAX_ORDER][SCAN_MAX_ORDER];
+typedef uint64_t MatrixMod[SCAN_MAX_ORDER][SCAN_MAX_ORDER];
+
+// Block b of p: whole jumps of [order, n), the remainder goes to the last
+static long long block_start(long long n, int order, int b, int p) {
+    if (b == p) return n;
+    long long jumps = (n - order) / JUMP;
+    return order + jumps * b / p * JUMP;
+}
+
+// ---------------------------------------------------------------- doubles
+
+static void companion_double(MatrixDouble m, const double* c, int k) {
+    memset(m, 0, sizeof(MatrixDouble));
+    for (int j = 0; j < k; j++) m[0][j] = c[j];
+    for (int r = 1; r < k; r++) m[r][r - 1] = 1.0;
+}
+
+static void multiply_double(MatrixDouble result, MatrixDouble a,
+                            MatrixDouble b, int k) {
+    MatrixDouble t;
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j < k; j++) {
+            long double sum = 0.0;
+            for (int l = 0; l < k; l++) sum += a[i][l] * b[l][j];
+            t[i][j] = sum;
+        }
+    }
+    memcpy(result, t, sizeof(MatrixDouble));
+}
+
+static void power_double(MatrixDouble result, MatrixDouble m, long long e,
+                         int k) {
+    MatrixDouble base;
+    memcpy(base, m, sizeof(MatrixDouble));
+    memset(result, 0, sizeof(MatrixDouble));
+    for (int i = 0; i < k; i++) result[i][i] = 1.0;
+    for (; e > 0; e >>= 1) {
+        if (e & 1) multiply_double(result, result, base, k);
+        multiply_double(base, base, base, k);
+    }
+}
+
+// jump[j][t] is the weight of s[j] in x[i + t]: the first row of M^(t + 1)
+static void jump_table_double(double jump[][JUMP], const double* c, int k) {
+    for (int j = 0; j < k; j++) jump[j][0] = c[j];
+    for (int t = 1; t < JUMP; t++) {
+        for (int j = 0; j < k; j++) {
+            double next = j + 1 < k ? jump[j + 1][t - 1] : 0.0;
+            jump[j][t] = jump[0][t - 1] * c[j] + next;
+        }
+    }
+}
+
+static void fill_double(double* x, long long start, long long end, double* s,
+                        double jump[][JUMP], const double* c, int k) {
+    long long i = start;
+    for (; i + JUMP <= end; i += JUMP) {
+        double* y = x + i;
+        double s0 = s[0];
+#pragma omp simd
+        for (int t = 0; t < JUMP; t++) y[t] = jump[0][t] * s0;
+        for (int j = 1; j < k; j++) {
+            double sj = s[j];
+#pragma omp simd
+            for (int t = 0; t < JUMP; t++) y[t] += jump[j][t] * sj;
+        }
+        for (int j = 0; j < k; j++) s[j] = y[JUMP - 1 - j];
+    }
+    for (; i < end; i++) {
+        double value = 0.0;
+        for (int j = 0; j < k; j++) value += c[j] * s[j];
+        for (int j = k - 1; j > 0; j--) s[j] = s[j - 1];
+        s[0] = x[i] = value;
+    }
+}
+
+bool scan_recurrence_double(double* x, long long n, const double* c,
+                            int order, int n_threads) {
+    if (order < 1 || order > SCAN_MAX_ORDER) return false;
+    if (n <= order) return true;
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+    int k = order;
+
+    MatrixDouble m;
+    double jump[SCAN_MAX_ORDER][JUMP];
+    companion_double(m, c, k);
+    jump_table_double(jump, c, k);
+    MatrixDouble* transitions = malloc(sizeof(MatrixDouble) * n_threads);
+    long double* carries =
+        malloc(sizeof(long double) * SCAN_MAX_ORDER * n_threads);
+    double* states = malloc(sizeof(double) * SCAN_MAX_ORDER * n_threads);
+    if (!transitions || !carries || !states) {
+        free(carries);
+        free(transitions);
+        free(states);
+        return false;
+    }
+
+#pragma omp parallel num_threads(n_threads)
+    {
+        int b = omp_get_thread_num(), p = omp_get_num_threads();
+        long long start = block_start(n, k, b, p);
+        long long end = block_start(n, k, b + 1, p);
+        double* s = states + b * SCAN_MAX_ORDER;
+
+        // 1. Transition over the block
+        power_double(transitions[b], m, end - start, k);
+#pragma omp barrier
+
+        // 2. Starting state of every block
+#pragma omp single
+        {
+            for (int j = 0; j < k; j++) carries[j] = x[k - 1 - j];
+            for (int block = 1; block < p; block++) {
+                long double* from = carries + (block - 1) * SCAN_MAX_ORDER;
+                long double* to = carries + block * SCAN_MAX_ORDER;
+                for (int r = 0; r < k; r++) {
+                    long double sum = 0.0;
+                    for (int j = 0; j < k; j++) {
+                        sum += transitions[block - 1][r][j] * from[j];
+                    }
+                    to[r] = sum;
+                }
+            }
+        }
+        for (int j = 0; j < k; j++) {
+            s[j] = (double)carries[b * SCAN_MAX_ORDER + j];
+        }
+
+        // 3. Fill the block from its state
+        fill_double(x, start, end, s, jump, c, k);
+    }
+
+    free(states);
+    free(carries);
+    free(transitions);
+    return true;
+}
+
+void recurrence_double(double* x, long long n, const double* c, int order) {
+    for (long long i = order; i < n; i++) {
+        double value = 0.0;
+        for (int j = 0; j < order; j++) value += c[j] * x[i - 1 - j];
+        x[i] = value;
+    }
+}
+
+// --------------------------------------------------------------- residues
+
+static uint64_t mul_mod(uint64_t a, uint64_t b, uint32_t modulus) {
+    return a * b % modulus;  // a, b < 2^32
+}
+
+static void companion_mod(MatrixMod m, const uint32_t* c, int k) {
+    memset(m, 0, sizeof(MatrixMod));
+    for (int j = 0; j < k; j++) m[0][j] = c[j];
+    for (int r = 1; r < k; r++) m[r][r - 1] = 1;
+}
+
+static void multiply_mod(MatrixMod result, MatrixMod a, MatrixMod b, int k,
+                         uint32_t modulus) {
+    MatrixMod t;
+    for (int i = 0; i < k; i++) {
+        for (int j = 0; j < k; j++) {
+            uint64_t sum = 0;
+            for (int l = 0; l < k; l++) {
+                sum = (sum + mul_mod(a[i][l], b[l][j], modulus)) % modulus;
+            }
+            t[i][j] = sum;
+        }
+    }
+    memcpy(result, t, sizeof(MatrixMod));
+}
+
+static void power_mod(MatrixMod result, MatrixMod m, long long e, int k,
+                      uint32_t modulus) {
+    MatrixMod base;
+    memcpy(base, m, sizeof(MatrixMod));
+    memset(result, 0, sizeof(MatrixMod));
+    for (int i = 0; i < k; i++) result[i][i] = 1 % modulus;
+    for (; e > 0; e >>= 1) {
+        if (e & 1) multiply_mod(result, result, base, k, modulus);
+        multiply_mod(base, base, base, k, modulus);
+    }
+}
+
+// As jump_table_double; shoup[j][t] = floor(jump[j][t] 2^32 / modulus)
+// turns every product in the fill into multiplications and a subtraction
+static void jump_table_mod(uint32_t jump[][JUMP], uint32_t shoup[][JUMP],
+                           const uint32_t* c, int k, uint32_t modulus) {
+    for (int j = 0; j < k; j++) jump[j][0] = c[j];
+    for (int t = 1; t < JUMP; t++) {
+        for (int j = 0; j < k; j++) {
+            uint64_t next = j + 1 < k ? jump[j + 1][t - 1] : 0;
+            jump[j][t] = (mul_mod(jump[0][t - 1], c[j], modulus) + next) %
+                         modulus;
+        }
+    }
+    for (int j = 0; j < k; j++) {
+        for (int t = 0; t < JUMP; t++) {
+            shoup[j][t] = (uint32_t)(((uint64_t)jump[j][t] << 32) / modulus);
+        }
+    }
+}
+
+static void fill_mod(uint32_t* x, long long start, long long end,
+                     uint64_t* s, uint32_t jump[][JUMP],
+                     uint32_t shoup[][JUMP], const uint32_t* c, int k,
+                     uint32_t modulus) {
+    long long i = start;
+    for (; i + JUMP <= end; i += JUMP) {
+        uint64_t sum[JUMP] = {0};
+        for (int j = 0; j < k; j++) {
+            uint32_t sj = (uint32_t)s[j];
+#pragma omp simd
+            for (int t = 0; t < JUMP; t++) {
+                // w sj - floor(w' sj / 2^32) m lies in [0, 2m)
+                uint32_t q = (uint32_t)(((uint64_t)shoup[j][t] * sj) >> 32);
+                uint64_t r = (uint64_t)jump[j][t] * sj -
+                             (uint64_t)q * modulus;
+                r -= r >= modulus ? modulus : 0;
+                sum[t] += r;
+                sum[t] -= sum[t] >= modulus ? modulus : 0;
+            }
+        }
+        uint32_t* y = x + i;
+#pragma omp simd
+        for (int t = 0; t < JUMP; t++) y[t] = (uint32_t)sum[t];
+        for (int j = 0; j < k; j++) s[j] = y[JUMP - 1 - j];
+    }
+    for (; i < end; i++) {
+        uint64_t value = 0;
+        for (int j = 0; j < k; j++) {
+            value = (value + mul_mod(c[j], s[j], modulus)) % modulus;
+        }
+        for (int j = k - 1; j > 0; j--) s[j] = s[j - 1];
+        s[0] = value;
+        x[i] = (uint32_t)value;
+    }
+}
+
+bool scan_recurrence_mod(uint32_t* x, long long n, const uint32_t* c,
+                         int order, uint32_t modulus, int n_threads) {
+    if (order < 1 || order > SCAN_MAX_ORDER || modulus == 0) return false;
+    if (n <= order) return true;
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+    int k = order;
+
+    MatrixMod m;
+    uint32_t jump[SCAN_MAX_ORDER][JUMP], shoup[SCAN_MAX_ORDER][JUMP];
+    companion_mod(m, c, k);
+    jump_table_mod(jump, shoup, c, k, modulus);
+    MatrixMod* transitions = malloc(sizeof(MatrixMod) * n_threads);
+    uint64_t* states = malloc(sizeof(uint64_t) * SCAN_MAX_ORDER * n_threads);
+    if (!transitions || !states) {
+        free(transitions);
+        free(states);
+        return false;
+    }
+
+#pragma omp parallel num_threads(n_threads)
+    {
+        int b = omp_get_thread_num(), p = omp_get_num_threads();
+        long long start = block_start(n, k, b, p);
+        long long end = block_start(n, k, b + 1, p);
+        uint64_t* s = states + b * SCAN_MAX_ORDER;
+
+        power_mod(transitions[b], m, end - start, k, modulus);
+#pragma omp barrier
+
+#pragma omp single
+        {
+            for (int j = 0; j < k; j++) states[j] = x[k - 1 - j];
+            for (int block = 1; block < p; block++) {
+                uint64_t* from = states + (block - 1) * SCAN_MAX_ORDER;
+                uint64_t* to = states + block * SCAN_MAX_ORDER;
+                for (int r = 0; r < k; r++) {
+                    uint64_t sum = 0;
+                    for (int j = 0; j < k; j++) {
+                        sum = (sum + mul_mod(transitions[block - 1][r][j],
+                                             from[j], modulus)) %
+                              modulus;
+                    }
+                    to[r] = sum;
+                }
+            }
+        }
+
+        fill_mod(x, start, end, s, jump, shoup, c, k, modulus);
+    }
+
+    free(states);
+    free(transitions);
+    return true;
+}
+
+void recurrence_mod(uint32_t* x, long long n, const uint32_t* c, int order,
+                    uint32_t modulus) {
+    for (long long i = order; i < n; i++) {
+        uint64_t value = 0;
+        for (int j = 0; j < order; j++) {
+            value = (value + mul_mod(c[j], x[i - 1 - j], modulus)) % modulus;
+        }
+        x[i] = (uint32_t)value;
+    }
+}
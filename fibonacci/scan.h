@@ -0,0 +1,38 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCAN_MAX_ORDER 8
+
+// Fill x[order, n) with the linear recurrence of order k = `order`
+//   x[i] = c[0] x[i - 1] + c[1] x[i - 2] + ... + c[k - 1] x[i - k]
+// from the initial values x[0, k) already in x, on `n_threads` OpenMP
+// threads (0 = omp_get_max_threads()). Fibonacci is c = {1, 1} from
+// x = {0, 1}.
+//
+// The recurrence is a scan over the k x k companion matrix M, in three
+// phases: every thread computes M^L for its block of L elements by
+// repeated squaring, one thread carries the state across the blocks, and
+// every thread fills its block from its starting state. The fill computes
+// 64 elements at once from the state before them, with the first rows of
+// M^1 ... M^64, so it runs in SIMD lanes and stores contiguously.
+//
+// Returns false for an order outside [1, SCAN_MAX_ORDER] or without memory.
+
+// Doubles: the values equal those of the sequential loop up to rounding
+bool scan_recurrence_double(double* x, long long n, const double* c,
+                            int order, int n_threads);
+
+// Residues modulo `modulus` < 2^32; c and the initial values must be below
+// it. Exact, so equal to the sequential loop.
+bool scan_recurrence_mod(uint32_t* x, long long n, const uint32_t* c,
+                         int order, uint32_t modulus, int n_threads);
+
+// The sequential loops, for reference
+void recurrence_double(double* x, long long n, const double* c, int order);
+void recurrence_mod(uint32_t* x, long long n, const uint32_t* c, int order,
+                    uint32_t modulus);
+
+#endif  // SCAN_H
@@ -0,0 +1,184 @@
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "scan.h"
+
+// Fill whole sequences with the parallel scan of scan.c:
+//   fibonacci    F(i) mod 10^9 + 7
+//   tribonacci   x[i] = x[i - 1] + x[i - 2] + x[i - 3] mod 2^31 - 1
+//   sine         sin(i w) in doubles, x[i] = 2 cos(w) x[i - 1] - x[i - 2]
+//
+//   scan_bench [-n elements] [-t max threads] [-r repetitions]
+//
+// For 1, 2, 4, ... threads, prints the median time, the store bandwidth
+// in GB/s and, for comparison, the bandwidth of memset over the same
+// array with the same threads. The residues must equal the sequential
+// loop; for the sine, the largest difference to it is printed.
+
+#define DEFAULT_ELEMENTS 100000000LL
+#define DEFAULT_REPETITIONS 5
+#define MIN_ELEMENTS 1000
+#define SINE_STEP 0.001
+
+typedef struct {
+    const char* name;
+    int order;
+    uint32_t c[SCAN_MAX_ORDER];
+    uint32_t initial[SCAN_MAX_ORDER];
+    uint32_t modulus;
+} ModInstance;
+
+static const ModInstance MOD_INSTANCES[] = {
+    {"fibonacci", 2, {1, 1}, {0, 1}, 1000000007u},
+    {"tribonacci", 3, {1, 1, 1}, {0, 0, 1}, 2147483647u},
+};
+
+#define N_MOD_INSTANCES \
+    (int)(sizeof(MOD_INSTANCES) / sizeof(MOD_INSTANCES[0]))
+
+typedef struct {
+    void* x;
+    long long n;
+    size_t element_size;
+    int n_threads;
+    const ModInstance* instance;  // NULL: the sine in doubles
+    double sine_c[2];
+} Run;
+
+static void run_scan(void* arg) {
+    Run* r = arg;
+    if (r->instance) {
+        scan_recurrence_mod(r->x, r->n, r->instance->c, r->instance->order,
+                            r->instance->modulus, r->n_threads);
+    } else {
+        scan_recurrence_double(r->x, r->n, r->sine_c, 2, r->n_threads);
+    }
+}
+
+// Every thread clears the part of the array it would fill
+static void run_memset(void* arg) {
+    Run* r = arg;
+    char* bytes = r->x;
+    size_t total = (size_t)r->n * r->element_size;
+#pragma omp parallel num_threads(r->n_threads)
+    {
+        int id = omp_get_thread_num(), p = omp_get_num_threads();
+        size_t first = total * id / p, last = total * (id + 1) / p;
+        memset(bytes + first, 0, last - first);
+    }
+}
+
+// 1, 2, 4, ... and max_threads itself
+static int next_thread_count(int threads, int max_threads) {
+    if (threads < max_threads && 2 * threads > max_threads) {
+        return max_threads;
+    }
+    return 2 * threads;
+}
+
+static void set_initial(Run* r) {
+    if (r->instance) {
+        memcpy(r->x, r->instance->initial,
+               sizeof(uint32_t) * r->instance->order);
+    } else {
+        double* x = r->x;
+        x[0] = 0.0;
+        x[1] = sin(SINE_STEP);
+    }
+}
+
+// "ok", "WRONG", or the largest difference for doubles
+static void compare(const Run* r, const void* expected, char* text) {
+    if (r->instance) {
+        int same = memcmp(r->x, expected, sizeof(uint32_t) * r->n) == 0;
+        strcpy(text, same ? "ok" : "WRONG");
+        return;
+    }
+    const double* x = r->x;
+    const double* y = expected;
+    double largest = 0.0;
+    for (long long i = 0; i < r->n; i++) {
+        double d = fabs(x[i] - y[i]);
+        if (d > largest) largest = d;
+    }
+    sprintf(text, "%.1e", largest);
+}
+
+static void bench(Run* r, void* expected, int max_threads, int repetitions) {
+    double bytes = (double)r->n * r->element_size;
+
+    // Sequential reference
+    set_initial(r);
+    double start = timer_now();
+    if (r->instance) {
+        recurrence_mod(r->x, r->n, r->instance->c, r->instance->order,
+                       r->instance->modulus);
+    } else {
+        recurrence_double(r->x, r->n, r->sine_c, 2);
+    }
+    double sequential = timer_now() - start;
+    memcpy(expected, r->x, (size_t)bytes);
+    printf("\n%s: sequential loop %.4f s, %.2f GB/s\n",
+           r->instance ? r->instance->name : "sine", sequential,
+           bytes / sequential * 1e-9);
+    printf("%8s %10s %10s %12s %10s\n", "threads", "time [s]", "GB/s",
+           "memset GB/s", "check");
+
+    for (int t = 1; t <= max_threads; t = next_thread_count(t, max_threads)) {
+        r->n_threads = t;
+        double fill = timer_repeat(run_memset, r, 1, repetitions).median;
+        set_initial(r);
+        double time = timer_repeat(run_scan, r, 1, repetitions).median;
+        char check[32];
+        compare(r, expected, check);
+        printf("%8d %10.4f %10.2f %12.2f %10s\n", t, time,
+               bytes / time * 1e-9, bytes / fill * 1e-9, check);
+        fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    long long n = DEFAULT_ELEMENTS;
+    int max_threads = omp_get_max_threads();
+    int repetitions = DEFAULT_REPETITIONS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+        }
+    }
+    if (n < MIN_ELEMENTS) n = MIN_ELEMENTS;
+    if (max_threads < 1) max_threads = omp_get_max_threads();
+    if (repetitions < 1) repetitions = DEFAULT_REPETITIONS;
+    timer_init(TIMER_TSC);
+
+    // The sequence and the sequential result, for the widest element
+    void* x = malloc(sizeof(double) * n);
+    void* expected = malloc(sizeof(double) * n);
+    if (!x || !expected) {
+        printf("Error: could not allocate 2 x %lld doubles\n", n);
+        return 1;
+    }
+    printf("parallel scan of %lld elements, median of %d runs\n", n,
+           repetitions);
+
+    for (int i = 0; i < N_MOD_INSTANCES; i++) {
+        Run r = {x, n, sizeof(uint32_t), 1, &MOD_INSTANCES[i], {0, 0}};
+        bench(&r, expected, max_threads, repetitions);
+    }
+    Run sine = {x, n, sizeof(double), 1, NULL,
+                {2 * cos(SINE_STEP), -1.0}};
+    bench(&sine, expected, max_threads, repetitions);
+
+    free(expected);
+    free(x);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o 10^9 elements: 2 x 8 GB of doubles for the sine
+# o 1 to 16 threads, against memset over the same array
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:30:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=16:mem=24gb
+
+# get dependencies
+module load openmpi-4.0.4
+# build
+gcc ~/hpc/fibonacci/scan_bench.c ~/hpc/fibonacci/scan.c ~/hpc/timing/timer.c -O3 -march=native -Wall -fopenmp -std=c99 -o ~/hpc/fibonacci/scan_bench -lm
+# run
+export OMP_PROC_BIND=close
+export OMP_PLACES=cores
+~/hpc/fibonacci/scan_bench -n 1000000000 -t 16
\ No newline at end of file
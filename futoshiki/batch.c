@@ -0,0 +1,393 @@
+#define _POSIX_C_SOURCE 200809L  // rand_r
+
+#include "batch.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+
+#define BATCH_CELLS (BATCH_MAX_N * BATCH_MAX_N)
+#define ZERO_SLOT BATCH_CELLS  // Grid slot that always holds EMPTY (missing neighbor)
+
+typedef enum { LANE_IDLE = 0, LANE_RUNNING, LANE_SOLVED, LANE_UNSATISFIABLE } LaneStatus;
+
+// Search state of BATCH_LANES puzzles of one thread. Every array is indexed [item][lane] so a
+// step reads and writes the lanes of one item side by side. Each lane walks the same tree as
+// color_g_seq (empty cells in row-major order, colors in ascending order) as an explicit stack:
+// the colors still to try at depth k are kept as a mask, and the mask is computed once, when
+// the search enters the cell, from the row/column occupancy masks and the assigned neighbors.
+typedef struct {
+    int grid[BATCH_CELLS + 1][BATCH_LANES];      // Bit of the assigned color (slot r * MAX_N + c)
+    int row_used[BATCH_MAX_N][BATCH_LANES];      // Bit c set when color c is used in the row
+    int col_used[BATCH_MAX_N][BATCH_LANES];      // Bit c set when color c is used in the column
+    int slot[BATCH_CELLS][BATCH_LANES];          // Grid slot of the k-th empty cell
+    int pc_mask[BATCH_CELLS][BATCH_LANES];       // Pre-colored colors of the k-th empty cell
+    int untried[BATCH_CELLS][BATCH_LANES];       // Colors still to try at depth k
+    int smaller[BATCH_CELLS][4][BATCH_LANES];    // Slots that must hold a smaller color
+    int larger[BATCH_CELLS][4][BATCH_LANES];     // Slots that must hold a larger color
+    int depth[BATCH_LANES];
+    int num_cells[BATCH_LANES];
+    int entering[BATCH_LANES];                   // Depth reached by a descent, not a backtrack
+    int max_depth[BATCH_LANES];
+    int status[BATCH_LANES];                     // LaneStatus
+    int nodes[BATCH_LANES];                      // 32 bits like every other lane field
+    int puzzle[BATCH_LANES];                     // Index of the puzzle in the lane
+    double start[BATCH_LANES];
+} LaneEngine;
+
+bool batch_puzzle_from(Futoshiki* puzzle, bool use_precoloring, BatchPuzzle* out) {
+    int n = puzzle->size;
+    if (n < BATCH_MIN_N || n > BATCH_MAX_N) {
+        printf("Error: Batch solving supports %dx%d to %dx%d puzzles, not %dx%d\n", BATCH_MIN_N,
+               BATCH_MIN_N, BATCH_MAX_N, BATCH_MAX_N, n, n);
+        return false;
+    }
+
+    double start = timer_now();
+    memset(out, 0, sizeof(*out));
+    out->size = n;
+    out->colors_removed = compute_pc_lists(puzzle, use_precoloring);
+    for (int row = 0; row < n; row++) {
+        for (int col = 0; col < n; col++) {
+            out->board[row][col] = (unsigned char)puzzle->board[row][col];
+            for (int i = 0; i < puzzle->pc_lengths[row][col]; i++) {
+                out->pc_mask[row][col] |= (unsigned char)(1u << puzzle->pc_list[row][col][i]);
+            }
+            if (col < n - 1) out->h_cons[row][col] = (unsigned char)puzzle->h_cons[row][col];
+            if (row < n - 1) out->v_cons[row][col] = (unsigned char)puzzle->v_cons[row][col];
+        }
+    }
+    out->precolor_time = timer_now() - start;
+    return true;
+}
+
+bool batch_puzzle_load(const char* filename, bool use_precoloring, BatchPuzzle* out) {
+    Futoshiki* puzzle = malloc(sizeof(Futoshiki));
+    if (!puzzle) {
+        printf("Error: Could not allocate puzzle\n");
+        return false;
+    }
+    bool ok = read_puzzle_from_file(filename, puzzle) &&
+              batch_puzzle_from(puzzle, use_precoloring, out);
+    free(puzzle);
+    return ok;
+}
+
+bool batch_generate(BatchPuzzle* puzzles, int count, unsigned int seed, bool use_precoloring) {
+    Futoshiki* puzzle = malloc(sizeof(Futoshiki));
+    if (!puzzle) {
+        printf("Error: Could not allocate puzzle\n");
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        int n = BATCH_MIN_N + i % (BATCH_MAX_N - BATCH_MIN_N + 1);
+        int square[BATCH_MAX_N][BATCH_MAX_N], symbols[BATCH_MAX_N], rows[BATCH_MAX_N];
+        for (int k = 0; k < n; k++) symbols[k] = rows[k] = k;
+        for (int k = n - 1; k > 0; k--) {
+            int a = rand_r(&seed) % (k + 1), b = rand_r(&seed) % (k + 1), t;
+            t = symbols[k], symbols[k] = symbols[a], symbols[a] = t;
+            t = rows[k], rows[k] = rows[b], rows[b] = t;
+        }
+
+        // Few givens and inequalities, so most puzzles need a real search
+        memset(puzzle, 0, sizeof(*puzzle));
+        puzzle->size = n;
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) square[r][c] = symbols[(rows[r] + c) % n] + 1;
+        }
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) {
+                if (rand_r(&seed) % 100 < 15) puzzle->board[r][c] = square[r][c];
+                if (c < n - 1 && rand_r(&seed) % 100 < 25) {
+                    puzzle->h_cons[r][c] = square[r][c] > square[r][c + 1] ? GREATER : SMALLER;
+                }
+                if (r < n - 1 && rand_r(&seed) % 100 < 25) {
+                    puzzle->v_cons[r][c] = square[r][c] > square[r + 1][c] ? GREATER : SMALLER;
+                }
+            }
+        }
+        batch_puzzle_from(puzzle, use_precoloring, &puzzles[i]);
+    }
+
+    free(puzzle);
+    return true;
+}
+
+// Put puzzle `index` into lane `l`: givens on the grid, and per empty cell its slot, colors
+// and inequality neighbors (unused neighbor entries point at the always-empty slot)
+static void lane_load(LaneEngine* engine, int l, const BatchPuzzle* puzzle, int index) {
+    int n = puzzle->size;
+    for (int p = 0; p <= BATCH_CELLS; p++) engine->grid[p][l] = EMPTY;
+    for (int i = 0; i < BATCH_MAX_N; i++) engine->row_used[i][l] = engine->col_used[i][l] = 0;
+
+    int k = 0;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            int p = r * BATCH_MAX_N + c;
+            int color = puzzle->board[r][c];
+            if (color != EMPTY) {
+                engine->grid[p][l] = 1 << color;
+                engine->row_used[r][l] |= 1 << color;
+                engine->col_used[c][l] |= 1 << color;
+                continue;
+            }
+
+            int ns = 0, nl = 0;
+            int* smaller = &engine->smaller[k][0][l];  // Stride BATCH_LANES between entries
+            int* larger = &engine->larger[k][0][l];
+            if (c > 0 && puzzle->h_cons[r][c - 1] == GREATER) larger[BATCH_LANES * nl++] = p - 1;
+            if (c > 0 && puzzle->h_cons[r][c - 1] == SMALLER) smaller[BATCH_LANES * ns++] = p - 1;
+            if (c < n - 1 && puzzle->h_cons[r][c] == GREATER) smaller[BATCH_LANES * ns++] = p + 1;
+            if (c < n - 1 && puzzle->h_cons[r][c] == SMALLER) larger[BATCH_LANES * nl++] = p + 1;
+            if (r > 0 && puzzle->v_cons[r - 1][c] == GREATER) {
+                larger[BATCH_LANES * nl++] = p - BATCH_MAX_N;
+            }
+            if (r > 0 && puzzle->v_cons[r - 1][c] == SMALLER) {
+                smaller[BATCH_LANES * ns++] = p - BATCH_MAX_N;
+            }
+            if (r < n - 1 && puzzle->v_cons[r][c] == GREATER) {
+                smaller[BATCH_LANES * ns++] = p + BATCH_MAX_N;
+            }
+            if (r < n - 1 && puzzle->v_cons[r][c] == SMALLER) {
+                larger[BATCH_LANES * nl++] = p + BATCH_MAX_N;
+            }
+            while (ns < 4) smaller[BATCH_LANES * ns++] = ZERO_SLOT;
+            while (nl < 4) larger[BATCH_LANES * nl++] = ZERO_SLOT;
+
+            engine->slot[k][l] = p;
+            engine->pc_mask[k][l] = puzzle->pc_mask[r][c];
+            k++;
+        }
+    }
+
+    engine->num_cells[l] = k;
+    engine->depth[l] = 0;
+    engine->entering[l] = 1;
+    engine->max_depth[l] = 0;
+    engine->nodes[l] = 0;
+    engine->puzzle[l] = index;
+    engine->start[l] = timer_now();
+
+    // Contradicting givens are never searched, a puzzle without empty cells is already solved
+    bool conflict = false;
+    for (int r = 0; r < n && !conflict; r++) {
+        for (int c = 0; c < n; c++) {
+            int color = puzzle->board[r][c];
+            if (color == EMPTY) continue;
+            int right = c < n - 1 ? puzzle->board[r][c + 1] : EMPTY;
+            int below = r < n - 1 ? puzzle->board[r + 1][c] : EMPTY;
+            for (int i = 0; i < n; i++) {
+                if ((i != c && puzzle->board[r][i] == color) ||
+                    (i != r && puzzle->board[i][c] == color)) {
+                    conflict = true;
+                }
+            }
+            if ((right != EMPTY && puzzle->h_cons[r][c] == GREATER && color <= right) ||
+                (right != EMPTY && puzzle->h_cons[r][c] == SMALLER && color >= right) ||
+                (below != EMPTY && puzzle->v_cons[r][c] == GREATER && color <= below) ||
+                (below != EMPTY && puzzle->v_cons[r][c] == SMALLER && color >= below)) {
+                conflict = true;
+            }
+        }
+    }
+    engine->status[l] = conflict ? LANE_UNSATISFIABLE : k == 0 ? LANE_SOLVED : LANE_RUNNING;
+}
+
+// One search step in every lane: take the next color of the current cell (computing the
+// candidates first when the cell was just entered) and descend, or backtrack when none is left.
+// No lane depends on another, so the loop runs the lanes side by side; the per-depth arrays are
+// addressed flat so the compiler can turn the lookups into gathers.
+static int lanes_step(LaneEngine* engine, int first, int last) {
+    int* grid = &engine->grid[0][0];
+    int* row_used = &engine->row_used[0][0];
+    int* col_used = &engine->col_used[0][0];
+    const int* slot = &engine->slot[0][0];
+    const int* pc_mask = &engine->pc_mask[0][0];
+    int* untried = &engine->untried[0][0];
+    const int* smaller = &engine->smaller[0][0][0];
+    const int* larger = &engine->larger[0][0][0];
+
+    int finished = 0;
+#pragma omp simd reduction(| : finished)
+    for (int l = first; l < last; l++) {
+        int running = engine->status[l] == LANE_RUNNING;
+        int k = running ? engine->depth[l] : 0;
+        int at = k * BATCH_LANES + l;
+        int p = slot[at];
+        int row = (p / BATCH_MAX_N) * BATCH_LANES + l, col = (p % BATCH_MAX_N) * BATCH_LANES + l;
+
+        // Colors allowed by the row, the column and the assigned inequality neighbors
+        int allowed = pc_mask[at] & ~(row_used[row] | col_used[col]);
+        for (int i = 0; i < 4; i++) {
+            int below = grid[smaller[(k * 4 + i) * BATCH_LANES + l] * BATCH_LANES + l];
+            int above = grid[larger[(k * 4 + i) * BATCH_LANES + l] * BATCH_LANES + l];
+            allowed &= below != 0 ? ~((below << 1) - 1) : ~0;
+            allowed &= above != 0 ? above - 1 : ~0;
+        }
+        int entering = running & engine->entering[l];
+        int colors = entering ? allowed : untried[at];
+        engine->nodes[l] += entering;
+
+        // Replace the color the cell held before by the lowest untried one, or clear it. Lanes
+        // that are not running compute along on slot 0 but store back what they read, so a
+        // finished lane keeps its grid until it is handed back.
+        int cell = p * BATCH_LANES + l;
+        int old = grid[cell];
+        int bit = colors & -colors;
+        int descend = running & (colors != 0);
+        int depth = k - 1 + 2 * descend;
+        row_used[row] = running ? (row_used[row] & ~old) | bit : row_used[row];
+        col_used[col] = running ? (col_used[col] & ~old) | bit : col_used[col];
+        grid[cell] = running ? bit : old;
+        untried[at] = running ? colors & ~bit : untried[at];
+        engine->depth[l] = running ? depth : engine->depth[l];
+        engine->entering[l] = running ? descend : engine->entering[l];
+        engine->max_depth[l] = running & (depth > engine->max_depth[l]) ? depth
+                                                                         : engine->max_depth[l];
+
+        // LANE_RUNNING + 1 = LANE_SOLVED, LANE_RUNNING + 2 = LANE_UNSATISFIABLE
+        int solved = descend & (depth == engine->num_cells[l]);
+        int exhausted = running & (colors == 0) & (k == 0);
+        engine->status[l] += solved + 2 * exhausted;
+        finished |= solved | exhausted;
+    }
+    return finished;
+}
+
+// Stats and solution of a finished lane, in the layout solve_puzzle reports
+static void lane_finish(const LaneEngine* engine, int l, const BatchPuzzle* puzzle,
+                        SolverStats* stats, BatchGrid* solution) {
+    int n = puzzle->size;
+    bool solved = engine->status[l] == LANE_SOLVED;
+    memset(stats, 0, sizeof(*stats));
+    stats->precolor_time = puzzle->precolor_time;
+    stats->coloring_time = timer_now() - engine->start[l];
+    stats->total_time = stats->precolor_time + stats->coloring_time;
+    stats->colors_removed = puzzle->colors_removed;
+    stats->total_processed = n * n * n;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            stats->remaining_colors += __builtin_popcount(puzzle->pc_mask[r][c]);
+        }
+    }
+    stats->found_solution = solved;
+    stats->status = solved ? SOLVER_SOLVED : SOLVER_UNSATISFIABLE;
+    stats->nodes = engine->nodes[l];
+    stats->solutions = solved;
+    stats->best_depth = solved ? n * n : n * n - engine->num_cells[l] + engine->max_depth[l];
+    stats->strategy = STRATEGY_SEQUENTIAL;
+    stats->threads_used = 1;
+
+    if (solution) {
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) {
+                int bit = engine->grid[r * BATCH_MAX_N + c][l];
+                (*solution)[r][c] = (unsigned char)(bit != 0 ? __builtin_ctz(bit) : EMPTY);
+            }
+        }
+    }
+}
+
+// Next puzzle of the shared queue into lane `l`; false (lane idle) when the queue is empty.
+// Puzzles that are decided at load (no empty cell, or contradicting givens) never reach a step:
+// lanes_step only reports lanes it finishes itself, so they are handed back here.
+static bool lane_refill(LaneEngine* engine, int l, const BatchPuzzle* puzzles, int count,
+                        int* next, SolverStats* stats, BatchGrid* solutions) {
+    for (;;) {
+        int index;
+#pragma omp atomic capture
+        index = (*next)++;
+        if (index >= count) {
+            engine->status[l] = LANE_IDLE;
+            return false;
+        }
+        lane_load(engine, l, &puzzles[index], index);
+        if (engine->status[l] == LANE_RUNNING) return true;
+        lane_finish(engine, l, &puzzles[index], &stats[index],
+                    solutions ? &solutions[index] : NULL);
+    }
+}
+
+void solve_batch(const BatchPuzzle* puzzles, int count, int lanes, SolverStats* stats,
+                 BatchGrid* solutions) {
+    if (lanes < 1) lanes = 1;
+    if (lanes > BATCH_LANES) lanes = BATCH_LANES;
+    int next = 0;
+
+#pragma omp parallel
+    {
+        // Zeroed, so idle lanes step over valid slots
+        LaneEngine* engine = calloc(1, sizeof(LaneEngine));
+        if (!engine) {
+            printf("Error: Could not allocate batch lanes\n");
+        } else {
+            int active = 0;
+            for (int l = 0; l < lanes; l++) {
+                active += lane_refill(engine, l, puzzles, count, &next, stats, solutions);
+            }
+
+            while (active == lanes) {
+                if (!lanes_step(engine, 0, lanes)) continue;
+
+                // Hand finished puzzles back and refill their lanes
+                for (int l = 0; l < lanes; l++) {
+                    int status = engine->status[l];
+                    if (status != LANE_SOLVED && status != LANE_UNSATISFIABLE) continue;
+                    int index = engine->puzzle[l];
+                    lane_finish(engine, l, &puzzles[index], &stats[index],
+                                solutions ? &solutions[index] : NULL);
+                    if (!lane_refill(engine, l, puzzles, count, &next, stats, solutions)) {
+                        active--;
+                    }
+                }
+            }
+
+            // The queue is empty: a lockstep step would now pay for idle lanes, and a single
+            // long puzzle would run at the cost of all of them, so finish lane by lane
+            for (int l = 0; l < lanes; l++) {
+                if (engine->status[l] == LANE_IDLE) continue;
+                while (engine->status[l] == LANE_RUNNING) lanes_step(engine, l, l + 1);
+                int index = engine->puzzle[l];
+                lane_finish(engine, l, &puzzles[index], &stats[index],
+                            solutions ? &solutions[index] : NULL);
+            }
+            free(engine);
+        }
+    }
+}
+
+bool batch_is_valid_solution(const BatchPuzzle* puzzle, const BatchGrid solution) {
+    int n = puzzle->size;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            if (solution[r][c] < 1 || solution[r][c] > n) return false;
+        }
+    }
+    for (int r = 0; r < n; r++) {
+        int row_used = 0, col_used = 0;
+        for (int c = 0; c < n; c++) {
+            int v = solution[r][c];
+            if (puzzle->board[r][c] != EMPTY && puzzle->board[r][c] != v) return false;
+            row_used |= 1 << v;
+            col_used |= 1 << solution[c][r];
+            if (c < n - 1 && puzzle->h_cons[r][c] == GREATER && v <= solution[r][c + 1]) {
+                return false;
+            }
+            if (c < n - 1 && puzzle->h_cons[r][c] == SMALLER && v >= solution[r][c + 1]) {
+                return false;
+            }
+            if (r < n - 1 && puzzle->v_cons[r][c] == GREATER && v <= solution[r + 1][c]) {
+                return false;
+            }
+            if (r < n - 1 && puzzle->v_cons[r][c] == SMALLER && v >= solution[r + 1][c]) {
+                return false;
+            }
+        }
+        if (row_used != col_used || row_used != ((1 << (n + 1)) - 2)) return false;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdbool.h>
+
+#include "comparison.h"
+#include "futoshiki.h"
+
+#define BATCH_MIN_N 4
+#define BATCH_MAX_N 6
+
+// Puzzles advanced in lockstep by one thread; every step expands one node in all lanes with the
+// same instructions (8 lanes of 32 bits fill an AVX2 register, 16 an AVX-512 one)
+#ifndef BATCH_LANES
+#define BATCH_LANES 16
+#endif
+
+typedef unsigned char BatchGrid[BATCH_MAX_N][BATCH_MAX_N];
+
+// Pre-colored small puzzle in compact form (a Futoshiki is about 500 KB, this is ~150 bytes)
+typedef struct {
+    int size;
+    BatchGrid board;    // Givens (EMPTY elsewhere)
+    BatchGrid pc_mask;  // Bit c set while color c is possible
+    BatchGrid h_cons;   // Constraint between a cell and its right neighbor
+    BatchGrid v_cons;   // Constraint between a cell and the cell below
+    int colors_removed;  // By pre-coloring
+    double precolor_time;
+} BatchPuzzle;
+
+// Pre-color a parsed puzzle (pc_list is overwritten) into compact form; fails on sizes outside
+// BATCH_MIN_N..BATCH_MAX_N
+bool batch_puzzle_from(Futoshiki* puzzle, bool use_precoloring, BatchPuzzle* out);
+
+// Read and pre-color a puzzle file
+bool batch_puzzle_load(const char* filename, bool use_precoloring, BatchPuzzle* out);
+
+// Random satisfiable puzzles of sizes BATCH_MIN_N..BATCH_MAX_N (givens and inequalities taken
+// from a shuffled Latin square), reproducible from `seed`
+bool batch_generate(BatchPuzzle* puzzles, int count, unsigned int seed, bool use_precoloring);
+
+// Solve all puzzles on all threads. Every thread keeps `lanes` puzzles (1..BATCH_LANES) in
+// flight and refills a lane from the shared queue as soon as its puzzle finishes; lanes = 1 is
+// plain thread-per-puzzle execution of the same search. stats[i] is filled as solve_puzzle
+// would (coloring_time is the time the puzzle spent in its lane); solutions may be NULL, and
+// hold EMPTY cells for puzzles without a solution.
+void solve_batch(const BatchPuzzle* puzzles, int count, int lanes, SolverStats* stats,
+                 BatchGrid* solutions);
+
+// Whether `solution` is a complete Latin square that keeps all givens and inequalities
+bool batch_is_valid_solution(const BatchPuzzle* puzzle, const BatchGrid solution);
+
+#endif  // BATCH_H
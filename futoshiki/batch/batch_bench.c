@@ -0,0 +1,254 @@
+#include <omp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../timing/timer.h"
+#include "batch.h"
+#include "comparison.h"
+#include "futoshiki.h"
+
+// Throughput of the lockstep batch solver against thread-per-puzzle execution.
+//
+//   batch_bench [count]              solve `count` random 4x4 to 6x6 puzzles (default 100000)
+//   batch_bench -f list              solve the puzzle files listed one per line in `list`
+//
+// Every configuration runs on all OpenMP threads with the same shared queue; only the number
+// of puzzles each thread keeps in flight changes (1 = thread-per-puzzle). The best of `runs`
+// timings is reported, and every configuration must visit the same nodes and return valid
+// solutions, as must a few puzzles decided before the search starts. --verify also compares the
+// node count of every puzzle with the sequential search of the main solver.
+
+#define MAX_PATH 256
+
+static int read_list(const char* list, BatchPuzzle** puzzles, bool use_precoloring) {
+    FILE* file = fopen(list, "r");
+    if (!file) {
+        printf("Error: Could not open %s\n", list);
+        return -1;
+    }
+    int count = 0, capacity = 1024;
+    *puzzles = malloc(capacity * sizeof(BatchPuzzle));
+    char path[MAX_PATH];
+    while (*puzzles && fgets(path, sizeof(path), file)) {
+        path[strcspn(path, "\r\n")] = '\0';
+        if (path[0] == '\0' || path[0] == '#') continue;
+        if (count == capacity) {
+            capacity *= 2;
+            BatchPuzzle* grown = realloc(*puzzles, capacity * sizeof(BatchPuzzle));
+            if (!grown) break;
+            *puzzles = grown;
+        }
+        if (!batch_puzzle_load(path, use_precoloring, &(*puzzles)[count])) {
+            fclose(file);
+            return -1;
+        }
+        count++;
+    }
+    fclose(file);
+    return count;
+}
+
+// Node counts of the main solver's sequential search must match the lanes exactly (same cell
+// and color order)
+static bool verify_nodes(const BatchPuzzle* puzzles, int count, const SolverStats* stats) {
+    Futoshiki* puzzle = malloc(sizeof(Futoshiki));
+    if (!puzzle) return false;
+    set_solver_strategy(STRATEGY_SEQUENTIAL);
+
+    int mismatches = 0;
+    for (int i = 0; i < count; i++) {
+        const BatchPuzzle* batch = &puzzles[i];
+        int n = batch->size;
+        memset(puzzle, 0, sizeof(*puzzle));
+        puzzle->size = n;
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) {
+                puzzle->board[r][c] = batch->board[r][c];
+                if (c < n - 1) puzzle->h_cons[r][c] = batch->h_cons[r][c];
+                if (r < n - 1) puzzle->v_cons[r][c] = batch->v_cons[r][c];
+                for (int color = 1; color <= n; color++) {
+                    if (batch->pc_mask[r][c] & (1 << color)) {
+                        puzzle->pc_list[r][c][puzzle->pc_lengths[r][c]++] = color;
+                    }
+                }
+            }
+        }
+        int solution[MAX_N][MAX_N] = {{0}};
+        SolverStats reference = {0};
+        search_puzzle(puzzle, solution, &reference);
+        if (reference.nodes != stats[i].nodes || reference.status != stats[i].status) {
+            if (mismatches++ < 10) {
+                printf("Puzzle %d: %lld nodes (%s), solver %lld nodes (%s)\n", i, stats[i].nodes,
+                       solver_status_name(stats[i].status), reference.nodes,
+                       solver_status_name(reference.status));
+            }
+        }
+    }
+
+    set_solver_strategy(STRATEGY_AUTO);
+    free(puzzle);
+    printf("Verified %d puzzles against the sequential solver: %d mismatches\n\n", count,
+           mismatches);
+    return mismatches == 0;
+}
+
+// Puzzles decided before the first step, between random ones so they are loaded both at the
+// start and on refills: a fully given 4x4 is solved with 0 nodes, one with a repeated given is
+// unsatisfiable with 0 nodes. Every lane count must return them so, and finish the rest.
+static bool check_decided_at_load(bool use_precoloring) {
+    enum { RANDOM = 40, COUNT = RANDOM + 4 };
+    BatchPuzzle puzzles[COUNT];
+    SolverStats stats[COUNT];
+    BatchGrid solutions[COUNT];
+    Futoshiki* puzzle = calloc(1, sizeof(Futoshiki));
+    if (!puzzle || !batch_generate(puzzles, RANDOM, 1u, use_precoloring)) {
+        free(puzzle);
+        return false;
+    }
+
+    puzzle->size = 4;
+    for (int r = 0; r < 4; r++) {
+        for (int c = 0; c < 4; c++) puzzle->board[r][c] = (r + c) % 4 + 1;
+    }
+    BatchPuzzle full, conflict;
+    batch_puzzle_from(puzzle, use_precoloring, &full);
+    memset(puzzle, 0, sizeof(*puzzle));
+    puzzle->size = 4;
+    puzzle->board[0][0] = puzzle->board[0][3] = 2;
+    batch_puzzle_from(puzzle, use_precoloring, &conflict);
+    free(puzzle);
+
+    // Shift the random puzzles to make room at both ends of the queue
+    memmove(&puzzles[2], &puzzles[0], RANDOM * sizeof(BatchPuzzle));
+    puzzles[0] = puzzles[COUNT - 2] = full;
+    puzzles[1] = puzzles[COUNT - 1] = conflict;
+
+    bool ok = true;
+    for (int lanes = 1; lanes <= BATCH_LANES; lanes *= 2) {
+        solve_batch(puzzles, COUNT, lanes, stats, solutions);
+        for (int i = 0; i < COUNT; i++) {
+            bool is_full = i == 0 || i == COUNT - 2, is_conflict = i == 1 || i == COUNT - 1;
+            bool good = stats[i].found_solution
+                            ? batch_is_valid_solution(&puzzles[i], solutions[i]) && !is_conflict
+                            : !is_full;
+            if ((is_full || is_conflict) && stats[i].nodes != 0) good = false;
+            if (!good) {
+                printf("Decided at load, %d lanes: puzzle %d %s with %lld nodes\n", lanes, i,
+                       solver_status_name(stats[i].status), stats[i].nodes);
+                ok = false;
+            }
+        }
+    }
+    printf("Puzzles decided at load: %s\n\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    int count = 100000;
+    const char* list = NULL;
+    unsigned int seed = 20240601u;
+    int runs = 5;
+    bool use_precoloring = true;
+    bool verify = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            list = argv[++i];
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0) {
+            use_precoloring = false;
+        } else if (strcmp(argv[i], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[i], "-h") == 0) {
+            printf("Usage: %s [count] [-f list] [-s seed] [-r runs] [-n] [--verify]\n", argv[0]);
+            printf("  count: random 4x4 to 6x6 puzzles to solve (default 100000)\n");
+            printf("  -f: solve the puzzle files listed in a file instead\n");
+            printf("  -s: seed of the random puzzles\n");
+            printf("  -r: timed runs per configuration, the best one is reported (default 5)\n");
+            printf("  -n: disable precoloring\n");
+            printf("  --verify: compare every node count with the main solver's search\n");
+            return 0;
+        } else {
+            count = atoi(argv[i]);
+        }
+    }
+    if (runs < 1) runs = 1;
+
+    BatchPuzzle* puzzles = NULL;
+    if (list) {
+        count = read_list(list, &puzzles, use_precoloring);
+        if (count < 0) return 1;
+    } else {
+        puzzles = malloc((count > 0 ? count : 1) * sizeof(BatchPuzzle));
+        if (!puzzles || !batch_generate(puzzles, count, seed, use_precoloring)) return 1;
+    }
+    SolverStats* stats = malloc((count > 0 ? count : 1) * sizeof(SolverStats));
+    BatchGrid* solutions = malloc((count > 0 ? count : 1) * sizeof(BatchGrid));
+    if (!stats || !solutions) {
+        printf("Error: Could not allocate results for %d puzzles\n", count);
+        return 1;
+    }
+
+    printf("Batch solver: %d puzzles, %d threads, %d lanes per thread at most, best of %d runs\n\n",
+           count, omp_get_max_threads(), BATCH_LANES, runs);
+    printf("%-22s %12s %14s %14s %10s  %s\n", "Configuration", "Time [s]", "Puzzles/s",
+           "Nodes/s", "Speedup", "Result");
+
+    int configs[] = {1, 4, 8, 16, 32};
+    double base_time = 0;
+    long long base_nodes = -1;
+    bool ok = true;
+    for (int c = 0; c < (int)(sizeof(configs) / sizeof(configs[0])); c++) {
+        int lanes = configs[c];
+        if (lanes > BATCH_LANES) break;
+
+        double best = 0;
+        for (int run = 0; run < runs; run++) {
+            double start = timer_now();
+            solve_batch(puzzles, count, lanes, stats, solutions);
+            double elapsed = timer_now() - start;
+            if (run == 0 || elapsed < best) best = elapsed;
+        }
+
+        long long nodes = 0;
+        int invalid = 0, solved = 0;
+        for (int i = 0; i < count; i++) {
+            nodes += stats[i].nodes;
+            if (stats[i].found_solution) {
+                solved++;
+                if (!batch_is_valid_solution(&puzzles[i], solutions[i])) invalid++;
+            }
+        }
+        if (lanes == 1) {
+            base_time = best;
+            base_nodes = nodes;
+        }
+
+        const char* result = "ok";
+        if (invalid > 0) {
+            result = "INVALID SOLUTIONS";
+            ok = false;
+        } else if (nodes != base_nodes) {
+            result = "NODES DIFFER";
+            ok = false;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), lanes == 1 ? "thread-per-puzzle" : "lockstep x%d", lanes);
+        printf("%-22s %12.6f %14.0f %14.0f %9.2fx  %s (%d solved, %lld nodes)\n", name, best,
+               count / best, nodes / best, base_time / best, result, solved, nodes);
+    }
+    printf("\n");
+
+    if (verify && !verify_nodes(puzzles, count, stats)) ok = false;
+    if (!check_decided_at_load(use_precoloring)) ok = false;
+
+    free(solutions);
+    free(stats);
+    free(puzzles);
+    return ok ? 0 : 1;
+}
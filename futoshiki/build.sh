@@ -4,9 +4,22 @@
 module load openmpi-4.0.4
 
 # Build with OpenMP and C99 standard
+gcc -fopenmp -std=c99 -Wall -g -c checkpoint.c -o checkpoint.o
 gcc -fopenmp -std=c99 -Wall -g -c comparison.c -o comparison.o
+gcc -fopenmp -std=c99 -Wall -g -c estimate.c -o estimate.o
 gcc -fopenmp -std=c99 -Wall -g -c futoshiki.c -o futoshiki.o
+gcc -fopenmp -std=c99 -Wall -g -c incremental.c -o incremental.o
+gcc -fopenmp -std=c99 -Wall -g -c localsearch.c -o localsearch.o
+gcc -fopenmp -std=c99 -Wall -g -c log.c -o log.o
 gcc -fopenmp -std=c99 -Wall -g -c main.c -o main.o
+gcc -fopenmp -std=c99 -Wall -g -c omp_profile.c -o omp_profile.o
+gcc -fopenmp -std=c99 -Wall -g -c rowsearch.c -o rowsearch.o
+gcc -fopenmp -std=c99 -Wall -g -c perf_counters.c -o perf_counters.o
+gcc -fopenmp -std=c99 -Wall -g -c ../timing/timer.c -o timer.o
+gcc -fopenmp -std=c99 -Wall -g -c topology.c -o topology.o
+gcc -fopenmp -std=c99 -Wall -g -c trace.c -o trace.o
 
 # Link with OpenMP
-gcc -fopenmp comparison.o futoshiki.o main.o -o futoshiki
\ No newline at end of file
+gcc -fopenmp checkpoint.o comparison.o estimate.o futoshiki.o incremental.o \
+    localsearch.o log.o main.o omp_profile.o perf_counters.o rowsearch.o timer.o topology.o \
+    trace.o -o futoshiki -lm
\ No newline at end of file
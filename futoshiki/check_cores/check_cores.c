@@ -1,10 +1,167 @@
+#include <math.h>
 #include <stdio.h>
 #include <omp.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/sysinfo.h>
 
-int main() {
+#include "../../timing/timer.h"
+#include "omp_profile.h"
+#include "topology.h"
+
+// EPCC-style overhead measurement: every construct wraps a short busy delay and is timed
+// against the same delays without it. Each test is repeated OUTER_REPS times; samples further
+// than OUTLIER_MADS median absolute deviations from the median are rejected.
+#define OUTER_REPS 20
+#define OUTLIER_MADS 3.0
+#define DELAY_US 0.1          // Work inside each construct
+#define TARGET_TEST_US 1000.0 // Minimum duration of one timed sample
+
+static int delay_length = 1;
+static int inner_reps = 1;
+
+static void delay(int length) {
+    volatile double a = 0.0;
+    for (int i = 0; i < length; i++) a += i;
+}
+
+// Busy loop length that takes about DELAY_US
+static void calibrate_delay(void) {
+    double elapsed = 0.0;
+    for (delay_length = 1; elapsed < DELAY_US * 1e-6 * 1000; delay_length *= 2) {
+        double start = timer_now();
+        for (int i = 0; i < 1000; i++) delay(delay_length);
+        elapsed = timer_now() - start;
+    }
+    delay_length = (int)(delay_length * DELAY_US * 1e-6 * 1000 / elapsed) + 1;
+}
+
+static void test_reference(int threads) {
+    (void)threads;
+    for (int i = 0; i < inner_reps; i++) delay(delay_length);
+}
+
+static void test_parallel(int threads) {
+    for (int i = 0; i < inner_reps; i++) {
+        #pragma omp parallel num_threads(threads)
+        delay(delay_length);
+    }
+}
+
+static void test_critical(int threads) {
+    #pragma omp parallel num_threads(threads)
+    {
+        for (int i = 0; i < inner_reps / threads; i++) {
+            #pragma omp critical
+            delay(delay_length);
+        }
+    }
+}
+
+static void test_task(int threads) {
+    #pragma omp parallel num_threads(threads)
+    {
+        for (int i = 0; i < inner_reps / threads; i++) {
+            #pragma omp task
+            delay(delay_length);
+        }
+    }
+}
+
+static void test_taskwait(int threads) {
+    #pragma omp parallel num_threads(threads)
+    {
+        for (int i = 0; i < inner_reps / threads; i++) {
+            #pragma omp task
+            delay(delay_length);
+            #pragma omp taskwait
+        }
+    }
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Mean time of one test in microseconds after outlier rejection
+static double time_test(void (*test)(int), int threads, int* rejected) {
+    double samples[OUTER_REPS], sorted[OUTER_REPS], deviation[OUTER_REPS];
+    test(threads);  // Warm-up: create the team, fault in the stacks
+    for (int k = 0; k < OUTER_REPS; k++) {
+        double start = timer_now();
+        test(threads);
+        samples[k] = (timer_now() - start) * 1e6;
+    }
+
+    memcpy(sorted, samples, sizeof(sorted));
+    qsort(sorted, OUTER_REPS, sizeof(double), compare_doubles);
+    double median = sorted[OUTER_REPS / 2];
+    for (int k = 0; k < OUTER_REPS; k++) deviation[k] = fabs(samples[k] - median);
+    qsort(deviation, OUTER_REPS, sizeof(double), compare_doubles);
+    double mad = deviation[OUTER_REPS / 2];
+
+    double sum = 0.0;
+    int kept = 0;
+    for (int k = 0; k < OUTER_REPS; k++) {
+        if (fabs(samples[k] - median) <= OUTLIER_MADS * mad) {
+            sum += samples[k];
+            kept++;
+        }
+    }
+    *rejected += OUTER_REPS - kept;
+    return sum / kept;
+}
+
+// Overheads per construct for one team size
+static void measure_overheads(int threads, OmpOverheads* row, int* rejected) {
+    // Enough repetitions that one sample lasts TARGET_TEST_US, divisible by the team size
+    for (inner_reps = threads;; inner_reps *= 2) {
+        double start = timer_now();
+        test_parallel(threads);
+        if ((timer_now() - start) * 1e6 >= TARGET_TEST_US) break;
+    }
+
+    // Serial delays equivalent to the work of one test
+    double reference = time_test(test_reference, threads, rejected);
+    double per_thread = reference / threads;
+    row->threads = threads;
+    row->parallel_us = (time_test(test_parallel, threads, rejected) - reference) / inner_reps;
+    row->critical_us = (time_test(test_critical, threads, rejected) - reference) / inner_reps;
+    row->task_us = (time_test(test_task, threads, rejected) - per_thread) / (inner_reps / threads);
+    row->taskwait_us =
+        (time_test(test_taskwait, threads, rejected) - per_thread) / (inner_reps / threads);
+}
+
+static void run_overhead_benchmarks(const char* profile_path) {
+    printf("\n===== OpenMP Overheads (EPCC method) =====\n");
+    calibrate_delay();
+    printf("Delay: %d iterations (about %.2f us), %d samples per test\n", delay_length, DELAY_US,
+           OUTER_REPS);
+    printf("%8s %12s %12s %12s %12s %9s\n", "Threads", "Parallel", "Task", "Taskwait",
+           "Critical", "Outliers");
+
+    OmpProfile profile;
+    profile.count = 0;
+    int max_threads = omp_get_max_threads();
+    // Powers of two and the full team
+    for (int threads = 1; profile.count < OMP_PROFILE_MAX_ROWS; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        OmpOverheads* row = &profile.rows[profile.count++];
+        int rejected = 0;
+        measure_overheads(threads, row, &rejected);
+        printf("%8d %9.3f us %9.3f us %9.3f us %9.3f us %9d\n", threads, row->parallel_us,
+               row->task_us, row->taskwait_us, row->critical_us, rejected);
+        if (threads == max_threads) break;
+    }
+
+    if (profile_path && omp_profile_write(profile_path, &profile)) {
+        printf("Profile written to %s (solver: --profile %s)\n", profile_path, profile_path);
+    }
+}
+
+int main(int argc, char* argv[]) {
     int nprocs = 0;
     int max_threads = 0;
     
@@ -17,9 +174,20 @@ int main() {
     // Try to get from sysinfo
     struct sysinfo info;
     if (sysinfo(&info) == 0) {
-        printf("Number of processors (sysinfo): %ld\n", info.procs);
+        printf("Number of processors (sysinfo): %ld\n", (long)info.procs);
     }
     
+    // Sockets, NUMA nodes, cores and SMT siblings available to this process
+    Topology topo;
+    bool have_topology = topology_discover(&topo);
+    printf("\n===== CPU Topology (sysfs) =====\n");
+    if (have_topology) {
+        topology_print(&topo);
+    } else {
+        printf("Topology not available\n");
+    }
+    printf("\n");
+
     // Get OpenMP threads
     #pragma omp parallel
     {
@@ -29,11 +197,13 @@ int main() {
             printf("OpenMP threads available: %d\n", max_threads);
         }
         
-        // Show thread IDs
+        // Show thread IDs and where they run
+        int cpu = topology_current_cpu();
         #pragma omp critical
         {
-            printf("Thread %d/%d running\n", 
-                   omp_get_thread_num(), omp_get_num_threads());
+            printf("Thread %d/%d running on CPU %d (NUMA node %d)\n", 
+                   omp_get_thread_num(), omp_get_num_threads(), cpu,
+                   have_topology ? topology_numa_node_of(&topo, cpu) : -1);
         }
     }
     
@@ -47,7 +217,11 @@ int main() {
         printf("OMP_NUM_THREADS is not set\n");
     }
     
+    // Construct overheads across team sizes, optionally saved for the solver's dispatch
+    run_overhead_benchmarks(argc > 1 ? argv[1] : NULL);
+
     printf("===================================\n");
-    
+
+    if (have_topology) topology_free(&topo);
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "checkpoint.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CHECKPOINT_MAGIC "FUTOSHIKI-CHECKPOINT"
+#define CHECKPOINT_VERSION 1
+
+bool checkpoint_write(const char* path, const CheckpointHeader* header, const Frontier* frontier,
+                      const unsigned char* done) {
+    char tmp_path[1024];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE* file = fopen(tmp_path, "w");
+    if (!file) {
+        printf("Error: Could not write checkpoint %s\n", tmp_path);
+        return false;
+    }
+
+    int pending = 0;
+    for (int i = 0; i < frontier->count; i++) {
+        if (!done[i]) pending++;
+    }
+
+    fprintf(file, "%s %d\n", CHECKPOINT_MAGIC, CHECKPOINT_VERSION);
+    fprintf(file, "fingerprint %lx\n", header->fingerprint);
+    fprintf(file, "solutions %lld\n", header->solutions);
+    fprintf(file, "nodes %lld\n", header->nodes);
+    fprintf(file, "depth %d\n", frontier->depth);
+    fprintf(file, "pending %d\n", pending);
+
+    // One line per unexplored prefix
+    for (int i = 0; i < frontier->count; i++) {
+        if (done[i]) continue;
+        const unsigned char* prefix = &frontier->colors[(size_t)i * frontier->depth];
+        for (int k = 0; k < frontier->depth; k++) {
+            fprintf(file, k == 0 ? "%d" : " %d", prefix[k]);
+        }
+        fprintf(file, "\n");
+    }
+
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok || rename(tmp_path, path) != 0) {
+        printf("Error: Could not write checkpoint %s\n", path);
+        remove(tmp_path);
+        return false;
+    }
+    return true;
+}
+
+bool checkpoint_read(const char* path, CheckpointHeader* header, Frontier* frontier) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Error: Could not open checkpoint %s\n", path);
+        return false;
+    }
+
+    char magic[32];
+    int version, pending;
+    bool ok = fscanf(file, "%31s %d", magic, &version) == 2 &&
+              strcmp(magic, CHECKPOINT_MAGIC) == 0 && version == CHECKPOINT_VERSION &&
+              fscanf(file, " fingerprint %lx", &header->fingerprint) == 1 &&
+              fscanf(file, " solutions %lld", &header->solutions) == 1 &&
+              fscanf(file, " nodes %lld", &header->nodes) == 1 &&
+              fscanf(file, " depth %d", &frontier->depth) == 1 &&
+              fscanf(file, " pending %d", &pending) == 1 && frontier->depth >= 0 && pending >= 0;
+
+    frontier->count = 0;
+    frontier->colors = NULL;
+    if (ok) {
+        frontier->colors = malloc((size_t)pending * frontier->depth + 1);
+        for (int i = 0; ok && i < pending; i++) {
+            for (int k = 0; ok && k < frontier->depth; k++) {
+                int color;
+                ok = fscanf(file, "%d", &color) == 1 && color > 0 && color < 256;
+                if (ok) frontier->colors[(size_t)i * frontier->depth + k] = (unsigned char)color;
+            }
+        }
+        frontier->count = pending;
+    }
+    fclose(file);
+
+    if (!ok) {
+        printf("Error: Malformed checkpoint %s\n", path);
+        frontier_free(frontier);
+        return false;
+    }
+    return true;
+}
+
+void frontier_free(Frontier* frontier) {
+    free(frontier->colors);
+    frontier->colors = NULL;
+    frontier->count = 0;
+}
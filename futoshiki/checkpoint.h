@@ -0,0 +1,30 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdbool.h>
+
+// Top-level subtrees of the parallel search: each prefix fixes the colors of the first
+// `depth` empty cells (row-major order)
+typedef struct {
+    int depth;              // Empty cells fixed by each prefix
+    int count;              // Number of prefixes
+    unsigned char* colors;  // count x depth colors, prefix i starts at colors[i * depth]
+} Frontier;
+
+typedef struct {
+    unsigned long fingerprint;  // Hash of the puzzle the checkpoint belongs to
+    long long solutions;        // Solutions found in completed prefixes (count mode)
+    long long nodes;            // Nodes visited in completed prefixes
+} CheckpointHeader;
+
+// Write the prefixes not marked in `done` to `path`. The file is written to a temporary
+// name first and renamed, so a job killed mid-write leaves the previous checkpoint intact.
+bool checkpoint_write(const char* path, const CheckpointHeader* header, const Frontier* frontier,
+                      const unsigned char* done);
+
+// Load a checkpoint; its pending prefixes become `frontier` (to be freed by the caller)
+bool checkpoint_read(const char* path, CheckpointHeader* header, Frontier* frontier);
+
+void frontier_free(Frontier* frontier);
+
+#endif  // CHECKPOINT_H
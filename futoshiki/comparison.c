@@ -4,6 +4,75 @@
 
 #include "futoshiki.h"
 
+const char* solver_status_name(SolverStatus status) {
+    switch (status) {
+        case SOLVER_SOLVED:
+            return "solved";
+        case SOLVER_UNSATISFIABLE:
+            return "unsatisfiable";
+        case SOLVER_TIMEOUT:
+            return "timeout";
+        case SOLVER_NODE_LIMIT:
+            return "node limit";
+        case SOLVER_MEMORY_LIMIT:
+            return "memory limit";
+        case SOLVER_ERROR:
+            return "error";
+    }
+    return "unknown";
+}
+
+const char* solver_strategy_name(SolverStrategy strategy) {
+    switch (strategy) {
+        case STRATEGY_AUTO:
+            return "auto";
+        case STRATEGY_SEQUENTIAL:
+            return "sequential";
+        case STRATEGY_SHALLOW:
+            return "shallow-parallel";
+        case STRATEGY_DEEP:
+            return "deep-parallel";
+    }
+    return "unknown";
+}
+
+static void print_perf_counters(const SolverStats* stats) {
+    static const char* phase_names[NUM_PHASES] = {"parse", "precoloring", "search"};
+
+    printf("\n  Hardware counters:\n");
+    if (!stats->perf_available) {
+        printf("  unavailable (perf_event_open failed, see /proc/sys/kernel/perf_event_paranoid)\n");
+        return;
+    }
+
+    printf("  %-14s", "");
+    for (int p = 0; p < NUM_PHASES; p++) printf(" %16s", phase_names[p]);
+    printf("\n");
+
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        printf("  %-14s", perf_event_name(e));
+        for (int p = 0; p < NUM_PHASES; p++) {
+            if (stats->perf[p].valid[e]) {
+                printf(" %16lld", stats->perf[p].counts[e]);
+            } else {
+                printf(" %16s", "n/a");
+            }
+        }
+        printf("\n");
+    }
+
+    printf("  %-14s", "IPC");
+    for (int p = 0; p < NUM_PHASES; p++) {
+        const PerfCounts* c = &stats->perf[p];
+        if (c->valid[PERF_CYCLES] && c->valid[PERF_INSTRUCTIONS] && c->counts[PERF_CYCLES] > 0) {
+            printf(" %16.2f", (double)c->counts[PERF_INSTRUCTIONS] / c->counts[PERF_CYCLES]);
+        } else {
+            printf(" %16s", "n/a");
+        }
+    }
+    printf("\n");
+}
+
 void print_stats(const SolverStats* stats, const char* prefix) {
     printf("%s Results:\n", prefix);
     printf("  Colors removed in precoloring: %d\n", stats->colors_removed);
@@ -13,7 +82,41 @@ void print_stats(const SolverStats* stats, const char* prefix) {
     printf("  List-coloring phase: %.6f seconds\n", stats->coloring_time);
     printf("  Total solving time: %.6f seconds\n", stats->total_time);
 
+    printf("\n  Search:\n");
+    printf("  Dispatch: %s (estimated %.3g nodes), %d threads, %d prefixes per thread\n",
+           solver_strategy_name(stats->strategy), stats->estimated_nodes, stats->threads_used,
+           stats->tasks_per_thread);
+    if (stats->kernel_size > 0) {
+        printf("  Search kernel: specialized %dx%d\n", stats->kernel_size, stats->kernel_size);
+    } else {
+        printf("  Search kernel: generic\n");
+    }
+    if (stats->local_walkers > 0) {
+        printf("  Local search: %d walkers, %lld moves, %d hand-offs, best %d conflicts\n",
+               stats->local_walkers, stats->local_moves, stats->handoffs, stats->best_conflicts);
+    }
+    if (stats->row_permutations > 0) {
+        printf("  Row tables: %lld candidates, built in %.6f seconds\n", stats->row_permutations,
+               stats->row_table_time);
+    }
+    if (stats->escalated) {
+        printf("  Dispatch escalated after the sequential trial exceeded its node cap\n");
+    }
+    printf("  Nodes visited: %lld\n", stats->nodes);
+    printf("  Top-level frontier explored: %d/%d\n", stats->frontier_explored,
+           stats->frontier_total);
+
     printf("  Found solution: %s\n", stats->found_solution ? "Yes" : "No");
+    printf("  Solutions found: %lld\n", stats->solutions);
+    printf("  Status: %s\n", solver_status_name(stats->status));
+    if (!stats->found_solution && stats->status != SOLVER_UNSATISFIABLE &&
+        stats->status != SOLVER_ERROR) {
+        printf("  Deepest partial assignment: %d cells\n", stats->best_depth);
+    }
+
+    if (stats->perf_enabled) {
+        print_perf_counters(stats);
+    }
 }
 
 void print_comparison(const SolverStats* with_precolor, const SolverStats* without_precolor) {
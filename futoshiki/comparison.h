@@ -3,6 +3,28 @@
 
 #include <stdbool.h>
 
+#include "perf_counters.h"
+
+typedef enum {
+    SOLVER_SOLVED = 0,     // A solution was found
+    SOLVER_UNSATISFIABLE,  // The whole search space was explored without a solution
+    SOLVER_TIMEOUT,        // Wall-clock budget exhausted
+    SOLVER_NODE_LIMIT,     // Node budget exhausted
+    SOLVER_MEMORY_LIMIT,   // Memory budget exhausted
+    SOLVER_ERROR           // The puzzle could not be read
+} SolverStatus;
+
+// Phases with separate hardware counter totals
+typedef enum { PHASE_PARSE = 0, PHASE_PRECOLOR, PHASE_SEARCH, NUM_PHASES } SolverPhase;
+
+// How the search is run; AUTO picks one of the others from a tree-size estimate
+typedef enum {
+    STRATEGY_AUTO = 0,
+    STRATEGY_SEQUENTIAL,  // Calling thread only, no parallel region
+    STRATEGY_SHALLOW,     // Few threads, few prefixes per thread
+    STRATEGY_DEEP         // All threads, many prefixes per thread
+} SolverStrategy;
+
 typedef struct {
     double precolor_time;
     double coloring_time;
@@ -11,8 +33,34 @@ typedef struct {
     int remaining_colors;
     int total_processed;
     bool found_solution;
+    SolverStatus status;
+    long long nodes;        // Search nodes visited over all threads
+    long long solutions;    // Solutions found (all of them in count mode)
+    int frontier_total;     // Top-level subtrees (prefixes of the search frontier)
+    int frontier_explored;  // Top-level subtrees that were searched to completion
+    int best_depth;         // Cells assigned in the deepest consistent partial assignment
+    SolverStrategy strategy;  // Strategy the search ran with
+    double estimated_nodes;   // Tree-size estimate the strategy was chosen from
+    bool escalated;           // A capped sequential trial ran out of nodes first
+    int threads_used;
+    int tasks_per_thread;     // Target frontier prefixes per thread (task cutoff)
+    int kernel_size;          // Board size of the specialized search kernel (0 = generic)
+    int local_walkers;        // Local search walkers (0 = backtracking only)
+    long long local_moves;    // Swaps made by all walkers
+    int handoffs;             // Exact repairs of nearly solved walkers
+    int best_conflicts;       // Fewest violated constraints any walker reached
+    long long row_permutations;  // Row search candidates over all rows (0 = cell search)
+    double row_table_time;       // Seconds spent enumerating them
+    bool perf_enabled;      // Hardware counters were requested
+    bool perf_available;    // ... and could be opened
+    PerfCounts perf[NUM_PHASES];  // Per phase, search summed over all threads
 } SolverStats;
 
+// Human-readable name of a solver status
+const char* solver_status_name(SolverStatus status);
+
+const char* solver_strategy_name(SolverStrategy strategy);
+
 // Print detailed statistics for a single solver run
 void print_stats(const SolverStats* stats, const char* prefix);
 
@@ -0,0 +1,50 @@
+#include "estimate.h"
+
+#include <string.h>
+
+// xorshift32, good enough to pick among at most MAX_N colors
+static unsigned int next_random(unsigned int* state) {
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+static double probe(const Futoshiki* puzzle, int base[MAX_N][MAX_N], unsigned int* rng) {
+    int solution[MAX_N][MAX_N];
+    memcpy(solution, base, sizeof(solution));
+
+    double estimate = 1.0;
+    double width = 1.0;  // Product of the branching factors seen so far
+    for (int row = 0; row < puzzle->size; row++) {
+        for (int col = 0; col < puzzle->size; col++) {
+            if (puzzle->board[row][col] != EMPTY) continue;
+
+            int candidates[MAX_N];
+            int num_candidates = 0;
+            for (int i = 0; i < puzzle->pc_lengths[row][col]; i++) {
+                int color = puzzle->pc_list[row][col][i];
+                if (safe(puzzle, row, col, solution, color)) {
+                    candidates[num_candidates++] = color;
+                }
+            }
+            if (num_candidates == 0) return estimate;  // Dead end
+
+            width *= num_candidates;
+            estimate += width;
+            solution[row][col] = candidates[next_random(rng) % num_candidates];
+        }
+    }
+    return estimate;
+}
+
+double estimate_search_nodes(const Futoshiki* puzzle, int base[MAX_N][MAX_N], int probes,
+                             unsigned int seed) {
+    unsigned int rng = seed ? seed : 1;
+    double total = 0.0;
+    for (int p = 0; p < probes; p++) {
+        total += probe(puzzle, base, &rng);
+    }
+    return probes > 0 ? total / probes : 0.0;
+}
@@ -0,0 +1,14 @@
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include "futoshiki.h"
+
+// Knuth's random-probe estimate of the number of nodes color_g_seq visits to exhaust the
+// search tree. Every probe walks from the root to a leaf or dead end, choosing uniformly among
+// the safe colors of each empty cell (row-major, precolored domains), and estimates the tree as
+// 1 + d1 + d1*d2 + ... for the branching factors d_k it saw. The mean over all probes is an
+// unbiased estimate. `base` holds the givens; `seed` makes the estimate reproducible.
+double estimate_search_nodes(const Futoshiki* puzzle, int base[MAX_N][MAX_N], int probes,
+                             unsigned int seed);
+
+#endif  // ESTIMATE_H
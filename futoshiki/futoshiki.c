@@ -1,54 +1,230 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf
+
 #include "futoshiki.h"
 
 #include <ctype.h>
+#include <limits.h>
 #include <omp.h>
-#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/time.h>
+#include <unistd.h>
 
+#include "../timing/timer.h"
+#include "checkpoint.h"
 #include "comparison.h"
+#include "estimate.h"
+#include "log.h"
+#include "omp_profile.h"
+#include "perf_counters.h"
+#include "topology.h"
+#include "trace.h"
+
+// Number of search nodes a thread visits between two budget checks (power of two)
+#define BUDGET_CHECK_INTERVAL 4096
+
+// Random probes of the tree-size estimator behind the automatic dispatch
+#define ESTIMATE_PROBES 256
+#define ESTIMATE_SEED 12345u
+
+// A sequential run chosen from the estimate may visit this many times the sequential threshold
+// before it is abandoned for the deep-parallel strategy
+#define SEQUENTIAL_TRIAL_FACTOR 16
+
+// Conversion of measured OpenMP overheads (omp_profile.h) into dispatch thresholds: time of one
+// search node with the specialized 9x9 kernel, the factor by which the search must outweigh the
+// overhead of going parallel, and the critical sections a worker enters per prefix
+#define NODE_TIME_US 0.03
+#define PARALLEL_PAYOFF 100.0
+#define PREFIX_CRITICALS 4
+
+// Board sizes with a compile-time specialized search kernel (kernel_template.h)
+#define KERNEL_MIN_N 4
+#define KERNEL_MAX_N 16
+
+// NUMA domains with a work queue of their own; threads of any further domain share queue 0
+#define MAX_NUMA_DOMAINS 64
+
+// Per-task search state, threaded through the recursion to keep the hot loop lock-free
+typedef struct {
+    long long nodes;                  // Nodes visited by this task
+    long long node_cap;               // Nodes this task may visit before it gives up
+    long long solutions;              // Solutions found by this task (count mode)
+    bool aborted;                     // Task gave up because the search was stopped
+    int best_depth;                   // Deepest consistent prefix reached (cells assigned)
+    int best_solution[MAX_N][MAX_N];  // Assignment at best_depth
+} SearchContext;
 
-#define MAX_N 50
-#define EMPTY 0
+static bool g_show_progress = false;
+static bool g_count_all = false;
+static bool g_pin_threads = false;
+static bool g_perf_counters = false;
+static bool g_generic_kernel = false;
+static SolverStrategy g_strategy = STRATEGY_AUTO;
+static DispatchConfig g_dispatch = {
+    2e4,  // sequential_max_nodes: below this a parallel region costs more than the search
+    5e7,  // shallow_max_nodes
+    1e5,  // nodes_per_thread
+    2,    // shallow_tasks_per_thread
+    16,   // deep_tasks_per_thread: top-level subtrees per thread so uneven subtrees balance out
+};
+static SolverLimits g_limits = {0};
+static CheckpointConfig g_checkpoint = {NULL, 60.0, NULL};
+static omp_lock_t g_checkpoint_lock;
+static double g_next_checkpoint = 0.0;
+static void checkpoint_if_due(void);
+
+// Shared search state, reset by solve_puzzle before every run
+static bool g_stop = false;                     // Set once any thread ends the search
+static SolverStatus g_stop_status = SOLVER_SOLVED;  // Why the search was stopped
+static long long g_budget_nodes = 0;            // Nodes reported at budget checks
+static double g_deadline = 0.0;                 // Absolute wall-clock limit (0 = none)
+
+void set_progress_display(bool show) {
+    if (!show) log_close();  // Flush and free the rings of an earlier verbose run
+    g_show_progress = show && log_open(omp_get_max_threads());
+}
 
-typedef enum { NO_CONS = 0, GREATER = 1, SMALLER = 2 } Constraint;
+void set_solver_limits(const SolverLimits* limits) { g_limits = *limits; }
 
-typedef struct {
-    int size;                             // Size of the puzzle (N)
-    int board[MAX_N][MAX_N];              // The puzzle grid (0 means empty cell)
-    Constraint h_cons[MAX_N][MAX_N - 1];  // Horizontal inequality constraints
-    Constraint v_cons[MAX_N - 1][MAX_N];  // Vertical inequality constraints
-    int pc_list[MAX_N][MAX_N][MAX_N];     // Possible colors for each cell
-                                          // [row][col][possible_values]
-    int pc_lengths[MAX_N][MAX_N];         // Possible colors list length for each cell
-} Futoshiki;
+void get_solver_limits(SolverLimits* limits) { *limits = g_limits; }
 
-static bool g_show_progress = false;
+void set_count_mode(bool count_all) { g_count_all = count_all; }
 
-void set_progress_display(bool show) { g_show_progress = show; }
+bool get_count_mode(void) { return g_count_all; }
 
-static void print_progress(const char* format, ...) {
-    if (!g_show_progress) return;
+void set_thread_pinning(bool pin) { g_pin_threads = pin; }
 
-    va_list args;
-    va_start(args, format);
-    printf("[PROGRESS] ");
-    vprintf(format, args);
-    printf("\n");
-    va_end(args);
+void set_perf_counters(bool enable) { g_perf_counters = enable; }
+
+void set_generic_kernel(bool generic) { g_generic_kernel = generic; }
+
+void set_solver_strategy(SolverStrategy strategy) { g_strategy = strategy; }
+
+SolverStrategy get_solver_strategy(void) { return g_strategy; }
+
+void set_dispatch_config(const DispatchConfig* config) { g_dispatch = *config; }
+
+void get_dispatch_config(DispatchConfig* config) { *config = g_dispatch; }
+
+bool load_dispatch_profile(const char* path) {
+    OmpProfile profile;
+    if (!omp_profile_read(path, &profile)) return false;
+    const OmpOverheads* row = omp_profile_lookup(&profile, omp_get_max_threads());
+    if (!row) {
+        printf("Error: Profile %s has no measurement for %d threads or fewer\n", path,
+               omp_get_max_threads());
+        return false;
+    }
+
+    // Going parallel at all must pay for the fork/join; every further thread for the fork/join
+    // share and the synchronization around its prefixes
+    double prefix_us = PREFIX_CRITICALS * row->critical_us;
+    double per_thread_us = row->parallel_us + g_dispatch.shallow_tasks_per_thread * prefix_us;
+    g_dispatch.sequential_max_nodes = PARALLEL_PAYOFF * row->parallel_us / NODE_TIME_US;
+    g_dispatch.nodes_per_thread = PARALLEL_PAYOFF * per_thread_us / NODE_TIME_US;
+    if (g_dispatch.shallow_max_nodes < g_dispatch.sequential_max_nodes) {
+        g_dispatch.shallow_max_nodes = g_dispatch.sequential_max_nodes;
+    }
+    return true;
+}
+
+void set_checkpoint_config(const CheckpointConfig* config) {
+    g_checkpoint = *config;
+    if (!g_checkpoint.path) {
+        g_checkpoint.path = g_checkpoint.resume_path;  // Keep checkpointing into the same file
+    }
+    if (g_checkpoint.interval <= 0) {
+        g_checkpoint.interval = 60.0;
+    }
+}
+
+void get_checkpoint_config(CheckpointConfig* config) { *config = g_checkpoint; }
+
+// Current resident set size; unlike the ru_maxrss high-water mark it drops again once a solve
+// frees its memory, so one large solve does not fail every later one in the same process
+static long current_rss_mb(void) {
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    long total_pages = 0, resident_pages = 0;
+    int fields = fscanf(file, "%ld %ld", &total_pages, &resident_pages);
+    fclose(file);
+    if (fields != 2) return 0;
+    return (long)((long long)resident_pages * sysconf(_SC_PAGESIZE) / (1024 * 1024));
+}
+
+static void reset_search_state(void) {
+    g_stop = false;
+    g_stop_status = SOLVER_SOLVED;
+    g_budget_nodes = 0;
+    g_deadline = g_limits.time_limit > 0 ? timer_now() + g_limits.time_limit : 0.0;
+}
+
+static bool search_stopped(void) {
+    bool stop;
+#pragma omp atomic read
+    stop = g_stop;
+    return stop;
+}
+
+// First caller wins: later reasons (e.g. a timeout racing a solution) are ignored
+static void stop_search(SolverStatus reason) {
+#pragma omp critical(stop_search)
+    {
+        if (!g_stop) {
+            g_stop_status = reason;
+#pragma omp atomic write
+            g_stop = true;
+            trace_instant("stop search", reason);
+        }
+    }
+}
+
+// Slow path of the budget check, reached once every BUDGET_CHECK_INTERVAL nodes
+static bool check_budgets(void) {
+    long long total;
+#pragma omp atomic capture
+    total = g_budget_nodes += BUDGET_CHECK_INTERVAL;
+
+    if (g_limits.node_limit > 0 && total >= g_limits.node_limit) {
+        stop_search(SOLVER_NODE_LIMIT);
+    } else if (g_deadline > 0 && timer_now() >= g_deadline) {
+        stop_search(SOLVER_TIMEOUT);
+    } else if (g_limits.memory_limit_mb > 0 && current_rss_mb() >= g_limits.memory_limit_mb) {
+        stop_search(SOLVER_MEMORY_LIMIT);
+    }
+    // Long subtrees must not hold back the checkpoints of the prefixes finished meanwhile
+    checkpoint_if_due();
+    return !search_stopped();
+}
+
+// Count a node and decide whether the search may go on; the common case is one increment
+static inline bool visit_node(SearchContext* ctx) {
+    if ((++ctx->nodes & (BUDGET_CHECK_INTERVAL - 1)) != 0) return true;
+    if (ctx->nodes < ctx->node_cap && check_budgets()) return true;
+    ctx->aborted = true;
+    return false;
+}
+
+static void init_search_context(SearchContext* ctx) {
+    ctx->nodes = 0;
+    ctx->node_cap = LLONG_MAX;
+    ctx->solutions = 0;
+    ctx->aborted = false;
+    ctx->best_depth = -1;
 }
 
 static void print_cell_colors(const Futoshiki* puzzle, int row, int col) {
     if (!g_show_progress) return;
 
-    printf("[PROGRESS] Cell [%d][%d]: ", row, col);
-    for (int i = 0; i < puzzle->pc_lengths[row][col]; i++) {
-        printf("%d ", puzzle->pc_list[row][col][i]);
+    char colors[LOG_MESSAGE_CHARS] = "";
+    int length = 0;
+    for (int i = 0; i < puzzle->pc_lengths[row][col] && length < (int)sizeof(colors); i++) {
+        length += snprintf(colors + length, sizeof(colors) - length, "%d ",
+                           puzzle->pc_list[row][col][i]);
     }
-    printf("\n");
+    LOG_PROGRESS("Cell [%d][%d]: %s", row, col, colors);
 }
 
 bool safe(const Futoshiki* puzzle, int row, int col, int solution[MAX_N][MAX_N], int color) {
@@ -118,6 +294,32 @@ bool safe(const Futoshiki* puzzle, int row, int col, int solution[MAX_N][MAX_N],
     return true;
 }
 
+bool is_valid_solution(const Futoshiki* puzzle, int solution[MAX_N][MAX_N]) {
+    int n = puzzle->size;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            int v = solution[r][c];
+            if (v < 1 || v > n) return false;
+            if (puzzle->board[r][c] != EMPTY && puzzle->board[r][c] != v) return false;
+            for (int k = c + 1; k < n; k++) {
+                if (solution[r][k] == v) return false;
+            }
+            for (int k = r + 1; k < n; k++) {
+                if (solution[k][c] == v) return false;
+            }
+            if (c < n - 1) {
+                if (puzzle->h_cons[r][c] == GREATER && v <= solution[r][c + 1]) return false;
+                if (puzzle->h_cons[r][c] == SMALLER && v >= solution[r][c + 1]) return false;
+            }
+            if (r < n - 1) {
+                if (puzzle->v_cons[r][c] == GREATER && v <= solution[r + 1][c]) return false;
+                if (puzzle->v_cons[r][c] == SMALLER && v >= solution[r + 1][c]) return false;
+            }
+        }
+    }
+    return true;
+}
+
 bool has_valid_neighbor(const Futoshiki* puzzle, int row, int col, int color, bool need_greater) {
     for (int i = 0; i < puzzle->pc_lengths[row][col]; i++) {
         int neighbor_color = puzzle->pc_list[row][col][i];
@@ -251,7 +453,7 @@ void process_uniqueness(Futoshiki* puzzle, int row, int col) {
 }
 
 int compute_pc_lists(Futoshiki* puzzle, bool use_precoloring) {
-    print_progress("Starting pre-coloring");
+    LOG_PROGRESS("Starting pre-coloring");
     int total_colors_removed = 0;
     int initial_colors = 0;
 
@@ -304,26 +506,42 @@ int compute_pc_lists(Futoshiki* puzzle, bool use_precoloring) {
         } while (changes);
     }
 
-    print_progress("Pre-coloring complete");
+    LOG_PROGRESS("Pre-coloring complete");
     return total_colors_removed;
 }
 
 // Sequential backtracking algorithm for deeper levels
-bool color_g_seq(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col) {
+bool color_g_seq(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col,
+                 SearchContext* ctx) {
     // Check if we have completed the grid
     if (row >= puzzle->size) {
-        return true;
+        if (ctx->solutions++ == 0) {
+            ctx->best_depth = puzzle->size * puzzle->size;
+            memcpy(ctx->best_solution, solution, sizeof(ctx->best_solution));
+        }
+        return !g_count_all;  // In count mode keep backtracking
     }
 
     // Move to the next row when current row is complete
     if (col >= puzzle->size) {
-        return color_g_seq(puzzle, solution, row + 1, 0);
+        return color_g_seq(puzzle, solution, row + 1, 0, ctx);
     }
 
     // Skip given cells
     if (puzzle->board[row][col] != EMPTY) {
         solution[row][col] = puzzle->board[row][col];
-        return color_g_seq(puzzle, solution, row, col + 1);
+        return color_g_seq(puzzle, solution, row, col + 1, ctx);
+    }
+
+    if (!visit_node(ctx)) {
+        return false;
+    }
+
+    // All cells before (row, col) are consistently assigned: remember the deepest prefix
+    int depth = row * puzzle->size + col;
+    if (depth > ctx->best_depth) {
+        ctx->best_depth = depth;
+        memcpy(ctx->best_solution, solution, sizeof(ctx->best_solution));
     }
 
     // Try each possible color for current cell
@@ -331,110 +549,651 @@ bool color_g_seq(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col
         int color = puzzle->pc_list[row][col][i];
         if (safe(puzzle, row, col, solution, color)) {
             solution[row][col] = color;
-            if (color_g_seq(puzzle, solution, row, col + 1)) {
+            if (color_g_seq(puzzle, solution, row, col + 1, ctx)) {
                 return true;
             }
             solution[row][col] = EMPTY;  // Backtrack
+            if (ctx->aborted) {
+                return false;
+            }
         }
     }
 
     return false;
 }
 
-// Parallelization that creates tasks for first level choices
-bool color_g(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col) {
-    print_progress("Starting parallel backtracking");
+// Size-specialized copies of color_g_seq for the common board sizes
+#define KN 4
+#include "kernel_template.h"
+#define KN 5
+#include "kernel_template.h"
+#define KN 6
+#include "kernel_template.h"
+#define KN 7
+#include "kernel_template.h"
+#define KN 8
+#include "kernel_template.h"
+#define KN 9
+#include "kernel_template.h"
+#define KN 10
+#include "kernel_template.h"
+#define KN 11
+#include "kernel_template.h"
+#define KN 12
+#include "kernel_template.h"
+#define KN 13
+#include "kernel_template.h"
+#define KN 14
+#include "kernel_template.h"
+#define KN 15
+#include "kernel_template.h"
+#define KN 16
+#include "kernel_template.h"
+
+typedef bool (*SearchKernel)(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col,
+                             SearchContext* ctx);
+
+static const SearchKernel g_kernels[KERNEL_MAX_N + 1] = {
+    [4] = color_g_seq_4,   [5] = color_g_seq_5,   [6] = color_g_seq_6,   [7] = color_g_seq_7,
+    [8] = color_g_seq_8,   [9] = color_g_seq_9,   [10] = color_g_seq_10, [11] = color_g_seq_11,
+    [12] = color_g_seq_12, [13] = color_g_seq_13, [14] = color_g_seq_14, [15] = color_g_seq_15,
+    [16] = color_g_seq_16,
+};
+
+// Specialized kernel for the board size, or the generic color_g_seq
+static SearchKernel select_kernel(int size, SolverStats* stats) {
+    if (g_generic_kernel || size < KERNEL_MIN_N || size > KERNEL_MAX_N) {
+        stats->kernel_size = 0;
+        return color_g_seq;
+    }
+    stats->kernel_size = size;
+    return g_kernels[size];
+}
+
+typedef struct {
+    int row, col;
+} Cell;
+
+// Hash of everything that defines the puzzle, used to match checkpoints to their puzzle
+static unsigned long puzzle_fingerprint(const Futoshiki* puzzle) {
+    unsigned long hash = 1469598103934665603UL;  // FNV-1a
+    for (int row = 0; row < puzzle->size; row++) {
+        for (int col = 0; col < puzzle->size; col++) {
+            int cell = puzzle->board[row][col] * 9 +
+                       (col < puzzle->size - 1 ? puzzle->h_cons[row][col] * 3 : 0) +
+                       (row < puzzle->size - 1 ? puzzle->v_cons[row][col] : 0);
+            hash = (hash ^ (unsigned long)cell) * 1099511628211UL;
+        }
+    }
+    return (hash ^ (unsigned long)puzzle->size) * 1099511628211UL;
+}
 
-    bool found_solution = false;
+// Position where the search continues after the first `depth` empty cells are fixed
+static void prefix_resume_point(const Cell* cells, int depth, int* row, int* col) {
+    *row = depth > 0 ? cells[depth - 1].row : 0;
+    *col = depth > 0 ? cells[depth - 1].col + 1 : 0;
+}
 
-    // Find first empty cell to parallelize on
-    // TODO: consider the subsequent empty cells for parallelization
-    //       rn only 2 threads are doing the work if there's only 2 colors in the first empty cell
-    //       this could be improved greatly by just going on with other empty cells
-    int start_row = 0, start_col = 0;
-    bool found_empty = false;
+static void apply_prefix(int solution[MAX_N][MAX_N], const Cell* cells, const unsigned char* prefix,
+                         int depth) {
+    for (int k = 0; k < depth; k++) {
+        solution[cells[k].row][cells[k].col] = prefix[k];
+    }
+}
 
-    for (int r = 0; r < puzzle->size && !found_empty; r++) {
-        for (int c = 0; c < puzzle->size && !found_empty; c++) {
-            if (puzzle->board[r][c] == EMPTY) {
-                start_row = r;
-                start_col = c;
-                found_empty = true;
-            } else {
-                solution[r][c] = puzzle->board[r][c];
+// Expand the frontier breadth-first over the empty cells until it holds at least `target`
+// consistent prefixes, so that every thread gets several top-level subtrees
+static void build_frontier(const Futoshiki* puzzle, int base[MAX_N][MAX_N], const Cell* cells,
+                           int num_empty, int target, Frontier* frontier) {
+    frontier->depth = 0;
+    frontier->count = 1;
+    frontier->colors = malloc(1);
+
+    int scratch[MAX_N][MAX_N];
+    while (frontier->count > 0 && frontier->count < target && frontier->depth < num_empty) {
+        int depth = frontier->depth;
+        Cell cell = cells[depth];
+        int max_count = frontier->count * puzzle->pc_lengths[cell.row][cell.col];
+        unsigned char* next = malloc((size_t)max_count * (depth + 1) + 1);
+        int next_count = 0;
+
+        for (int i = 0; i < frontier->count; i++) {
+            const unsigned char* prefix = &frontier->colors[(size_t)i * depth];
+            memcpy(scratch, base, sizeof(scratch));
+            apply_prefix(scratch, cells, prefix, depth);
+
+            for (int j = 0; j < puzzle->pc_lengths[cell.row][cell.col]; j++) {
+                int color = puzzle->pc_list[cell.row][cell.col][j];
+                if (!safe(puzzle, cell.row, cell.col, scratch, color)) continue;
+
+                unsigned char* out = &next[(size_t)next_count++ * (depth + 1)];
+                memcpy(out, prefix, depth);
+                out[depth] = (unsigned char)color;
             }
         }
+
+        free(frontier->colors);
+        frontier->colors = next;
+        frontier->count = next_count;
+        frontier->depth = depth + 1;
     }
+}
 
-    if (!found_empty) {
-        // No empty cells, puzzle is already solved
-        return true;
+// Shared state of one parallel search, used for progress accounting and checkpoints
+typedef struct {
+    const Frontier* frontier;
+    unsigned char* done;  // Prefixes searched to completion
+    unsigned long fingerprint;
+    long long solutions;        // Solutions in completed prefixes (including resumed ones)
+    long long nodes;            // Nodes in all prefixes (including resumed ones)
+    long long completed_nodes;  // Nodes in completed prefixes (including resumed ones)
+    int explored;               // Prefixes searched to completion in this run
+} SearchProgress;
+
+static void write_checkpoint(SearchProgress* progress) {
+    CheckpointHeader header;
+    unsigned char* done = malloc((size_t)progress->frontier->count + 1);
+
+    // Snapshot under the same lock that completes prefixes so counts and flags agree
+#pragma omp critical(search_progress)
+    {
+        header.fingerprint = progress->fingerprint;
+        header.solutions = progress->solutions;
+        header.nodes = progress->completed_nodes;
+        memcpy(done, progress->done, progress->frontier->count);
+    }
+
+    trace_begin("checkpoint", header.solutions);
+    bool written = checkpoint_write(g_checkpoint.path, &header, progress->frontier, done);
+    trace_end("checkpoint", header.solutions);
+    if (written) {
+        LOG_PROGRESS("Checkpoint written to %s", g_checkpoint.path);
+    }
+    free(done);
+}
+
+// Called by workers between subtrees: at most one thread writes, nobody waits for it
+static void maybe_write_checkpoint(SearchProgress* progress) {
+    double next;
+#pragma omp atomic read
+    next = g_next_checkpoint;
+    if (!g_checkpoint.path || timer_now() < next) return;
+    if (!omp_test_lock(&g_checkpoint_lock)) return;
+
+    write_checkpoint(progress);
+    next = timer_now() + g_checkpoint.interval;
+#pragma omp atomic write
+    g_next_checkpoint = next;
+
+    omp_unset_lock(&g_checkpoint_lock);
+}
+
+// Progress of the running parallel search, for checkpoints from inside the search kernels
+static SearchProgress* g_running_progress = NULL;
+
+static void checkpoint_if_due(void) {
+    SearchProgress* progress;
+#pragma omp atomic read
+    progress = g_running_progress;
+    if (progress) maybe_write_checkpoint(progress);
+}
+
+// Read-only description of the subtrees and shared results of one parallel search
+typedef struct {
+    const Futoshiki* puzzle;
+    int (*base)[MAX_N];  // Givens only
+    const Cell* cells;   // Empty cells in search order
+    const Frontier* frontier;
+    SearchKernel kernel;       // color_g_seq or its specialization for the board size
+    int start_row, start_col;  // Where the kernel continues after a prefix
+    long long node_cap;        // Nodes a prefix may visit before it is given up
+    SearchProgress progress;
+
+    bool found_solution;
+    int first_solution[MAX_N][MAX_N];
+    int best_depth;  // Anytime result: deepest partial assignment over all prefixes
+    int best_partial[MAX_N][MAX_N];
+} ParallelSearch;
+
+// Scratch memory of one worker thread, allocated and first touched by the thread itself so it
+// lives on the thread's NUMA node
+typedef struct {
+    SearchContext ctx;
+    int solution[MAX_N][MAX_N];
+} WorkerScratch;
+
+// Prefixes assigned to one NUMA domain; padded so that the cursors of different domains do not
+// share a cache line
+typedef struct {
+    int next;  // Next prefix to hand out
+    int end;   // One past the last prefix of this domain
+    char padding[64 - 2 * sizeof(int)];
+} WorkQueue;
+
+typedef struct {
+    int planned_cpu;  // CPU the thread was pinned to (-1 without pinning)
+    int first_cpu;    // CPU observed when the thread started working
+    int last_cpu;     // CPU observed when the thread ran out of work
+    int domain;       // Work queue the thread takes prefixes from first
+    int prefixes;     // Prefixes searched (own domain and stolen)
+    int stolen;       // Prefixes taken from another domain's queue
+    long long nodes;
+} ThreadReport;
+
+// Take the next prefix, from the home domain first and from the other domains afterwards
+static int next_prefix(WorkQueue* queues, int num_queues, int home, bool* stolen) {
+    for (int k = 0; k < num_queues; k++) {
+        WorkQueue* queue = &queues[(home + k) % num_queues];
+        int i;
+#pragma omp atomic capture
+        i = queue->next++;
+        if (i < queue->end) {
+            *stolen = k > 0;
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void search_prefix(ParallelSearch* search, int i, WorkerScratch* scratch) {
+    const Frontier* frontier = search->frontier;
+    const unsigned char* prefix = &frontier->colors[(size_t)i * frontier->depth];
+    LOG_DEBUG("Thread %d searching prefix %d/%d", omp_get_thread_num(), i + 1, frontier->count);
+
+    // Start from the givens and fix the colors of this prefix
+    memcpy(scratch->solution, search->base, sizeof(scratch->solution));
+    apply_prefix(scratch->solution, search->cells, prefix, frontier->depth);
+
+    SearchContext* ctx = &scratch->ctx;
+    init_search_context(ctx);
+    ctx->node_cap = search->node_cap;
+
+    // Try to solve using sequential algorithm from this point
+    trace_begin("prefix", i);
+    bool solved = search->kernel((Futoshiki*)search->puzzle, scratch->solution, search->start_row,
+                                 search->start_col, ctx);
+    trace_end("prefix", ctx->nodes);
+    if (ctx->aborted) {
+        trace_instant("prefix cancelled", i);
+    }
+    if (ctx->solutions > 0) {
+#pragma omp critical
+        {
+            if (!search->found_solution) {
+                search->found_solution = true;
+                trace_instant("solution found", i);
+                // Save the first solution for the main thread to access
+                memcpy(search->first_solution, ctx->best_solution, sizeof(ctx->best_solution));
+                LOG_PROGRESS("Thread %d found solution in prefix %d", omp_get_thread_num(), i + 1);
+            }
+        }
+    }
+    if (solved) {
+        // Let the remaining workers return early
+        stop_search(SOLVER_SOLVED);
     }
 
-    print_progress("Parallelizing on first empty cell");
-    print_progress("First empty cell at (%d,%d) with %d possible colors", start_row, start_col,
-                   puzzle->pc_lengths[start_row][start_col]);
+    SearchProgress* progress = &search->progress;
+#pragma omp critical(search_progress)
+    {
+        progress->nodes += ctx->nodes;
+        if (!ctx->aborted) {
+            // An aborted prefix is searched again after a resume: its nodes stay out of the
+            // checkpoint so that they are not counted twice
+            progress->completed_nodes += ctx->nodes;
+            progress->solutions += ctx->solutions;
+            progress->explored++;
+            progress->done[i] = 1;
+        }
+    }
+#pragma omp critical(best_partial)
+    {
+        if (ctx->best_depth > search->best_depth) {
+            search->best_depth = ctx->best_depth;
+            memcpy(search->best_partial, ctx->best_solution, sizeof(ctx->best_solution));
+        }
+    }
+
+    maybe_write_checkpoint(progress);
+    log_flush_if_due();
+}
+
+// Split the frontier into one contiguous queue per NUMA domain used by the team. Without
+// pinning threads may migrate freely, so everything goes into a single queue.
+static int setup_work_queues(const Topology* topo, int num_threads, int count, WorkQueue* queues,
+                             int* thread_domain) {
+    int domain_nodes[MAX_NUMA_DOMAINS];
+    int num_queues = 0;
+
+    for (int t = 0; t < num_threads; t++) {
+        thread_domain[t] = 0;
+        if (!topo) continue;
+
+        int node = topology_thread_cpu(topo, t)->numa_node;
+        int d = 0;
+        while (d < num_queues && domain_nodes[d] != node) d++;
+        if (d == num_queues && num_queues < MAX_NUMA_DOMAINS) domain_nodes[num_queues++] = node;
+        thread_domain[t] = d < num_queues ? d : 0;
+    }
+    if (num_queues == 0) num_queues = 1;
+
+    for (int d = 0; d < num_queues; d++) {
+        queues[d].next = (int)((long long)count * d / num_queues);
+        queues[d].end = (int)((long long)count * (d + 1) / num_queues);
+    }
+    return num_queues;
+}
+
+static void print_thread_report(const ThreadReport* reports, int num_threads,
+                                const Topology* topo) {
+    printf("Thread placement:\n");
+    printf("  %-7s %-8s %-8s %-8s %-6s %-7s %-9s %-9s %s\n", "thread", "pinned", "cpu@start",
+           "cpu@end", "node", "domain", "prefixes", "stolen", "nodes");
+    for (int t = 0; t < num_threads; t++) {
+        const ThreadReport* r = &reports[t];
+        int node = topo ? topology_numa_node_of(topo, r->last_cpu) : -1;
+        printf("  %-7d %-8d %-9d %-8d %-6d %-7d %-9d %-9d %lld\n", t, r->planned_cpu,
+               r->first_cpu, r->last_cpu, node, r->domain, r->prefixes, r->stolen, r->nodes);
+    }
+}
+
+// Pick the strategy, team size and frontier size for a tree of `estimate` nodes
+static void choose_dispatch(double estimate, int max_threads, SolverStats* stats) {
+    SolverStrategy strategy = g_strategy;
+    if (strategy == STRATEGY_AUTO) {
+        if (max_threads == 1 || estimate < g_dispatch.sequential_max_nodes) {
+            strategy = STRATEGY_SEQUENTIAL;
+        } else if (estimate < g_dispatch.shallow_max_nodes) {
+            strategy = STRATEGY_SHALLOW;
+        } else {
+            strategy = STRATEGY_DEEP;
+        }
+    }
+
+    int threads = max_threads;
+    int tasks_per_thread = g_dispatch.deep_tasks_per_thread;
+    switch (strategy) {
+        case STRATEGY_SEQUENTIAL:
+            threads = 1;
+            tasks_per_thread = 1;
+            break;
+        case STRATEGY_SHALLOW: {
+            double wanted = estimate / g_dispatch.nodes_per_thread;
+            threads = wanted < 2 ? 2 : (wanted > max_threads ? max_threads : (int)wanted);
+            tasks_per_thread = g_dispatch.shallow_tasks_per_thread;
+            break;
+        }
+        case STRATEGY_DEEP:
+        case STRATEGY_AUTO:
+            break;
+    }
+
+    stats->strategy = strategy;
+    stats->estimated_nodes = estimate;
+    stats->threads_used = threads < max_threads ? threads : max_threads;
+    stats->tasks_per_thread = tasks_per_thread > 0 ? tasks_per_thread : 1;
+}
 
-    // Manually create private copies for each task to avoid issues
-    int num_colors = puzzle->pc_lengths[start_row][start_col];
-    int task_solutions[MAX_N][MAX_N][MAX_N];  // One solution matrix per possible color
+// Prefixes to split the search into. With checkpoints the frontier is as wide as a deep search
+// on all threads would use, whatever the dispatch chose, since a checkpoint can only record
+// whole prefixes: a single prefix would make a resumed run start over.
+static int frontier_target(const SolverStats* stats, int max_threads) {
+    int target = stats->tasks_per_thread * stats->threads_used;
+    int resumable = g_dispatch.deep_tasks_per_thread * max_threads;
+    if (g_checkpoint.path && target < resumable) target = resumable;
+    return target;
+}
 
-#pragma omp parallel
+// Run the workers over the current frontier: every thread repeatedly takes a prefix from its
+// NUMA domain's queue (or steals one from another domain) and searches the subtree below it
+static void run_workers(ParallelSearch* search, const Topology* topo, SolverStats* stats) {
+    int num_threads = stats->threads_used;
+    WorkQueue queues[MAX_NUMA_DOMAINS];
+    int* thread_domain = malloc(sizeof(int) * num_threads);
+    int num_queues =
+        setup_work_queues(topo, num_threads, search->frontier->count, queues, thread_domain);
+    ThreadReport* reports = calloc(num_threads, sizeof(ThreadReport));
+
+    perf_counts_reset(&stats->perf[PHASE_SEARCH]);
+
+#pragma omp parallel num_threads(num_threads) if (num_threads > 1)
     {
+        int t = omp_get_thread_num();
+        ThreadReport* report = &reports[t];
+        report->planned_cpu = -1;
+
 #pragma omp single
         {
-            print_progress("Using %d threads for parallel solving", omp_get_num_threads());
+            num_threads = omp_get_num_threads();
+            stats->threads_used = num_threads;
+            LOG_PROGRESS("Using %d threads and %d work queues for parallel solving", num_threads,
+                         num_queues);
+        }
 
-            for (int i = 0; i < num_colors && !found_solution; i++) {
-                int color = puzzle->pc_list[start_row][start_col][i];
+        // Pool threads outlive the search: keep their affinity to restore it afterwards
+        CpuAffinity* affinity = topo ? topology_save_affinity() : NULL;
+        if (topo) {
+            const CpuInfo* cpu = topology_thread_cpu(topo, t);
+            if (topology_pin_thread(cpu->cpu)) report->planned_cpu = cpu->cpu;
+        }
 
-                if (safe(puzzle, start_row, start_col, solution, color)) {
-#pragma omp task firstprivate(i, color) shared(found_solution, task_solutions)
-                    {
-                        print_progress("Thread %d trying color %d at (%d,%d)", omp_get_thread_num(),
-                                       color, start_row, start_col);
+        // First touch after pinning places the scratch pages on the local node
+        WorkerScratch* scratch = malloc(sizeof(WorkerScratch));
+        memset(scratch, 0, sizeof(WorkerScratch));
+
+        report->domain = thread_domain[t];
+        report->first_cpu = topology_current_cpu();
+
+        // Every thread counts its own share of the search phase
+        PerfCounters counters;
+        bool counting = g_perf_counters && perf_counters_open(&counters);
+        if (counting) perf_counters_start(&counters);
+
+        bool stolen;
+        int i;
+        trace_begin("worker", report->domain);
+        while (!search_stopped() &&
+               (i = next_prefix(queues, num_queues, report->domain, &stolen)) >= 0) {
+            if (stolen) trace_instant("steal", i);
+            search_prefix(search, i, scratch);
+            report->prefixes++;
+            report->stolen += stolen;
+            report->nodes += scratch->ctx.nodes;
+        }
+        trace_end("worker", report->prefixes);
+
+        if (counting) {
+            PerfCounts counts;
+            perf_counters_stop(&counters, &counts);
+            perf_counters_close(&counters);
+#pragma omp critical(perf_counts)
+            perf_counts_add(&stats->perf[PHASE_SEARCH], &counts);
+        } else if (g_perf_counters) {
+#pragma omp critical(perf_counts)
+            stats->perf[PHASE_SEARCH].valid[PERF_CYCLES] = false;
+        }
 
-                        // Create a local copy of the solution
-                        int local_solution[MAX_N][MAX_N];
-                        memcpy(local_solution, solution, sizeof(local_solution));
+        report->last_cpu = topology_current_cpu();
+        free(scratch);
+        topology_restore_affinity(affinity);
+    }
 
-                        // Set the color for this branch
-                        local_solution[start_row][start_col] = color;
+    // A thread without counters makes every search total incomplete
+    if (!stats->perf[PHASE_SEARCH].valid[PERF_CYCLES]) {
+        for (int e = 0; e < PERF_NUM_EVENTS; e++) stats->perf[PHASE_SEARCH].valid[e] = false;
+    }
 
-                        // Try to solve using sequential algorithm from this point
-                        if (color_g_seq(puzzle, local_solution, start_row, start_col + 1)) {
-#pragma omp critical
-                            {
-                                if (!found_solution) {
-                                    found_solution = true;
-                                    // Save to task solutions array for the main thread to access
-                                    memcpy(task_solutions[i], local_solution,
-                                           sizeof(local_solution));
-                                    print_progress("Thread %d found solution with color %d",
-                                                   omp_get_thread_num(), color);
-                                }
-                            }
-                        }
-                    }
-                }
+    if (topo) {
+        print_thread_report(reports, num_threads, topo);
+    }
+
+    free(thread_domain);
+    free(reports);
+}
+
+// Parallelization over the prefixes of the top-level frontier. Returns whether a solution was
+// found in this run and stores the first one in `solution`; if the search is stopped by a
+// budget, the deepest consistent partial assignment found by any thread is stored there
+// instead. The number of solutions (count mode) is reported in `stats`.
+bool color_g(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col,
+             SolverStats* stats) {
+    LOG_PROGRESS("Starting parallel backtracking");
+    trace_begin("color_g", 0);
+
+    // Place all givens up front so that safe() also checks against givens further down
+    Cell cells[MAX_N * MAX_N];
+    int num_empty = 0;
+    for (int r = 0; r < puzzle->size; r++) {
+        for (int c = 0; c < puzzle->size; c++) {
+            solution[r][c] = puzzle->board[r][c];
+            if (puzzle->board[r][c] == EMPTY) {
+                cells[num_empty].row = r;
+                cells[num_empty].col = c;
+                num_empty++;
             }
+        }
+    }
+
+    if (num_empty == 0) {
+        // No empty cells, puzzle is already solved
+        stats->best_depth = puzzle->size * puzzle->size;
+        stats->solutions = 1;
+        trace_end("color_g", 0);
+        return true;
+    }
+
+    ParallelSearch* search = calloc(1, sizeof(ParallelSearch));
+    search->puzzle = puzzle;
+    search->base = solution;
+    search->cells = cells;
+    search->kernel = select_kernel(puzzle->size, stats);
+    search->node_cap = LLONG_MAX;
+    search->progress.fingerprint = puzzle_fingerprint(puzzle);
+
+    // Small trees are solved on the calling thread, large ones on the whole team
+    int max_threads = omp_get_max_threads();
+    trace_begin("estimate", ESTIMATE_PROBES);
+    double estimate = estimate_search_nodes(puzzle, solution, ESTIMATE_PROBES, ESTIMATE_SEED);
+    choose_dispatch(estimate, max_threads, stats);
+    trace_end("estimate", (long long)estimate);
+    LOG_PROGRESS("Estimated %.3g nodes: %s with %d threads, %d prefixes per thread", estimate,
+                 solver_strategy_name(stats->strategy), stats->threads_used,
+                 stats->tasks_per_thread);
+
+    Frontier frontier = {0, 0, NULL};
+    if (g_checkpoint.resume_path) {
+        CheckpointHeader header;
+        bool ok = checkpoint_read(g_checkpoint.resume_path, &header, &frontier);
+        if (ok && (header.fingerprint != search->progress.fingerprint ||
+                   frontier.depth > num_empty)) {
+            printf("Error: Checkpoint %s belongs to a different puzzle\n",
+                   g_checkpoint.resume_path);
+            frontier_free(&frontier);
+            ok = false;
+        }
+        if (!ok) {
+            free(search);
+            stats->status = SOLVER_ERROR;
+            trace_end("color_g", 0);
+            return false;
+        }
+        search->progress.solutions = header.solutions;
+        search->progress.nodes = header.nodes;
+        search->progress.completed_nodes = header.nodes;
+        LOG_PROGRESS("Resuming from %s: %d pending prefixes of depth %d, %lld solutions",
+                     g_checkpoint.resume_path, frontier.count, frontier.depth, header.solutions);
+    } else if (g_strategy == STRATEGY_AUTO && stats->strategy == STRATEGY_SEQUENTIAL &&
+               max_threads > 1) {
+        // Knuth estimates have a heavy tail: cap the sequential run and escalate if the tree
+        // turns out much larger than predicted
+        search->node_cap = (long long)(g_dispatch.sequential_max_nodes * SEQUENTIAL_TRIAL_FACTOR);
+    }
 
-            print_progress("Waiting for tasks to complete");
-#pragma omp taskwait
-            print_progress("All tasks completed");
+    search->best_depth = cells[0].row * puzzle->size + cells[0].col;
+    memcpy(search->best_partial, solution, sizeof(search->best_partial));
+
+    // Optional placement on the discovered topology
+    Topology topology;
+    Topology* topo = NULL;
+    if (g_pin_threads) {
+        if (topology_discover(&topology)) {
+            topo = &topology;
+        } else {
+            LOG_PROGRESS("CPU topology unavailable, running without pinning");
         }
     }
 
-    // Copy solution from successful task to output solution matrix
-    if (found_solution) {
-        for (int i = 0; i < num_colors; i++) {
-            if (task_solutions[i][start_row][start_col] != 0) {
-                memcpy(solution, task_solutions[i], sizeof(task_solutions[i]));
-                break;
-            }
+    g_next_checkpoint = timer_now() + g_checkpoint.interval;
+
+    bool escalate;
+    do {
+        if (!g_checkpoint.resume_path) {
+            trace_begin("build frontier", num_empty);
+            build_frontier(puzzle, solution, cells, num_empty,
+                           frontier_target(stats, max_threads), &frontier);
+            trace_end("build frontier", frontier.count);
+            LOG_PROGRESS("Frontier of %d prefixes over the first %d empty cells", frontier.count,
+                         frontier.depth);
         }
+
+        search->frontier = &frontier;
+        search->progress.frontier = &frontier;
+        search->progress.done = calloc((size_t)frontier.count + 1, 1);
+        prefix_resume_point(cells, frontier.depth, &search->start_row, &search->start_col);
+
+#pragma omp atomic write
+        g_running_progress = &search->progress;
+        run_workers(search, topo, stats);
+#pragma omp atomic write
+        g_running_progress = NULL;
+
+        // The capped sequential trial ran out of nodes without finishing: go wide
+        escalate = search->node_cap != LLONG_MAX && !search_stopped() &&
+                   search->progress.explored < frontier.count;
+        if (escalate) {
+            LOG_PROGRESS("Sequential trial exceeded %lld nodes, escalating", search->node_cap);
+            trace_instant("escalate", search->node_cap);
+            search->node_cap = LLONG_MAX;
+            search->progress.explored = 0;
+            search->progress.solutions = 0;
+            search->progress.completed_nodes = 0;  // The trial's prefixes are searched again
+            stats->strategy = STRATEGY_DEEP;
+            stats->escalated = true;
+            stats->threads_used = max_threads;
+            stats->tasks_per_thread = g_dispatch.deep_tasks_per_thread;
+            free(search->progress.done);
+            frontier_free(&frontier);
+        }
+    } while (escalate);
+
+    if (topo) {
+        topology_free(topo);
+    }
+
+    // Final checkpoint: what is left after a budget stop, or an empty frontier when done
+    if (g_checkpoint.path) {
+        write_checkpoint(&search->progress);
+    }
+
+    stats->nodes = search->progress.nodes;
+    stats->solutions = search->progress.solutions;
+    stats->frontier_total = frontier.count;
+    stats->frontier_explored = search->progress.explored;
+    stats->best_depth = search->best_depth;
+
+    // Copy solution from successful worker to output solution matrix
+    bool found_solution = search->found_solution;
+    if (found_solution) {
+        memcpy(solution, search->first_solution, sizeof(search->first_solution));
+    } else if (search_stopped()) {
+        memcpy(solution, search->best_partial, sizeof(search->best_partial));
     }
 
+    free(search->progress.done);
+    frontier_free(&frontier);
+    free(search);
+
+    trace_end("color_g", found_solution);
     return found_solution;
 }
 
@@ -479,26 +1238,17 @@ void print_board(const Futoshiki* puzzle, int solution[MAX_N][MAX_N]) {
 }
 
 bool parse_futoshiki(const char* input, Futoshiki* puzzle) {
-    print_progress("Parsing puzzle input");
+    LOG_PROGRESS("Parsing puzzle input");
 
     // Initialize everything to 0/NO_CONS
     memset(puzzle->board, 0, sizeof(puzzle->board));
     memset(puzzle->h_cons, NO_CONS, sizeof(puzzle->h_cons));
     memset(puzzle->v_cons, NO_CONS, sizeof(puzzle->v_cons));
 
-    // First, determine size by counting numbers in first row
-    char first_line[256];
-    int line_len = 0;
-    while (input[line_len] && input[line_len] != '\n') {
-        first_line[line_len] = input[line_len];
-        line_len++;
-    }
-    first_line[line_len] = '\0';
-
-    // Count numbers in first line to determine size
+    // First, determine size by counting numbers in first row (values may have several digits)
     puzzle->size = 0;
-    for (int i = 0; i < line_len; i++) {
-        if (isdigit(first_line[i]) || first_line[i] == '0') {
+    for (int i = 0; input[i] && input[i] != '\n'; i++) {
+        if (isdigit(input[i]) && (i == 0 || !isdigit(input[i - 1]))) {
             puzzle->size++;
         }
     }
@@ -507,41 +1257,49 @@ bool parse_futoshiki(const char* input, Futoshiki* puzzle) {
         return false;
     }
 
-    char line[256];
-    const char* line_start = input;
+    // Character offset of each number in the last number line, to place vertical constraints
+    int col_positions[MAX_N] = {0};
+    const char* line = input;
     int number_row = 0;
 
-    while (*line_start) {
-        // Copy line to buffer
-        line_len = 0;
-        while (line_start[line_len] && line_start[line_len] != '\n') {
-            line[line_len] = line_start[line_len];
+    while (*line) {
+        int line_len = 0;
+        while (line[line_len] && line[line_len] != '\n') {
             line_len++;
         }
-        line[line_len] = '\0';
-
-        // Skip empty lines
-        if (line_len == 0 || line[0] == '\n') {
-            line_start += (line_start[0] == '\n' ? 1 : 0);
-            continue;
-        }
 
         // Check if this is a constraint line
         bool is_v_constraint_line = false;
+        bool is_empty_line = true;
         for (int i = 0; i < line_len; i++) {
             if (line[i] == '^' || line[i] == 'v' || line[i] == 'V') {
                 is_v_constraint_line = true;
-                break;
+            }
+            if (!isspace(line[i])) {
+                is_empty_line = false;
             }
         }
 
-        if (!is_v_constraint_line) {  // Number and horizontal constraint line
+        if (is_empty_line) {
+            // Skip empty lines
+        } else if (!is_v_constraint_line) {  // Number and horizontal constraint line
+            if (number_row >= puzzle->size) {
+                return false;
+            }
             int col = 0;
             for (int i = 0; i < line_len && col < puzzle->size; i++) {
-                if (line[i] == ' ') continue;
-
                 if (isdigit(line[i])) {
-                    puzzle->board[number_row][col] = line[i] - '0';
+                    int value = 0;
+                    col_positions[col] = i;
+                    while (i < line_len && isdigit(line[i])) {
+                        value = value * 10 + (line[i] - '0');
+                        i++;
+                    }
+                    i--;
+                    if (value > puzzle->size) {
+                        return false;
+                    }
+                    puzzle->board[number_row][col] = value;
                     col++;
                 } else if (line[i] == '<' && col > 0) {
                     puzzle->h_cons[number_row][col - 1] = SMALLER;
@@ -550,16 +1308,7 @@ bool parse_futoshiki(const char* input, Futoshiki* puzzle) {
                 }
             }
             number_row++;
-        } else {  // Vertical constraint line
-            // Create a mapping array for character positions to grid columns
-            int col_positions[MAX_N] = {0};  // Position where each column's number would be
-            int pos = 0;
-            for (int col = 0; col < puzzle->size; col++) {
-                col_positions[col] = pos;
-                pos += (col == puzzle->size - 1) ? 0 : 4;  // 4 spaces between numbers
-            }
-
-            // Now scan the constraint line
+        } else if (number_row > 0) {  // Vertical constraint line
             for (int i = 0; i < line_len; i++) {
                 if (line[i] != '^' && line[i] != 'v' && line[i] != 'V') continue;
 
@@ -570,24 +1319,21 @@ bool parse_futoshiki(const char* input, Futoshiki* puzzle) {
                         col = j;
                     }
                 }
-
-                if (col < puzzle->size) {
-                    puzzle->v_cons[number_row - 1][col] = (line[i] == '^') ? SMALLER : GREATER;
-                }
+                puzzle->v_cons[number_row - 1][col] = (line[i] == '^') ? SMALLER : GREATER;
             }
         }
 
-        line_start += line_len + (line_start[line_len] == '\n' ? 1 : 0);
+        line += line_len + (line[line_len] == '\n' ? 1 : 0);
     }
 
-    print_progress("Parsing complete");
-    print_progress("Puzzle size: %d x %d", puzzle->size, puzzle->size);
+    LOG_PROGRESS("Parsing complete");
+    LOG_PROGRESS("Puzzle size: %d x %d", puzzle->size, puzzle->size);
     return true;
 }
 
 // File reading function
 bool read_puzzle_from_file(const char* filename, Futoshiki* puzzle) {
-    print_progress("Reading puzzle file");
+    LOG_PROGRESS("Reading puzzle file");
 
     FILE* file = fopen(filename, "r");
     if (!file) {
@@ -595,36 +1341,108 @@ bool read_puzzle_from_file(const char* filename, Futoshiki* puzzle) {
         return false;
     }
 
-    char buffer[1024] = {0};
-    char content[1024] = {0};
-    int total_read = 0;
-
-    while (fgets(buffer, sizeof(buffer), file)) {
-        strcat(content, buffer);
-        total_read += strlen(buffer);
-        if (total_read >= sizeof(content) - 1) {
-            printf("Error: Puzzle file too large\n");
-            fclose(file);
-            return false;
+    // Boards up to MAX_N with multi-digit values do not fit a fixed buffer: grow as needed
+    size_t capacity = 4096, length = 0;
+    char* content = malloc(capacity);
+    size_t n;
+    while (content && (n = fread(content + length, 1, capacity - length - 1, file)) > 0) {
+        length += n;
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            char* grown = realloc(content, capacity);
+            if (!grown) free(content);
+            content = grown;
         }
     }
-
     fclose(file);
-    return parse_futoshiki(content, puzzle);
+
+    if (!content) {
+        printf("Error: Puzzle file too large\n");
+        return false;
+    }
+    content[length] = '\0';
+
+    bool ok = parse_futoshiki(content, puzzle);
+    free(content);
+    return ok;
+}
+
+bool givens_conflict(const Futoshiki* puzzle) {
+    int n = puzzle->size;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            int v = puzzle->board[r][c];
+            if (v == EMPTY) continue;
+            for (int k = c + 1; k < n; k++) {
+                if (puzzle->board[r][k] == v) return true;
+            }
+            for (int k = r + 1; k < n; k++) {
+                if (puzzle->board[k][c] == v) return true;
+            }
+            int right = c < n - 1 ? puzzle->board[r][c + 1] : EMPTY;
+            int below = r < n - 1 ? puzzle->board[r + 1][c] : EMPTY;
+            if (right != EMPTY && ((puzzle->h_cons[r][c] == GREATER && v <= right) ||
+                                   (puzzle->h_cons[r][c] == SMALLER && v >= right))) {
+                return true;
+            }
+            if (below != EMPTY && ((puzzle->v_cons[r][c] == GREATER && v <= below) ||
+                                   (puzzle->v_cons[r][c] == SMALLER && v >= below))) {
+                return true;
+            }
+        }
+    }
+    return false;
 }
 
-double get_time() {
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec * 1e-6;
+bool search_puzzle(Futoshiki* puzzle, int solution[MAX_N][MAX_N], SolverStats* stats) {
+    if (givens_conflict(puzzle)) {
+        stats->status = SOLVER_UNSATISFIABLE;
+        return false;
+    }
+
+    reset_search_state();
+    omp_init_lock(&g_checkpoint_lock);
+    double start_coloring = timer_now();
+
+    stats->status = SOLVER_UNSATISFIABLE;
+    bool have_solution = color_g(puzzle, solution, 0, 0, stats);
+    stats->found_solution = stats->solutions > 0;
+    if (stats->status == SOLVER_ERROR) {
+        // Checkpoint could not be resumed
+    } else if (search_stopped() && g_stop_status != SOLVER_SOLVED) {
+        stats->status = g_stop_status;
+    } else if (stats->found_solution) {
+        stats->status = SOLVER_SOLVED;
+    }
+
+    stats->coloring_time = timer_now() - start_coloring;
+    omp_destroy_lock(&g_checkpoint_lock);
+    log_flush();
+    return have_solution;
 }
 
 SolverStats solve_puzzle(const char* filename, bool use_precoloring, bool print_solution) {
+    return solve_puzzle_into(filename, use_precoloring, print_solution, NULL);
+}
+
+SolverStats solve_puzzle_into(const char* filename, bool use_precoloring, bool print_solution,
+                              int result[MAX_N][MAX_N]) {
     SolverStats stats = {0};
+    stats.status = SOLVER_ERROR;
     Futoshiki puzzle;
 
-    if (read_puzzle_from_file(filename, &puzzle)) {
+    // Counters of the main thread for the sequential phases
+    PerfCounters counters;
+    stats.perf_enabled = g_perf_counters;
+    stats.perf_available = g_perf_counters && perf_counters_open(&counters);
+    if (stats.perf_available) perf_counters_start(&counters);
+
+    bool parsed = read_puzzle_from_file(filename, &puzzle);
+    if (stats.perf_available) perf_counters_stop(&counters, &stats.perf[PHASE_PARSE]);
+
+    if (parsed) {
         if (print_solution) {
+            log_flush();  // Parsing messages first
             printf("Initial puzzle:\n");
             int initial_board[MAX_N][MAX_N];
             memcpy(initial_board, puzzle.board, sizeof(initial_board));
@@ -632,13 +1450,15 @@ SolverStats solve_puzzle(const char* filename, bool use_precoloring, bool print_
         }
 
         // Time the pre-coloring phase
-        double start_precolor = get_time();
+        double start_precolor = timer_now();
+        if (stats.perf_available) perf_counters_start(&counters);
         stats.colors_removed = compute_pc_lists(&puzzle, use_precoloring);
-        double end_precolor = get_time();
+        if (stats.perf_available) perf_counters_stop(&counters, &stats.perf[PHASE_PRECOLOR]);
+        double end_precolor = timer_now();
         stats.precolor_time = end_precolor - start_precolor;
 
         if (print_solution && g_show_progress) {
-            print_progress("Possible colors for each cell:");
+            LOG_PROGRESS("Possible colors for each cell:");
             for (int row = 0; row < puzzle.size; row++) {
                 for (int col = 0; col < puzzle.size; col++) {
                     print_cell_colors(&puzzle, row, col);
@@ -648,12 +1468,7 @@ SolverStats solve_puzzle(const char* filename, bool use_precoloring, bool print_
 
         // Time the list-coloring phase
         int solution[MAX_N][MAX_N] = {{0}};
-        double start_coloring = get_time();
-
-        stats.found_solution = color_g(&puzzle, solution, 0, 0);
-
-        double end_coloring = get_time();
-        stats.coloring_time = end_coloring - start_coloring;
+        bool have_solution = search_puzzle(&puzzle, solution, &stats);
         stats.total_time = stats.precolor_time + stats.coloring_time;
 
         // Calculate remaining colors and total processed
@@ -666,14 +1481,27 @@ SolverStats solve_puzzle(const char* filename, bool use_precoloring, bool print_
         stats.total_processed = puzzle.size * puzzle.size * puzzle.size;
 
         if (print_solution) {
-            if (stats.found_solution) {
+            if (have_solution) {
                 printf("Solution:\n");
                 print_board(&puzzle, solution);
+            } else if (stats.found_solution) {
+                printf("Solutions were found before the checkpoint that was resumed.\n");
+            } else if (stats.status == SOLVER_ERROR) {
+                printf("Search could not be started.\n");
+            } else if (stats.status != SOLVER_UNSATISFIABLE) {
+                printf("Search stopped (%s). Deepest partial assignment (%d/%d cells):\n",
+                       solver_status_name(stats.status), stats.best_depth,
+                       puzzle.size * puzzle.size);
+                print_board(&puzzle, solution);
             } else {
                 printf("No solution found.\n");
             }
         }
+        if (result) {
+            memcpy(result, solution, sizeof(solution));
+        }
     }
 
+    if (stats.perf_available) perf_counters_close(&counters);
     return stats;
 }
@@ -5,8 +5,111 @@
 
 #include "comparison.h"  // For SolverStats
 
+#define MAX_N 50
+#define EMPTY 0
+
+typedef enum { NO_CONS = 0, GREATER = 1, SMALLER = 2 } Constraint;
+
+typedef struct {
+    int size;                             // Size of the puzzle (N)
+    int board[MAX_N][MAX_N];              // The puzzle grid (0 means empty cell)
+    Constraint h_cons[MAX_N][MAX_N - 1];  // Horizontal inequality constraints
+    Constraint v_cons[MAX_N - 1][MAX_N];  // Vertical inequality constraints
+    int pc_list[MAX_N][MAX_N][MAX_N];     // Possible colors for each cell
+                                          // [row][col][possible_values]
+    int pc_lengths[MAX_N][MAX_N];         // Possible colors list length for each cell
+} Futoshiki;
+
+// Search budgets; a value of 0 disables the corresponding limit
+typedef struct {
+    double time_limit;     // Wall-clock seconds per search
+    long long node_limit;  // Search nodes over all threads
+    long memory_limit_mb;  // Resident set size of the process in MB
+} SolverLimits;
+
+// Periodic checkpoints of the parallel search and resuming from them
+typedef struct {
+    const char* path;         // Checkpoint file (NULL = resume_path, or no checkpoints)
+    double interval;          // Seconds between two checkpoints
+    const char* resume_path;  // Checkpoint to continue from (NULL = fresh search)
+} CheckpointConfig;
+
+// Thresholds of the automatic sequential/shallow/deep dispatch
+typedef struct {
+    double sequential_max_nodes;   // Estimated nodes below which the search stays sequential
+    double shallow_max_nodes;      // Estimated nodes below which a shallow frontier is used
+    double nodes_per_thread;       // Estimated nodes that justify one more thread (shallow)
+    int shallow_tasks_per_thread;  // Frontier prefixes per thread in shallow mode
+    int deep_tasks_per_thread;     // Frontier prefixes per thread in deep mode
+} DispatchConfig;
+
+// Whether `color` can be placed at (row, col) given the colors already in `solution`
+bool safe(const Futoshiki* puzzle, int row, int col, int solution[MAX_N][MAX_N], int color);
+
+// Whether `solution` is a complete Latin square that keeps all givens and inequalities
+bool is_valid_solution(const Futoshiki* puzzle, int solution[MAX_N][MAX_N]);
+
+// Givens that already violate a row, column or inequality (the search never checks givens
+// against each other)
+bool givens_conflict(const Futoshiki* puzzle);
+
+// Fill pc_list/pc_lengths (all colors, or pre-colored when use_precoloring); returns the number
+// of colors removed
+int compute_pc_lists(Futoshiki* puzzle, bool use_precoloring);
+
 SolverStats solve_puzzle(const char* filename, bool use_precoloring, bool print_solution);
 
+// As solve_puzzle, and copy the solution (or the deepest partial assignment) to `result`
+SolverStats solve_puzzle_into(const char* filename, bool use_precoloring, bool print_solution,
+                              int result[MAX_N][MAX_N]);
+
+// Search a puzzle whose possible colors are already computed; fills the search fields, status
+// and coloring time of `stats`. Returns whether `solution` holds a solution.
+bool search_puzzle(Futoshiki* puzzle, int solution[MAX_N][MAX_N], SolverStats* stats);
+
+// Print `solution` with the inequalities of `puzzle` between the cells
+void print_board(const Futoshiki* puzzle, int solution[MAX_N][MAX_N]);
+
+bool parse_futoshiki(const char* input, Futoshiki* puzzle);
+
+bool read_puzzle_from_file(const char* filename, Futoshiki* puzzle);
+
 void set_progress_display(bool show);
 
+void set_solver_limits(const SolverLimits* limits);
+
+void get_solver_limits(SolverLimits* limits);
+
+// Count all solutions instead of stopping at the first one
+void set_count_mode(bool count_all);
+
+bool get_count_mode(void);
+
+void set_checkpoint_config(const CheckpointConfig* config);
+
+void get_checkpoint_config(CheckpointConfig* config);
+
+// Pin worker threads to the CPUs discovered in sysfs, keep their scratch memory on the local
+// NUMA node and let them take work from their own NUMA domain first
+void set_thread_pinning(bool pin);
+
+// Collect hardware performance counters per phase (Linux perf_event_open); runs without them
+// when the kernel does not allow access
+void set_perf_counters(bool enable);
+
+// Search with the generic color_g_seq even when a size-specialized kernel exists (4x4 to 16x16)
+void set_generic_kernel(bool generic);
+
+// Force a strategy (STRATEGY_AUTO estimates the tree size and decides per puzzle)
+void set_solver_strategy(SolverStrategy strategy);
+
+SolverStrategy get_solver_strategy(void);
+
+void set_dispatch_config(const DispatchConfig* config);
+
+void get_dispatch_config(DispatchConfig* config);
+
+// Derive the dispatch thresholds from OpenMP overheads measured by check_cores
+bool load_dispatch_profile(const char* path);
+
 #endif  // FUTOSHIKI_H
@@ -0,0 +1,414 @@
+#include "incremental.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+
+#define CAUSE_NONE -1   // Color possible, or not removed by propagation
+#define CAUSE_GIVEN -2  // Removed because the cell is a given
+
+// Cells waiting to be revised; every cell is queued at most once
+typedef struct {
+    int cells[MAX_N * MAX_N];
+    bool queued[MAX_N][MAX_N];
+    int head, count;
+} Worklist;
+
+static const int DROW[4] = {0, 0, -1, 1};
+static const int DCOL[4] = {-1, 1, 0, 0};
+
+static void worklist_init(Worklist* list) {
+    memset(list->queued, 0, sizeof(list->queued));
+    list->head = 0;
+    list->count = 0;
+}
+
+static void worklist_push(Worklist* list, int size, int row, int col) {
+    if (list->queued[row][col]) return;
+    list->queued[row][col] = true;
+    list->cells[(list->head + list->count++) % (MAX_N * MAX_N)] = row * size + col;
+}
+
+static int worklist_pop(Worklist* list) {
+    int cell = list->cells[list->head];
+    list->head = (list->head + 1) % (MAX_N * MAX_N);
+    list->count--;
+    return cell;
+}
+
+static bool is_singleton(unsigned long long domain) {
+    return domain != 0 && (domain & (domain - 1)) == 0;
+}
+
+// Relation of (row, col) to its neighbor in direction k: GREATER if the cell must hold the
+// larger color, SMALLER if the smaller one, NO_CONS without inequality (or off the board)
+static Constraint relation(const Futoshiki* puzzle, int row, int col, int k) {
+    int n = puzzle->size;
+    switch (k) {
+        case 0:  // Left: h_cons[row][col - 1] relates left to current
+            if (col == 0) return NO_CONS;
+            return puzzle->h_cons[row][col - 1] == GREATER   ? SMALLER
+                   : puzzle->h_cons[row][col - 1] == SMALLER ? GREATER
+                                                             : NO_CONS;
+        case 1:  // Right
+            return col < n - 1 ? puzzle->h_cons[row][col] : NO_CONS;
+        case 2:  // Up: v_cons[row - 1][col] relates upper to current
+            if (row == 0) return NO_CONS;
+            return puzzle->v_cons[row - 1][col] == GREATER   ? SMALLER
+                   : puzzle->v_cons[row - 1][col] == SMALLER ? GREATER
+                                                             : NO_CONS;
+        default:  // Down
+            return row < n - 1 ? puzzle->v_cons[row][col] : NO_CONS;
+    }
+}
+
+static void remove_color(EditSession* session, int row, int col, int color, int cause) {
+    session->domain[row][col] &= ~(1ULL << color);
+    session->cause[row][col][color] = (short)cause;
+    session->dirty[row][col] = true;
+}
+
+// Apply the pre-coloring rules of compute_pc_lists to one cell: a color must have a supporting
+// color in every neighbor it is related to by an inequality, and it cannot be the only color
+// left in a cell of the same row or column. Returns whether colors were removed.
+static bool revise(EditSession* session, int row, int col) {
+    const Futoshiki* puzzle = &session->puzzle;
+    int n = puzzle->size;
+    if (puzzle->board[row][col] != EMPTY) return false;  // Givens keep their color
+    session->cells_revised++;
+    unsigned long long before = session->domain[row][col];
+
+    for (int i = 0; i < n; i++) {
+        unsigned long long peer;
+        if (i != col && is_singleton(peer = session->domain[row][i]) &&
+            (session->domain[row][col] & peer)) {
+            remove_color(session, row, col, __builtin_ctzll(peer), row * n + i);
+        }
+        if (i != row && is_singleton(peer = session->domain[i][col]) &&
+            (session->domain[row][col] & peer)) {
+            remove_color(session, row, col, __builtin_ctzll(peer), i * n + col);
+        }
+    }
+
+    for (int k = 0; k < 4; k++) {
+        Constraint cons = relation(puzzle, row, col, k);
+        if (cons == NO_CONS) continue;
+        int nr = row + DROW[k], nc = col + DCOL[k];
+        unsigned long long neighbor = session->domain[nr][nc];
+        for (int color = 1; color <= n; color++) {
+            if (!(session->domain[row][col] & (1ULL << color))) continue;
+            unsigned long long below = (1ULL << color) - 2;  // Colors 1..color-1
+            unsigned long long above = ~((2ULL << color) - 1);
+            if (!(neighbor & (cons == GREATER ? below : above))) {
+                remove_color(session, row, col, color, nr * n + nc);
+            }
+        }
+    }
+
+    return session->domain[row][col] != before;
+}
+
+// Queue the cells whose colors depend on (row, col): inequality neighbors always, row and
+// column peers when the cell is down to one color
+static void push_dependents(EditSession* session, Worklist* list, int row, int col) {
+    const Futoshiki* puzzle = &session->puzzle;
+    int n = puzzle->size;
+    for (int k = 0; k < 4; k++) {
+        if (relation(puzzle, row, col, k) != NO_CONS) {
+            worklist_push(list, n, row + DROW[k], col + DCOL[k]);
+        }
+    }
+    if (session->domain[row][col] & (session->domain[row][col] - 1)) return;
+    for (int i = 0; i < n; i++) {
+        if (i != col) worklist_push(list, n, row, i);
+        if (i != row) worklist_push(list, n, i, col);
+    }
+}
+
+static void propagate(EditSession* session, Worklist* list) {
+    int n = session->puzzle.size;
+    while (list->count > 0) {
+        int cell = worklist_pop(list);
+        int row = cell / n, col = cell % n;
+        list->queued[row][col] = false;
+        if (revise(session, row, col)) {
+            push_dependents(session, list, row, col);
+        }
+    }
+}
+
+// Undo the consequences of a relaxation at the `num_seeds` seed cells: restore every color that
+// was removed because of a cell whose colors grew, transitively, and queue the grown cells
+static void relax(EditSession* session, Worklist* list, const int* seeds, int num_seeds) {
+    int n = session->puzzle.size;
+    Worklist grown;
+    worklist_init(&grown);
+    for (int i = 0; i < num_seeds; i++) {
+        worklist_push(&grown, n, seeds[i] / n, seeds[i] % n);
+    }
+
+    while (grown.count > 0) {
+        int cell = worklist_pop(&grown);
+        int row = cell / n, col = cell % n;
+        worklist_push(list, n, row, col);
+
+        // Causes are always row/column peers or adjacent cells
+        for (int i = 0; i < 2 * n + 4; i++) {
+            int r, c;
+            if (i < n) {
+                r = row, c = i;
+            } else if (i < 2 * n) {
+                r = i - n, c = col;
+            } else {
+                r = row + DROW[i - 2 * n], c = col + DCOL[i - 2 * n];
+                if (r < 0 || r >= n || c < 0 || c >= n) continue;
+            }
+            for (int color = 1; color <= n; color++) {
+                if (session->cause[r][c][color] != cell) continue;
+                if (session->puzzle.board[r][c] != EMPTY) {
+                    // Removed before the cell became a given: the given now excludes it
+                    session->cause[r][c][color] = CAUSE_GIVEN;
+                    continue;
+                }
+                session->domain[r][c] |= 1ULL << color;
+                session->cause[r][c][color] = CAUSE_NONE;
+                session->dirty[r][c] = true;
+                worklist_push(&grown, n, r, c);
+            }
+        }
+    }
+}
+
+bool edit_session_open(EditSession* session, const char* filename) {
+    double start = timer_now();
+    Futoshiki* puzzle = &session->puzzle;
+    if (!read_puzzle_from_file(filename, puzzle)) return false;
+
+    int n = puzzle->size;
+    unsigned long long all = ((1ULL << n) - 1) << 1;
+    Worklist list;
+    worklist_init(&list);
+    for (int row = 0; row < n; row++) {
+        for (int col = 0; col < n; col++) {
+            int given = puzzle->board[row][col];
+            session->domain[row][col] = given != EMPTY ? 1ULL << given : all;
+            for (int color = 0; color <= n; color++) {
+                bool removed = given != EMPTY && color != given && color > 0;
+                session->cause[row][col][color] = removed ? CAUSE_GIVEN : CAUSE_NONE;
+            }
+            session->dirty[row][col] = true;
+            worklist_push(&list, n, row, col);
+        }
+    }
+
+    session->cells_revised = 0;
+    propagate(session, &list);
+    session->have_solution = false;
+    session->propagation_time = timer_now() - start;
+    return true;
+}
+
+bool edit_set_given(EditSession* session, int row, int col, int color) {
+    Futoshiki* puzzle = &session->puzzle;
+    int n = puzzle->size;
+    if (row < 0 || row >= n || col < 0 || col >= n || color < 0 || color > n) return false;
+    if (puzzle->board[row][col] == color) return true;
+
+    double start = timer_now();
+    Worklist list;
+    worklist_init(&list);
+
+    if (puzzle->board[row][col] != EMPTY) {
+        // The cell gets all its colors back, and so does everything that depended on it
+        puzzle->board[row][col] = EMPTY;
+        for (int c = 1; c <= n; c++) {
+            if (session->cause[row][col][c] == CAUSE_GIVEN) {
+                session->domain[row][col] |= 1ULL << c;
+                session->cause[row][col][c] = CAUSE_NONE;
+            }
+        }
+        session->dirty[row][col] = true;
+        int seed = row * n + col;
+        relax(session, &list, &seed, 1);
+    }
+
+    if (color != EMPTY) {
+        puzzle->board[row][col] = color;
+        for (int c = 1; c <= n; c++) {
+            if (c != color && (session->domain[row][col] & (1ULL << c))) {
+                remove_color(session, row, col, c, CAUSE_GIVEN);
+            }
+        }
+        session->domain[row][col] = 1ULL << color;
+        session->cause[row][col][color] = CAUSE_NONE;
+        push_dependents(session, &list, row, col);
+    }
+
+    propagate(session, &list);
+    session->propagation_time += timer_now() - start;
+    return true;
+}
+
+// Shared by both inequality directions: `cons` is the slot in h_cons or v_cons of the pair
+static void set_constraint(EditSession* session, Constraint* slot, int row, int col, int row2,
+                           int col2, Constraint cons) {
+    int n = session->puzzle.size;
+    double start = timer_now();
+    Worklist list;
+    worklist_init(&list);
+
+    if (*slot != NO_CONS) {
+        *slot = NO_CONS;
+        int seeds[2] = {row * n + col, row2 * n + col2};
+        relax(session, &list, seeds, 2);
+    }
+    if (cons != NO_CONS) {
+        *slot = cons;
+        worklist_push(&list, n, row, col);
+        worklist_push(&list, n, row2, col2);
+    }
+
+    propagate(session, &list);
+    session->propagation_time += timer_now() - start;
+}
+
+bool edit_set_h_constraint(EditSession* session, int row, int col, Constraint cons) {
+    int n = session->puzzle.size;
+    if (row < 0 || row >= n || col < 0 || col >= n - 1) return false;
+    if (session->puzzle.h_cons[row][col] != cons) {
+        set_constraint(session, &session->puzzle.h_cons[row][col], row, col, row, col + 1, cons);
+    }
+    return true;
+}
+
+bool edit_set_v_constraint(EditSession* session, int row, int col, Constraint cons) {
+    int n = session->puzzle.size;
+    if (row < 0 || row >= n - 1 || col < 0 || col >= n) return false;
+    if (session->puzzle.v_cons[row][col] != cons) {
+        set_constraint(session, &session->puzzle.v_cons[row][col], row, col, row + 1, col, cons);
+    }
+    return true;
+}
+
+SolverStats edit_session_solve(EditSession* session) {
+    Futoshiki* puzzle = &session->puzzle;
+    int n = puzzle->size;
+    SolverStats stats = {0};
+    stats.precolor_time = session->propagation_time;
+
+    double start = timer_now();
+    if (session->have_solution && is_valid_solution(puzzle, session->solution)) {
+        // The edit did not invalidate the previous solution
+        stats.status = SOLVER_SOLVED;
+        stats.found_solution = true;
+        stats.solutions = 1;
+        stats.best_depth = n * n;
+        stats.coloring_time = timer_now() - start;
+    } else {
+        // Bring the possible colors of the edited region into the solver's ascending lists
+        for (int row = 0; row < n; row++) {
+            for (int col = 0; col < n; col++) {
+                if (!session->dirty[row][col]) continue;
+                int length = 0;
+                for (int color = 1; color <= n; color++) {
+                    if (session->domain[row][col] & (1ULL << color)) {
+                        puzzle->pc_list[row][col][length++] = color;
+                    }
+                }
+                puzzle->pc_lengths[row][col] = length;
+                session->dirty[row][col] = false;
+            }
+        }
+        memset(session->solution, 0, sizeof(session->solution));
+        session->have_solution = search_puzzle(puzzle, session->solution, &stats);
+    }
+
+    stats.total_time = stats.precolor_time + stats.coloring_time;
+    for (int row = 0; row < n; row++) {
+        for (int col = 0; col < n; col++) {
+            stats.remaining_colors += __builtin_popcountll(session->domain[row][col]);
+        }
+    }
+    stats.total_processed = n * n * n;
+    stats.colors_removed = stats.total_processed - stats.remaining_colors;
+
+    session->cells_revised = 0;
+    session->propagation_time = 0.0;
+    return stats;
+}
+
+bool run_edit_script(const char* puzzle_file, const char* script_file) {
+    FILE* file = fopen(script_file, "r");
+    if (!file) {
+        printf("Error: Could not open edit script %s\n", script_file);
+        return false;
+    }
+    EditSession* session = malloc(sizeof(EditSession));
+    if (!session || !edit_session_open(session, puzzle_file)) {
+        free(session);
+        fclose(file);
+        return false;
+    }
+
+    SolverStats stats = edit_session_solve(session);
+    printf("Initial solve: %s in %.6f s\n", stats.found_solution ? "solved" : "no solution",
+           stats.total_time);
+
+    char line[256];
+    int line_number = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), file)) {
+        line_number++;
+        char kind[16], symbol[8] = ".";
+        int row, col;
+        if (line[0] == '#' || sscanf(line, "%15s", kind) != 1) continue;
+        if (sscanf(line, "%15s %d %d %7s", kind, &row, &col, symbol) < 3) {
+            printf("Error: Malformed edit on line %d\n", line_number);
+            ok = false;
+            break;
+        }
+
+        double start = timer_now();
+        bool applied;
+        if (strcmp(kind, "given") == 0) {
+            applied = edit_set_given(session, row, col, atoi(symbol));
+        } else if (strcmp(kind, "h") == 0) {
+            applied = edit_set_h_constraint(session, row, col,
+                                            symbol[0] == '<'   ? SMALLER
+                                            : symbol[0] == '>' ? GREATER
+                                                               : NO_CONS);
+        } else if (strcmp(kind, "v") == 0) {
+            applied = edit_set_v_constraint(session, row, col,
+                                            symbol[0] == '^'   ? SMALLER
+                                            : symbol[0] == 'v' ? GREATER
+                                                               : NO_CONS);
+        } else {
+            printf("Error: Unknown edit '%s' on line %d\n", kind, line_number);
+            ok = false;
+            break;
+        }
+        if (!applied) {
+            printf("Error: Edit on line %d is out of range\n", line_number);
+            ok = false;
+            break;
+        }
+
+        int revised = session->cells_revised;
+        stats = edit_session_solve(session);
+        double latency = timer_now() - start;
+        printf("Edit %d (%s %d %d %s): %s, %d cells revised, %lld nodes, %.1f us\n", line_number,
+               kind, row, col, symbol,
+               stats.status == SOLVER_SOLVED && stats.nodes == 0 ? "previous solution holds"
+               : stats.found_solution                                   ? "re-solved"
+               : stats.status == SOLVER_UNSATISFIABLE                   ? "no solution"
+                                                                        : "search stopped",
+               revised, stats.nodes, latency * 1e6);
+    }
+
+    fclose(file);
+    free(session);
+    return ok;
+}
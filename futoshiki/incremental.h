@@ -0,0 +1,45 @@
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <stdbool.h>
+
+#include "comparison.h"
+#include "futoshiki.h"
+
+// Editing session over one puzzle for interactive tools. It keeps the pre-colored possible colors
+// and the last solution between edits. Adding a given or an inequality only propagates from the
+// edited cells; removing one restores exactly the colors whose removal depended on it and
+// propagates from there. A re-solve first checks whether the previous solution still holds.
+typedef struct {
+    Futoshiki puzzle;                          // Givens, inequalities and current possible colors
+    unsigned long long domain[MAX_N][MAX_N];   // Bit c set while color c is possible
+    short cause[MAX_N][MAX_N][MAX_N + 1];      // Cell (row * size + col) that removed the color
+    bool dirty[MAX_N][MAX_N];                  // pc_list lags behind domain
+    int solution[MAX_N][MAX_N];
+    bool have_solution;                        // `solution` solved the puzzle before the edits
+    int cells_revised;                         // Cells revised since the last solve
+    double propagation_time;                   // Seconds spent propagating since the last solve
+} EditSession;
+
+// Load and pre-color a puzzle (the session is about 1 MB, allocate it on the heap)
+bool edit_session_open(EditSession* session, const char* filename);
+
+// Set the given of a cell, or clear it with EMPTY
+bool edit_set_given(EditSession* session, int row, int col, int color);
+
+// Set the inequality between (row, col) and its right neighbor, or clear it with NO_CONS
+bool edit_set_h_constraint(EditSession* session, int row, int col, Constraint cons);
+
+// Set the inequality between (row, col) and the cell below, or clear it with NO_CONS
+bool edit_set_v_constraint(EditSession* session, int row, int col, Constraint cons);
+
+// Solution of the edited puzzle: the previous one if it is still valid (no search at all),
+// otherwise a search over the incrementally propagated colors
+SolverStats edit_session_solve(EditSession* session);
+
+// Apply an edit script to a puzzle, re-solving after every edit and reporting the latency. One
+// edit per line, rows and columns from 0: "given r c v" (v = 0 clears), "h r c <|>|." for the
+// inequality right of (r, c) and "v r c ^|v|." for the one below it
+bool run_edit_script(const char* puzzle_file, const char* script_file);
+
+#endif  // INCREMENTAL_H
@@ -0,0 +1,148 @@
+// Search kernel specialized for KN x KN boards. Included once per size by futoshiki.c with KN
+// defined; no include guard on purpose. The kernel walks the same tree as color_g_seq (same cell
+// order, same color order, same node count) on a compact state: fixed-size byte grids with
+// constant strides, row/column occupancy bitmasks and the inequality neighbors of every empty
+// cell resolved up front.
+
+#define KERNEL_CAT_(a, b) a##b
+#define KERNEL_CAT(a, b) KERNEL_CAT_(a, b)
+#define KernelState KERNEL_CAT(KernelState, KN)
+#define kernel_safe KERNEL_CAT(kernel_safe_, KN)
+#define kernel_search KERNEL_CAT(kernel_search_, KN)
+#define kernel_entry KERNEL_CAT(color_g_seq_, KN)
+
+typedef struct {
+    unsigned char grid[KN * KN];       // Current assignment (EMPTY = unassigned)
+    unsigned int row_used[KN];         // Bit c set when color c is used in the row
+    unsigned int col_used[KN];         // Bit c set when color c is used in the column
+    int num_cells;                     // Empty cells still to assign
+    unsigned char pos[KN * KN];        // Linear index of every empty cell, in search order
+    unsigned char pc[KN * KN][KN];     // Candidate colors of every empty cell
+    unsigned char pc_len[KN * KN];
+    unsigned char below[KN * KN][4];   // Neighbors that must hold a smaller color
+    unsigned char num_below[KN * KN];
+    unsigned char above[KN * KN][4];   // Neighbors that must hold a larger color
+    unsigned char num_above[KN * KN];
+    int best_depth;                    // Deepest consistent prefix (linear index)
+    unsigned char best_grid[KN * KN];  // Assignment at best_depth
+    SearchContext* ctx;
+} KernelState;
+
+// Same decision as safe() for an empty cell, with all loops replaced by mask tests
+static inline bool kernel_safe(const KernelState* state, int k, int color) {
+    int p = state->pos[k];
+    unsigned int bit = 1u << color;
+    if ((state->row_used[p / KN] | state->col_used[p % KN]) & bit) return false;
+    for (int i = 0; i < state->num_below[k]; i++) {
+        if (state->grid[state->below[k][i]] >= color) return false;
+    }
+    for (int i = 0; i < state->num_above[k]; i++) {
+        int neighbor = state->grid[state->above[k][i]];
+        if (neighbor != EMPTY && neighbor <= color) return false;
+    }
+    return true;
+}
+
+static bool kernel_search(KernelState* state, int k) {
+    SearchContext* ctx = state->ctx;
+    if (k == state->num_cells) {
+        if (ctx->solutions++ == 0) {
+            ctx->best_depth = KN * KN;
+            for (int i = 0; i < KN * KN; i++) ctx->best_solution[i / KN][i % KN] = state->grid[i];
+        }
+        return !g_count_all;  // In count mode keep backtracking
+    }
+
+    if (!visit_node(ctx)) {
+        return false;
+    }
+
+    int p = state->pos[k];
+    if (p > state->best_depth) {
+        state->best_depth = p;
+        memcpy(state->best_grid, state->grid, sizeof(state->best_grid));
+    }
+
+    int row = p / KN, col = p % KN;
+    for (int i = 0; i < state->pc_len[k]; i++) {
+        int color = state->pc[k][i];
+        if (!kernel_safe(state, k, color)) continue;
+        unsigned int bit = 1u << color;
+        state->grid[p] = (unsigned char)color;
+        state->row_used[row] |= bit;
+        state->col_used[col] |= bit;
+        if (kernel_search(state, k + 1)) {
+            return true;
+        }
+        state->grid[p] = EMPTY;  // Backtrack
+        state->row_used[row] &= ~bit;
+        state->col_used[col] &= ~bit;
+        if (ctx->aborted) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+// Drop-in replacement for color_g_seq on KN x KN boards
+static bool kernel_entry(Futoshiki* puzzle, int solution[MAX_N][MAX_N], int row, int col,
+                         SearchContext* ctx) {
+    KernelState* state = malloc(sizeof(KernelState));
+    memset(state->row_used, 0, sizeof(state->row_used));
+    memset(state->col_used, 0, sizeof(state->col_used));
+    state->num_cells = 0;
+    state->ctx = ctx;
+
+    for (int r = 0; r < KN; r++) {
+        for (int c = 0; c < KN; c++) {
+            int color = solution[r][c];
+            state->grid[r * KN + c] = (unsigned char)color;
+            if (color != EMPTY) {
+                state->row_used[r] |= 1u << color;
+                state->col_used[c] |= 1u << color;
+            }
+            if (r * KN + c < row * KN + col || puzzle->board[r][c] != EMPTY) continue;
+
+            // Resolve the inequalities around this cell into smaller/larger neighbor lists
+            int k = state->num_cells++;
+            state->pos[k] = (unsigned char)(r * KN + c);
+            state->pc_len[k] = (unsigned char)puzzle->pc_lengths[r][c];
+            for (int i = 0; i < puzzle->pc_lengths[r][c]; i++) {
+                state->pc[k][i] = (unsigned char)puzzle->pc_list[r][c][i];
+            }
+            int p = r * KN + c, nb = 0, na = 0;
+            if (c > 0 && puzzle->h_cons[r][c - 1] == GREATER) state->above[k][na++] = p - 1;
+            if (c > 0 && puzzle->h_cons[r][c - 1] == SMALLER) state->below[k][nb++] = p - 1;
+            if (c < KN - 1 && puzzle->h_cons[r][c] == GREATER) state->below[k][nb++] = p + 1;
+            if (c < KN - 1 && puzzle->h_cons[r][c] == SMALLER) state->above[k][na++] = p + 1;
+            if (r > 0 && puzzle->v_cons[r - 1][c] == GREATER) state->above[k][na++] = p - KN;
+            if (r > 0 && puzzle->v_cons[r - 1][c] == SMALLER) state->below[k][nb++] = p - KN;
+            if (r < KN - 1 && puzzle->v_cons[r][c] == GREATER) state->below[k][nb++] = p + KN;
+            if (r < KN - 1 && puzzle->v_cons[r][c] == SMALLER) state->above[k][na++] = p + KN;
+            state->num_below[k] = (unsigned char)nb;
+            state->num_above[k] = (unsigned char)na;
+        }
+    }
+    state->best_depth = ctx->best_depth;
+
+    bool solved = kernel_search(state, 0);
+
+    // Hand the deepest prefix and the final assignment back in the generic layout
+    if (state->best_depth > ctx->best_depth) {
+        ctx->best_depth = state->best_depth;
+        for (int i = 0; i < KN * KN; i++) ctx->best_solution[i / KN][i % KN] = state->best_grid[i];
+    }
+    for (int i = 0; i < KN * KN; i++) solution[i / KN][i % KN] = state->grid[i];
+
+    free(state);
+    return solved;
+}
+
+#undef kernel_entry
+#undef kernel_search
+#undef kernel_safe
+#undef KernelState
+#undef KERNEL_CAT
+#undef KERNEL_CAT_
+#undef KN
@@ -0,0 +1,530 @@
+#define _POSIX_C_SOURCE 200809L  // rand_r
+
+#include "localsearch.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "log.h"
+
+#define TABU_TENURE 10         // Moves a color may not return to a cell, plus a random part
+#define NOISE_PERCENT 2        // Random swaps instead of the best one
+#define PERTURB_SWAPS_PER_N 1  // Random swaps per board row after a failed repair
+#define CHECK_MOVES 1024       // Moves between two checks for the end of a round (power of two)
+
+// Read-only description of the puzzle shared by all walkers
+typedef struct {
+    const Futoshiki* puzzle;
+    int size;
+    unsigned long long domain[MAX_N][MAX_N];  // Bit c set while color c is possible
+    bool fixed[MAX_N][MAX_N];                 // Givens never move
+} LocalContext;
+
+// One walker: every row a permutation of 1..n. Column counts make the column part of a move's
+// cost change O(1); the inequality part is recounted around the two swapped cells.
+typedef struct {
+    unsigned char value[MAX_N][MAX_N];
+    short col_count[MAX_N][MAX_N + 1];              // Occurrences of every color per column
+    long long tabu_until[MAX_N][MAX_N][MAX_N + 1];  // Move until which a color may not return
+    int cost;  // Column duplicates + violated inequalities + colors outside their cell's domain
+    int best_cost;
+    long long moves;
+    unsigned int seed;
+} Walker;
+
+void local_search_defaults(LocalSearchConfig* config) {
+    config->walkers = 0;
+    config->round_moves = 50000;
+    config->max_rounds = 1000;
+    config->handoff_conflicts = 6;
+    config->repair_size = 12;
+    config->repair_nodes = 200000;
+    config->seed = 12345u;
+}
+
+static bool h_violated(const LocalContext* ctx, const Walker* w, int r, int c) {
+    Constraint cons = ctx->puzzle->h_cons[r][c];
+    return (cons == GREATER && w->value[r][c] <= w->value[r][c + 1]) ||
+           (cons == SMALLER && w->value[r][c] >= w->value[r][c + 1]);
+}
+
+static bool v_violated(const LocalContext* ctx, const Walker* w, int r, int c) {
+    Constraint cons = ctx->puzzle->v_cons[r][c];
+    return (cons == GREATER && w->value[r][c] <= w->value[r + 1][c]) ||
+           (cons == SMALLER && w->value[r][c] >= w->value[r + 1][c]);
+}
+
+// Violated inequalities that involve cell a or cell b of row r, each counted once
+static int touching_violations(const LocalContext* ctx, const Walker* w, int r, int a, int b) {
+    int n = ctx->size, count = 0;
+    int h[4] = {a - 1, a, b - 1, b};
+    for (int i = 0; i < 4; i++) {
+        if (h[i] < 0 || h[i] >= n - 1) continue;
+        bool seen = false;
+        for (int j = 0; j < i; j++) seen |= h[j] == h[i];
+        if (!seen) count += h_violated(ctx, w, r, h[i]);
+    }
+    int cols[2] = {a, b};
+    for (int i = 0; i < 2; i++) {
+        if (r > 0) count += v_violated(ctx, w, r - 1, cols[i]);
+        if (r < n - 1) count += v_violated(ctx, w, r, cols[i]);
+    }
+    return count;
+}
+
+// A color the pre-coloring ruled out counts as one violation: forbidding such swaps outright
+// would leave too few moves to get out of local minima
+static int outside_domain(const LocalContext* ctx, int r, int c, int color) {
+    return !(ctx->domain[r][c] & (1ULL << color));
+}
+
+static bool cell_conflicted(const LocalContext* ctx, const Walker* w, int r, int c) {
+    int n = ctx->size;
+    if (w->col_count[c][w->value[r][c]] > 1 || outside_domain(ctx, r, c, w->value[r][c])) {
+        return true;
+    }
+    return (c > 0 && h_violated(ctx, w, r, c - 1)) || (c < n - 1 && h_violated(ctx, w, r, c)) ||
+           (r > 0 && v_violated(ctx, w, r - 1, c)) || (r < n - 1 && v_violated(ctx, w, r, c));
+}
+
+static int full_cost(const LocalContext* ctx, const Walker* w) {
+    int n = ctx->size, cost = 0;
+    for (int c = 0; c < n; c++) {
+        for (int color = 1; color <= n; color++) {
+            if (w->col_count[c][color] > 1) cost += w->col_count[c][color] - 1;
+        }
+    }
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            cost += outside_domain(ctx, r, c, w->value[r][c]);
+            if (c < n - 1) cost += h_violated(ctx, w, r, c);
+            if (r < n - 1) cost += v_violated(ctx, w, r, c);
+        }
+    }
+    return cost;
+}
+
+// Kuhn's augmenting path for the row matching of free cells to missing colors
+static bool augment(const LocalContext* ctx, int r, int cell, const int* cells,
+                    int match_of_color[MAX_N + 1], bool visited[MAX_N + 1]) {
+    int c = cells[cell];
+    for (int color = 1; color <= ctx->size; color++) {
+        if (!(ctx->domain[r][c] & (1ULL << color)) || visited[color]) continue;
+        visited[color] = true;
+        if (match_of_color[color] < 0 ||
+            augment(ctx, r, match_of_color[color], cells, match_of_color, visited)) {
+            match_of_color[color] = cell;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Random start: every row a permutation that keeps the givens and, where a matching exists,
+// puts every free cell on one of its possible colors
+static void walker_init(const LocalContext* ctx, Walker* w, unsigned int seed) {
+    int n = ctx->size;
+    w->seed = seed;
+    w->moves = 0;
+    memset(w->col_count, 0, sizeof(w->col_count));
+    memset(w->tabu_until, 0, sizeof(w->tabu_until));
+
+    for (int r = 0; r < n; r++) {
+        int cells[MAX_N], num_cells = 0;
+        bool used[MAX_N + 1] = {false};
+        for (int c = 0; c < n; c++) {
+            w->value[r][c] = (unsigned char)ctx->puzzle->board[r][c];
+            if (ctx->fixed[r][c]) {
+                used[w->value[r][c]] = true;
+            } else {
+                cells[num_cells++] = c;
+            }
+        }
+        for (int i = num_cells - 1; i > 0; i--) {
+            int j = rand_r(&w->seed) % (i + 1), t = cells[i];
+            cells[i] = cells[j];
+            cells[j] = t;
+        }
+
+        int match_of_color[MAX_N + 1];
+        for (int color = 0; color <= n; color++) match_of_color[color] = -1;
+        for (int i = 0; i < num_cells; i++) {
+            bool visited[MAX_N + 1] = {false};
+            for (int color = 1; color <= n; color++) visited[color] = used[color];
+            augment(ctx, r, i, cells, match_of_color, visited);
+        }
+        for (int color = 1; color <= n; color++) {
+            if (match_of_color[color] >= 0) w->value[r][cells[match_of_color[color]]] = color;
+        }
+
+        // Cells left unmatched (inconsistent domains) take the remaining colors in any order
+        for (int color = 1; color <= n; color++) {
+            if (used[color] || match_of_color[color] >= 0) continue;
+            for (int i = 0; i < num_cells; i++) {
+                if (w->value[r][cells[i]] == EMPTY) {
+                    w->value[r][cells[i]] = color;
+                    break;
+                }
+            }
+        }
+        for (int c = 0; c < n; c++) w->col_count[c][w->value[r][c]]++;
+    }
+    w->cost = full_cost(ctx, w);
+    w->best_cost = w->cost;
+}
+
+// Cost change of swapping cells a and b of row r
+static int swap_delta(const LocalContext* ctx, Walker* w, int r, int a, int b) {
+    int x = w->value[r][a], y = w->value[r][b];
+    int delta = (w->col_count[a][y] >= 1) - (w->col_count[a][x] >= 2) +
+                (w->col_count[b][x] >= 1) - (w->col_count[b][y] >= 2) +
+                outside_domain(ctx, r, a, y) + outside_domain(ctx, r, b, x) -
+                outside_domain(ctx, r, a, x) - outside_domain(ctx, r, b, y);
+    int before = touching_violations(ctx, w, r, a, b);
+    w->value[r][a] = (unsigned char)y;
+    w->value[r][b] = (unsigned char)x;
+    int after = touching_violations(ctx, w, r, a, b);
+    w->value[r][a] = (unsigned char)x;
+    w->value[r][b] = (unsigned char)y;
+    return delta + after - before;
+}
+
+static void apply_swap(const LocalContext* ctx, Walker* w, int r, int a, int b, int delta) {
+    int x = w->value[r][a], y = w->value[r][b];
+    w->col_count[a][x]--;
+    w->col_count[a][y]++;
+    w->col_count[b][y]--;
+    w->col_count[b][x]++;
+    w->value[r][a] = (unsigned char)y;
+    w->value[r][b] = (unsigned char)x;
+    w->cost += delta;
+
+    long long tenure = TABU_TENURE + rand_r(&w->seed) % (ctx->size + 1);
+    w->tabu_until[r][a][x] = w->moves + tenure;
+    w->tabu_until[r][b][y] = w->moves + tenure;
+    w->moves++;
+    if (w->cost < w->best_cost) w->best_cost = w->cost;
+}
+
+static bool swap_allowed(const LocalContext* ctx, int r, int a, int b) {
+    return !ctx->fixed[r][b] && b != a;
+}
+
+// One min-conflicts move in the row of a random conflicted cell: the swap of a conflicted cell of
+// that row with any free cell that lowers the cost most, skipping tabu moves unless they beat
+// the walker's best cost. A few moves are random swaps of the chosen cell instead.
+static void walker_step(const LocalContext* ctx, Walker* w) {
+    int n = ctx->size;
+    int row = -1, col = -1;
+
+    // Random probes find a conflicted cell quickly while there are many; scan when there are few
+    for (int probe = 0; probe < 4 * n && row < 0; probe++) {
+        int r = rand_r(&w->seed) % n, c = rand_r(&w->seed) % n;
+        if (!ctx->fixed[r][c] && cell_conflicted(ctx, w, r, c)) {
+            row = r;
+            col = c;
+        }
+    }
+    for (int r = 0, seen = 0; r < n && row < 0; r++) {
+        for (int c = 0; c < n; c++) {
+            if (ctx->fixed[r][c] || !cell_conflicted(ctx, w, r, c)) continue;
+            if (rand_r(&w->seed) % ++seen == 0) {
+                row = r;
+                col = c;
+            }
+        }
+    }
+    if (row < 0) return;
+
+    if (rand_r(&w->seed) % 100 < NOISE_PERCENT) {
+        int b = rand_r(&w->seed) % n;
+        if (swap_allowed(ctx, row, col, b)) {
+            apply_swap(ctx, w, row, col, b, swap_delta(ctx, w, row, col, b));
+        }
+        return;
+    }
+
+    int best_a = -1, best_b = -1, best_delta = 0, ties = 0;
+    for (int a = 0; a < n; a++) {
+        if (ctx->fixed[row][a] || !cell_conflicted(ctx, w, row, a)) continue;
+        for (int b = 0; b < n; b++) {
+            if (!swap_allowed(ctx, row, a, b)) continue;
+            int delta = swap_delta(ctx, w, row, a, b);
+            bool tabu = w->tabu_until[row][a][w->value[row][b]] > w->moves ||
+                        w->tabu_until[row][b][w->value[row][a]] > w->moves;
+            if (tabu && w->cost + delta >= w->best_cost) continue;
+            if (best_a < 0 || delta < best_delta) {
+                best_a = a;
+                best_b = b;
+                best_delta = delta;
+                ties = 1;
+            } else if (delta == best_delta && rand_r(&w->seed) % ++ties == 0) {
+                best_a = a;
+                best_b = b;
+            }
+        }
+    }
+    if (best_a < 0) {
+        w->moves++;  // Every move is tabu: let the tenure run down
+        return;
+    }
+    apply_swap(ctx, w, row, best_a, best_b, best_delta);
+}
+
+// Random swaps to leave the region a failed repair came from
+static void walker_perturb(const LocalContext* ctx, Walker* w) {
+    int n = ctx->size;
+    for (int i = 0; i < PERTURB_SWAPS_PER_N * n; i++) {
+        int r = rand_r(&w->seed) % n, a = rand_r(&w->seed) % n, b = rand_r(&w->seed) % n;
+        if (ctx->fixed[r][a] || !swap_allowed(ctx, r, a, b)) continue;
+        apply_swap(ctx, w, r, a, b, swap_delta(ctx, w, r, a, b));
+    }
+    w->best_cost = w->cost;
+}
+
+// Marks `count` lines: the ones already marked plus random others
+static int fill_lines(bool marked[MAX_N], int marked_count, int count, int n, unsigned int* seed) {
+    while (marked_count < count && marked_count < n) {
+        int line = rand_r(seed) % n;
+        if (!marked[line]) {
+            marked[line] = true;
+            marked_count++;
+        }
+    }
+    return marked_count;
+}
+
+// Exact search over the sub-grid of the rows and columns that hold conflicts, padded with random
+// other rows and columns up to repair_size each, with every cell outside it fixed to the
+// walker's color. Fixed cells never conflict with each other and every freed row and column
+// has to take back exactly the colors it held, so the exact search is a small Latin rectangle
+// completion. Returns whether `solution` was filled.
+static bool repair_conflicts(const LocalContext* ctx, Walker* w, const LocalSearchConfig* config,
+                             Futoshiki* scratch, int solution[MAX_N][MAX_N], SolverStats* stats) {
+    int n = ctx->size;
+    bool row_freed[MAX_N] = {false}, col_freed[MAX_N] = {false};
+    int rows = 0, cols = 0;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            if (ctx->fixed[r][c] || !cell_conflicted(ctx, w, r, c)) continue;
+            rows += !row_freed[r];
+            cols += !col_freed[c];
+            row_freed[r] = col_freed[c] = true;
+        }
+    }
+    if (rows > config->repair_size || cols > config->repair_size) return false;
+    int conflict_rows = rows, conflict_cols = cols;
+    rows = fill_lines(row_freed, rows, config->repair_size, n, &w->seed);
+    cols = fill_lines(col_freed, cols, config->repair_size, n, &w->seed);
+
+    memcpy(scratch, ctx->puzzle, sizeof(*scratch));
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            if (!row_freed[r] || !col_freed[c]) scratch->board[r][c] = w->value[r][c];
+        }
+    }
+    compute_pc_lists(scratch, true);
+
+    // A repair looks for one solution of its own sub-puzzle: it neither counts all of them nor
+    // writes (or resumes from) the checkpoint of the user's search
+    SolverLimits limits, repair;
+    get_solver_limits(&limits);
+    repair = limits;
+    repair.node_limit = config->repair_nodes;
+    set_solver_limits(&repair);
+    CheckpointConfig checkpoint, no_checkpoint = {NULL, 0.0, NULL};
+    get_checkpoint_config(&checkpoint);
+    set_checkpoint_config(&no_checkpoint);
+    bool count_all = get_count_mode();
+    set_count_mode(false);
+
+    SolverStats repair_stats = {0};
+    memset(solution, 0, sizeof(int) * MAX_N * MAX_N);
+    bool solved = search_puzzle(scratch, solution, &repair_stats);
+    set_solver_limits(&limits);
+    set_checkpoint_config(&checkpoint);
+    set_count_mode(count_all);
+
+    stats->nodes += repair_stats.nodes;
+    stats->handoffs++;
+    LOG_PROGRESS("Hand-off of %d conflicts in %dx%d cells, %dx%d freed: %s after %lld nodes",
+                 w->cost, conflict_rows, conflict_cols, rows, cols,
+                 solver_status_name(repair_stats.status), repair_stats.nodes);
+    return solved && is_valid_solution(ctx->puzzle, solution);
+}
+
+bool local_search_puzzle(Futoshiki* puzzle, const LocalSearchConfig* config,
+                         int solution[MAX_N][MAX_N], SolverStats* stats) {
+    double start = timer_now();
+    int n = puzzle->size;
+    stats->status = SOLVER_NODE_LIMIT;
+    stats->strategy = STRATEGY_AUTO;
+    if (givens_conflict(puzzle)) {
+        stats->status = SOLVER_UNSATISFIABLE;
+        stats->coloring_time = timer_now() - start;
+        return false;
+    }
+
+    LocalContext* ctx = malloc(sizeof(LocalContext));
+    int walkers = config->walkers > 0 ? config->walkers : omp_get_max_threads();
+    Walker* pool = malloc(sizeof(Walker) * walkers);
+    Futoshiki* scratch = malloc(sizeof(Futoshiki));
+    if (!ctx || !pool || !scratch) {
+        printf("Error: Could not allocate %d local search walkers\n", walkers);
+        free(ctx);
+        free(pool);
+        free(scratch);
+        stats->status = SOLVER_ERROR;
+        return false;
+    }
+
+    ctx->puzzle = puzzle;
+    ctx->size = n;
+    for (int r = 0; r < n; r++) {
+        for (int c = 0; c < n; c++) {
+            ctx->fixed[r][c] = puzzle->board[r][c] != EMPTY;
+            ctx->domain[r][c] = 0;
+            for (int i = 0; i < puzzle->pc_lengths[r][c]; i++) {
+                ctx->domain[r][c] |= 1ULL << puzzle->pc_list[r][c][i];
+            }
+        }
+    }
+
+    // Repairs are small: run them on the calling thread, between the parallel rounds
+    SolverStrategy strategy = get_solver_strategy();
+    set_solver_strategy(STRATEGY_SEQUENTIAL);
+    SolverLimits limits;
+    get_solver_limits(&limits);
+    double deadline = limits.time_limit > 0 ? start + limits.time_limit : 0.0;
+    stats->local_walkers = walkers;
+    stats->best_conflicts = -1;
+
+    // No more threads than walkers; the team actually started is what the stats report
+    int team = walkers < omp_get_max_threads() ? walkers : omp_get_max_threads();
+    int threads_started = 1;
+#pragma omp parallel for num_threads(team) schedule(static, 1)
+    for (int i = 0; i < walkers; i++) {
+        if (i == 0) threads_started = omp_get_num_threads();
+        walker_init(ctx, &pool[i], config->seed + 7919u * (unsigned int)i);
+    }
+
+    bool found = false;
+    for (int round = 0; !found && (config->max_rounds <= 0 || round < config->max_rounds);
+         round++) {
+        // Walkers move independently until they are close enough for a hand-off or the round
+        // ends; one that reaches zero conflicts, or the deadline, ends the round for everybody
+        bool stop_round = false;
+#pragma omp parallel for num_threads(team) schedule(dynamic, 1)
+        for (int i = 0; i < walkers; i++) {
+            Walker* w = &pool[i];
+            for (long long m = 0; m < config->round_moves; m++) {
+                if (w->cost <= config->handoff_conflicts) break;
+                if ((m & (CHECK_MOVES - 1)) == 0) {
+                    bool stop;
+#pragma omp atomic read
+                    stop = stop_round;
+                    if (!stop && deadline > 0 && timer_now() >= deadline) {
+#pragma omp atomic write
+                        stop_round = true;
+                        stop = true;
+                    }
+                    if (stop) break;
+                }
+                walker_step(ctx, w);
+            }
+            if (w->cost == 0) {
+#pragma omp atomic write
+                stop_round = true;
+            }
+        }
+        bool timed_out = deadline > 0 && timer_now() >= deadline;
+
+        // Hand the closest walkers to the exact search, best first; past the deadline only a
+        // walker that already solved the puzzle counts
+        for (int pass = 0; pass <= config->handoff_conflicts && !found; pass++) {
+            for (int i = 0; i < walkers && !found; i++) {
+                Walker* w = &pool[i];
+                if (w->cost != pass) continue;
+                if (w->cost == 0) {
+                    for (int r = 0; r < n; r++) {
+                        for (int c = 0; c < n; c++) solution[r][c] = w->value[r][c];
+                    }
+                    found = true;
+                } else if (timed_out) {
+                    continue;
+                } else if (repair_conflicts(ctx, w, config, scratch, solution, stats)) {
+                    found = true;
+                } else {
+                    walker_perturb(ctx, w);
+                }
+            }
+        }
+
+        int best = -1;
+        for (int i = 0; i < walkers; i++) {
+            if (best < 0 || pool[i].best_cost < best) best = pool[i].best_cost;
+        }
+        stats->best_conflicts = best;
+        LOG_PROGRESS("Round %d: best walker at %d conflicts", round + 1, best);
+        if (timed_out && !found) {
+            stats->status = SOLVER_TIMEOUT;
+            break;
+        }
+    }
+
+    for (int i = 0; i < walkers; i++) stats->local_moves += pool[i].moves;
+    if (found) {
+        stats->status = SOLVER_SOLVED;
+        stats->found_solution = true;
+        stats->solutions = 1;
+        stats->best_conflicts = 0;
+        stats->best_depth = n * n;
+    }
+    set_solver_strategy(strategy);
+    stats->threads_used = threads_started;
+    stats->coloring_time = timer_now() - start;
+
+    free(scratch);
+    free(pool);
+    free(ctx);
+    return found;
+}
+
+SolverStats solve_puzzle_local(const char* filename, bool use_precoloring, bool print_solution,
+                               const LocalSearchConfig* config) {
+    SolverStats stats = {0};
+    stats.status = SOLVER_ERROR;
+    Futoshiki* puzzle = malloc(sizeof(Futoshiki));
+    if (!puzzle || !read_puzzle_from_file(filename, puzzle)) {
+        free(puzzle);
+        return stats;
+    }
+
+    double start_precolor = timer_now();
+    stats.colors_removed = compute_pc_lists(puzzle, use_precoloring);
+    stats.precolor_time = timer_now() - start_precolor;
+    int n = puzzle->size;
+    for (int row = 0; row < n; row++) {
+        for (int col = 0; col < n; col++) stats.remaining_colors += puzzle->pc_lengths[row][col];
+    }
+    stats.total_processed = n * n * n;
+
+    int solution[MAX_N][MAX_N] = {{0}};
+    bool solved = local_search_puzzle(puzzle, config, solution, &stats);
+    stats.total_time = stats.precolor_time + stats.coloring_time;
+    log_flush();
+
+    if (print_solution) {
+        if (solved) {
+            printf("Solution:\n");
+            print_board(puzzle, solution);
+        } else {
+            printf("No solution found by local search (%s).\n", solver_status_name(stats.status));
+        }
+    }
+    free(puzzle);
+    return stats;
+}
@@ -0,0 +1,41 @@
+#ifndef LOCALSEARCH_H
+#define LOCALSEARCH_H
+
+#include <stdbool.h>
+
+#include "comparison.h"
+#include "futoshiki.h"
+
+// Incomplete solver for large instances (30x30 and up) where complete backtracking does not
+// finish. Every walker keeps each row a permutation that respects the givens, starting from
+// the pre-colored possible colors, and swaps two cells of a row to reduce the number of violated
+// column and inequality constraints and ruled-out colors (min-conflicts with a tabu list).
+// Walkers run independently on the OpenMP threads in rounds; after every round the walkers that
+// are down to a few conflicts hand off to the exact search, which re-solves the rows and columns
+// around the conflicts with everything else fixed. It can find a solution but never prove there
+// is none.
+
+typedef struct {
+    int walkers;             // Independent walkers (0 = one per thread)
+    long long round_moves;   // Moves per walker between two hand-off rounds
+    int max_rounds;          // Rounds before giving up (0 = until the time limit)
+    int handoff_conflicts;   // Hand a walker off once it has at most this many violations
+    int repair_size;         // Rows and columns the exact repair may change: the conflicting
+                             // ones, padded with random others (no hand-off when they span more)
+    long long repair_nodes;  // Node budget of one exact repair
+    unsigned int seed;
+} LocalSearchConfig;
+
+// Defaults for the fields above
+void local_search_defaults(LocalSearchConfig* config);
+
+// Search a pre-colored puzzle; fills the same fields of `stats` as search_puzzle plus the
+// local-search counters, and returns whether `solution` holds a solution
+bool local_search_puzzle(Futoshiki* puzzle, const LocalSearchConfig* config,
+                         int solution[MAX_N][MAX_N], SolverStats* stats);
+
+// As solve_puzzle, with the local-search engine instead of backtracking
+SolverStats solve_puzzle_local(const char* filename, bool use_precoloring, bool print_solution,
+                               const LocalSearchConfig* config);
+
+#endif  // LOCALSEARCH_H
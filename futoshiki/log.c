@@ -0,0 +1,196 @@
+#include "log.h"
+
+#include <omp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../timing/timer.h"
+
+typedef struct {
+    double time;         // Seconds since log_open
+    long long sequence;  // Position in the thread's ring, orders messages of equal time
+    int level;
+    int thread;
+    char text[LOG_MESSAGE_CHARS];
+} LogMessage;
+
+// One ring per thread, padded so that the indices of neighbouring threads do not share a line.
+// `head` is only written by the owning thread, `tail` only by the flusher.
+typedef struct {
+    LogMessage* messages;
+    long long head;
+    long long tail;
+    long long dropped;
+    char padding[64 - sizeof(LogMessage*) - 3 * sizeof(long long)];
+} LogRing;
+
+static bool g_enabled = false;
+static bool g_registered = false;
+static LogRing* g_rings = NULL;
+static int g_num_rings = 0;
+static LogMessage** g_pending = NULL;  // Flusher scratch: messages of all rings
+static long long g_reported_drops = 0;
+static long long g_ringless_drops = 0;  // Messages of threads beyond the last ring
+static long long g_reported_ringless = 0;
+static double g_start = 0.0;
+static double g_next_flush = 0.0;
+static omp_lock_t g_flush_lock;
+
+static const char* LEVEL_NAMES[] = {"ERROR", "INFO", "PROGRESS", "DEBUG"};
+
+bool log_open(int max_threads) {
+    if (g_enabled) return true;
+
+    g_rings = calloc(max_threads, sizeof(LogRing));
+    g_pending = malloc(sizeof(LogMessage*) * LOG_RING_MESSAGES * max_threads);
+    if (!g_rings || !g_pending) return false;
+    for (int t = 0; t < max_threads; t++) {
+        g_rings[t].messages = malloc(sizeof(LogMessage) * LOG_RING_MESSAGES);
+        if (!g_rings[t].messages) return false;
+    }
+    g_num_rings = max_threads;
+    g_reported_drops = 0;
+    g_ringless_drops = 0;
+    g_reported_ringless = 0;
+    g_start = timer_now();
+    g_next_flush = g_start + LOG_FLUSH_INTERVAL;
+    omp_init_lock(&g_flush_lock);
+    g_enabled = true;
+    if (!g_registered) {
+        atexit(log_close);
+        g_registered = true;
+    }
+    return true;
+}
+
+void log_close(void) {
+    if (!g_enabled) return;
+
+    log_flush();
+    g_enabled = false;
+    omp_destroy_lock(&g_flush_lock);
+    for (int t = 0; t < g_num_rings; t++) free(g_rings[t].messages);
+    free(g_rings);
+    free(g_pending);
+    g_rings = NULL;
+    g_pending = NULL;
+    g_num_rings = 0;
+}
+
+bool log_enabled(void) { return g_enabled; }
+
+void log_write(int level, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    if (!g_enabled) {
+        // Errors are never lost, everything else needs an open log
+        if (level == LOG_LEVEL_ERROR) {
+            printf("[ERROR] ");
+            vprintf(format, args);
+            printf("\n");
+        }
+        va_end(args);
+        return;
+    }
+
+    int thread = omp_get_thread_num();
+    if (thread >= g_num_rings) {
+#pragma omp atomic update
+        g_ringless_drops++;
+        va_end(args);
+        return;
+    }
+
+    LogRing* ring = &g_rings[thread];
+    long long head = ring->head, tail;
+#pragma omp atomic read seq_cst
+    tail = ring->tail;
+    if (head - tail >= LOG_RING_MESSAGES) {
+#pragma omp atomic update
+        ring->dropped++;
+        va_end(args);
+        return;
+    }
+
+    LogMessage* message = &ring->messages[head % LOG_RING_MESSAGES];
+    message->time = timer_now() - g_start;
+    message->sequence = head;
+    message->level = level;
+    message->thread = thread;
+    vsnprintf(message->text, sizeof(message->text), format, args);
+    va_end(args);
+
+    // Publish the message to the flusher
+#pragma omp atomic write seq_cst
+    ring->head = head + 1;
+}
+
+static int compare_messages(const void* a, const void* b) {
+    const LogMessage* x = *(const LogMessage* const*)a;
+    const LogMessage* y = *(const LogMessage* const*)b;
+    if (x->time != y->time) return x->time < y->time ? -1 : 1;
+    if (x->thread != y->thread) return x->thread - y->thread;
+    return x->sequence < y->sequence ? -1 : x->sequence > y->sequence;
+}
+
+void log_flush(void) {
+    if (!g_enabled || !omp_test_lock(&g_flush_lock)) return;
+
+    // Snapshot what every ring holds now; writers keep appending behind the snapshot
+    int count = 0;
+    long long heads[g_num_rings];
+    long long dropped = 0;
+    for (int t = 0; t < g_num_rings; t++) {
+        LogRing* ring = &g_rings[t];
+#pragma omp atomic read seq_cst
+        heads[t] = ring->head;
+        for (long long i = ring->tail; i < heads[t]; i++) {
+            g_pending[count++] = &ring->messages[i % LOG_RING_MESSAGES];
+        }
+        long long ring_dropped;
+#pragma omp atomic read
+        ring_dropped = ring->dropped;
+        dropped += ring_dropped;
+    }
+
+    qsort(g_pending, count, sizeof(LogMessage*), compare_messages);
+    for (int i = 0; i < count; i++) {
+        const LogMessage* message = g_pending[i];
+        printf("[%s %.6f T%d] %s\n", LEVEL_NAMES[message->level], message->time,
+               message->thread, message->text);
+    }
+    if (dropped > g_reported_drops) {
+        printf("[LOG] %lld messages dropped (ring of %d messages per thread full)\n",
+               dropped - g_reported_drops, LOG_RING_MESSAGES);
+        g_reported_drops = dropped;
+    }
+    long long ringless;
+#pragma omp atomic read
+    ringless = g_ringless_drops;
+    if (ringless > g_reported_ringless) {
+        printf("[LOG] %lld messages dropped (threads beyond the %d opened rings)\n",
+               ringless - g_reported_ringless, g_num_rings);
+        g_reported_ringless = ringless;
+    }
+    fflush(stdout);
+
+    // Hand the printed slots back to the writers
+    for (int t = 0; t < g_num_rings; t++) {
+#pragma omp atomic write seq_cst
+        g_rings[t].tail = heads[t];
+    }
+
+#pragma omp atomic write
+    g_next_flush = timer_now() + LOG_FLUSH_INTERVAL;
+    omp_unset_lock(&g_flush_lock);
+}
+
+void log_flush_if_due(void) {
+    if (!g_enabled) return;
+
+    double next;
+#pragma omp atomic read
+    next = g_next_flush;
+    if (timer_now() >= next) log_flush();
+}
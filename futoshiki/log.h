@@ -0,0 +1,68 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdbool.h>
+
+// Progress log for verbose runs. Every OpenMP thread formats its messages into its own ring
+// buffer (single producer, single consumer, no locks, no stdio); the rings are drained in
+// timestamp order by log_flush, which a worker calls between subtrees at most every
+// LOG_FLUSH_INTERVAL seconds without anyone waiting for it, and at exit. Messages of a full
+// ring, or of a thread numbered beyond the rings opened, are dropped and counted instead of
+// blocking the thread; the next flush reports how many.
+//
+// Levels above LOG_LEVEL are compiled out, arguments included. The default keeps the
+// per-phase progress messages; build with -DLOG_LEVEL=3 for the per-prefix messages of the
+// parallel search, or with -DLOG_LEVEL=0 to remove all but errors.
+
+#define LOG_LEVEL_ERROR 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_PROGRESS 2
+#define LOG_LEVEL_DEBUG 3
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_PROGRESS
+#endif
+
+#define LOG_RING_MESSAGES 1024  // Messages buffered per thread
+#define LOG_MESSAGE_CHARS 120   // Longer messages are truncated
+#define LOG_FLUSH_INTERVAL 0.5  // Seconds between two flushes during a search
+
+#define LOG_ERROR(...) log_write(LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) log_write(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_PROGRESS
+#define LOG_PROGRESS(...) log_write(LOG_LEVEL_PROGRESS, __VA_ARGS__)
+#else
+#define LOG_PROGRESS(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) log_write(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) ((void)0)
+#endif
+
+// Start logging with one ring per thread; messages are discarded until then
+bool log_open(int max_threads);
+
+// Stop logging after a final flush
+void log_close(void);
+
+bool log_enabled(void);
+
+// Append a message to the calling thread's ring (use the LOG_* macros)
+void log_write(int level, const char* format, ...);
+
+// Print everything buffered so far, oldest first. Returns immediately when another thread is
+// already flushing.
+void log_flush(void);
+
+// log_flush when LOG_FLUSH_INTERVAL has passed since the last one
+void log_flush_if_due(void);
+
+#endif  // LOG_H
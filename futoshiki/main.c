@@ -5,13 +5,38 @@
 
 #include "comparison.h"
 #include "futoshiki.h"
+#include "incremental.h"
+#include "localsearch.h"
+#include "rowsearch.h"
+#include "trace.h"
 
 int main(int argc, char* argv[]) {
-    if (argc != 2 && argc != 3) {
-        printf("Usage: %s <puzzle_file> [-c|-n]\n", argv[0]);
+    if (argc < 2) {
+        printf("Usage: %s <puzzle_file> [-c|-n] [-v] [-a] [-p] [-t sec] [-N nodes] [-m MB]\n",
+               argv[0]);
+        printf("       [--checkpoint file] [--checkpoint-interval sec] [--resume file] [--perf]\n");
+        printf("       [--trace file] [--strategy auto|seq|shallow|deep] [--generic]\n");
+        printf("       [--profile file] [--edits file] [--local] [--rows]\n");
         printf("  -c: comparison mode (run both with and without precoloring)\n");
         printf("  -n: disable precoloring\n");
         printf("  -v: verbose mode (show progress messages)\n");
+        printf("  -t: wall-clock budget in seconds\n");
+        printf("  -N: search node budget (over all threads)\n");
+        printf("  -m: memory budget (resident set size) in MB\n");
+        printf("  -a: count all solutions\n");
+        printf("  -p: pin threads to cores, NUMA-local work queues, placement report\n");
+        printf("  --checkpoint: periodically save the search state to a file\n");
+        printf("  --checkpoint-interval: seconds between checkpoints (default 60)\n");
+        printf("  --resume: continue the search saved in a checkpoint\n");
+        printf("  --perf: hardware performance counters per solver phase\n");
+        printf("  --trace: write a per-thread timeline (Chrome trace JSON) at exit\n");
+        printf("  --strategy: sequential/parallel dispatch (default: auto from tree estimate)\n");
+        printf("  --generic: disable the size-specialized search kernels\n");
+        printf("  --profile: dispatch thresholds from an OpenMP overhead profile (check_cores)\n");
+        printf("  --edits: apply an edit script incrementally, re-solving after every edit\n");
+        printf("  --local: parallel local search with exact repair (large puzzles, incomplete)\n");
+        printf("  --rows: search row by row over precomputed row permutations (up to %dx%d)\n",
+               ROWS_MAX_N, ROWS_MAX_N);
         return 1;
     }
 
@@ -27,19 +52,98 @@ int main(int argc, char* argv[]) {
     // Parse command-line options
     bool use_precoloring = true;
     bool verbose = false;
-    
+    bool comparison = false;
+    SolverLimits limits = {0};
+    CheckpointConfig checkpoint = {NULL, 60.0, NULL};
+    const char* edit_script = NULL;
+    bool local_search = false;
+    bool row_search = false;
+
     for (int i = 2; i < argc; i++) {
         if (strcmp(argv[i], "-c") == 0) {
-            set_progress_display(verbose);
-            run_comparison(argv[1]);
-            return 0;
+            comparison = true;
         } else if (strcmp(argv[i], "-n") == 0) {
             use_precoloring = false;
         } else if (strcmp(argv[i], "-v") == 0) {
             verbose = true;
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            limits.time_limit = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-N") == 0 && i + 1 < argc) {
+            limits.node_limit = strtoll(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            limits.memory_limit_mb = strtol(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-a") == 0) {
+            set_count_mode(true);
+        } else if (strcmp(argv[i], "-p") == 0) {
+            set_thread_pinning(true);
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            set_perf_counters(true);
+        } else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            if (!load_dispatch_profile(argv[++i])) {
+                return 1;
+            }
+            DispatchConfig dispatch;
+            get_dispatch_config(&dispatch);
+            printf("Dispatch from profile: sequential below %.3g nodes, %.3g nodes per thread\n",
+                   dispatch.sequential_max_nodes, dispatch.nodes_per_thread);
+        } else if (strcmp(argv[i], "--generic") == 0) {
+            set_generic_kernel(true);
+        } else if (strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            set_solver_strategy(strcmp(name, "seq") == 0       ? STRATEGY_SEQUENTIAL
+                                : strcmp(name, "shallow") == 0 ? STRATEGY_SHALLOW
+                                : strcmp(name, "deep") == 0    ? STRATEGY_DEEP
+                                                               : STRATEGY_AUTO);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            if (!trace_open(argv[++i], omp_get_max_threads())) {
+                printf("Error: Could not allocate trace buffers\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+            checkpoint.path = argv[++i];
+        } else if (strcmp(argv[i], "--checkpoint-interval") == 0 && i + 1 < argc) {
+            checkpoint.interval = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            checkpoint.resume_path = argv[++i];
+        } else if (strcmp(argv[i], "--edits") == 0 && i + 1 < argc) {
+            edit_script = argv[++i];
+        } else if (strcmp(argv[i], "--local") == 0) {
+            local_search = true;
+        } else if (strcmp(argv[i], "--rows") == 0) {
+            row_search = true;
         }
     }
 
+    set_solver_limits(&limits);
+    set_checkpoint_config(&checkpoint);
+
+    if (edit_script) {
+        set_progress_display(verbose);
+        return run_edit_script(argv[1], edit_script) ? 0 : 1;
+    }
+
+    if (local_search) {
+        set_progress_display(verbose);
+        LocalSearchConfig config;
+        local_search_defaults(&config);
+        SolverStats stats = solve_puzzle_local(argv[1], use_precoloring, true, &config);
+        print_stats(&stats, "");
+        return stats.found_solution ? 0 : 1;
+    }
+
+    if (row_search) {
+        set_progress_display(verbose);
+        SolverStats stats = solve_puzzle_rows(argv[1], use_precoloring, true);
+        print_stats(&stats, "");
+        return 0;
+    }
+
+    if (comparison) {
+        set_progress_display(verbose);
+        run_comparison(argv[1]);
+        return 0;
+    }
+
     set_progress_display(verbose);
     SolverStats stats = solve_puzzle(argv[1], use_precoloring, true);
     print_stats(&stats, "");
@@ -0,0 +1,71 @@
+#include "omp_profile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define OMP_PROFILE_MAGIC "FUTOSHIKI-OMP-PROFILE"
+#define OMP_PROFILE_VERSION 1
+
+bool omp_profile_write(const char* path, const OmpProfile* profile) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Error: Could not write profile %s\n", path);
+        return false;
+    }
+
+    fprintf(file, "%s %d\n", OMP_PROFILE_MAGIC, OMP_PROFILE_VERSION);
+    fprintf(file, "rows %d\n", profile->count);
+    fprintf(file, "# threads parallel_us task_us taskwait_us critical_us\n");
+    for (int i = 0; i < profile->count; i++) {
+        const OmpOverheads* row = &profile->rows[i];
+        fprintf(file, "%d %.4f %.4f %.4f %.4f\n", row->threads, row->parallel_us, row->task_us,
+                row->taskwait_us, row->critical_us);
+    }
+
+    bool ok = !ferror(file);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        printf("Error: Could not write profile %s\n", path);
+    }
+    return ok;
+}
+
+bool omp_profile_read(const char* path, OmpProfile* profile) {
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("Error: Could not open profile %s\n", path);
+        return false;
+    }
+
+    char magic[32];
+    int version;
+    bool ok = fscanf(file, "%31s %d", magic, &version) == 2 &&
+              strcmp(magic, OMP_PROFILE_MAGIC) == 0 && version == OMP_PROFILE_VERSION &&
+              fscanf(file, " rows %d", &profile->count) == 1 && profile->count >= 0 &&
+              profile->count <= OMP_PROFILE_MAX_ROWS;
+    if (ok) {
+        fscanf(file, " #%*[^\n]");  // Column header
+    }
+
+    for (int i = 0; ok && i < profile->count; i++) {
+        OmpOverheads* row = &profile->rows[i];
+        ok = fscanf(file, "%d %lf %lf %lf %lf", &row->threads, &row->parallel_us, &row->task_us,
+                    &row->taskwait_us, &row->critical_us) == 5 &&
+             row->threads > 0;
+    }
+
+    fclose(file);
+    if (!ok) {
+        printf("Error: Malformed profile %s\n", path);
+    }
+    return ok;
+}
+
+const OmpOverheads* omp_profile_lookup(const OmpProfile* profile, int threads) {
+    const OmpOverheads* best = NULL;
+    for (int i = 0; i < profile->count; i++) {
+        const OmpOverheads* row = &profile->rows[i];
+        if (row->threads <= threads && (!best || row->threads > best->threads)) best = row;
+    }
+    return best;
+}
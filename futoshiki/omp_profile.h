@@ -0,0 +1,31 @@
+#ifndef OMP_PROFILE_H
+#define OMP_PROFILE_H
+
+#include <stdbool.h>
+
+#define OMP_PROFILE_MAX_ROWS 32
+
+// OpenMP construct overheads at one team size, in microseconds (EPCC method: construct time
+// minus the time of the same work without it)
+typedef struct {
+    int threads;
+    double parallel_us;  // Fork/join of an empty parallel region
+    double task_us;      // Creating and running one task
+    double taskwait_us;  // Task followed by a taskwait
+    double critical_us;  // Entering and leaving a critical section
+} OmpOverheads;
+
+// Overheads measured by check_cores on one node type
+typedef struct {
+    int count;
+    OmpOverheads rows[OMP_PROFILE_MAX_ROWS];  // Increasing thread counts
+} OmpProfile;
+
+bool omp_profile_write(const char* path, const OmpProfile* profile);
+
+bool omp_profile_read(const char* path, OmpProfile* profile);
+
+// Row measured with the largest team that does not exceed `threads` (NULL if none)
+const OmpOverheads* omp_profile_lookup(const OmpProfile* profile, int threads);
+
+#endif  // OMP_PROFILE_H
@@ -0,0 +1,166 @@
+#define _GNU_SOURCE  // syscall()
+
+#include "perf_counters.h"
+
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Events of a group (group_fd >= 0) stay enabled and follow their leader, which is read for
+// all of them at once
+static int open_event(unsigned int type, unsigned long long config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = group_fd < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    if (type == PERF_TYPE_HARDWARE && config == PERF_COUNT_HW_CPU_CYCLES) {
+        attr.read_format |= PERF_FORMAT_GROUP;
+    }
+
+    // pid = 0, cpu = -1: the calling thread on whatever CPU it runs
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+// Value scaled to the whole enabled time if the kernel had to multiplex the event
+static bool scale_count(unsigned long long value, unsigned long long enabled,
+                        unsigned long long running, long long* count) {
+    if (running > 0) {
+        *count = (long long)((double)value * enabled / running);
+        return true;
+    }
+    *count = 0;
+    return enabled == 0;  // Phase too short to be scheduled at all
+}
+
+bool perf_counters_open(PerfCounters* counters) {
+    static const unsigned long long l1d_read_miss =
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    // Cycles and instructions in one group, so that both are counted over the same time
+    // windows under multiplexing and their ratio (IPC) stays meaningful
+    int cycles = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1);
+    int instructions = -1;
+    if (cycles >= 0) {
+        instructions = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, cycles);
+    }
+    counters->fds[PERF_CYCLES] = cycles;
+    counters->fds[PERF_INSTRUCTIONS] = instructions;
+    counters->fds[PERF_L1D_MISSES] = open_event(PERF_TYPE_HW_CACHE, l1d_read_miss, -1);
+    counters->fds[PERF_LLC_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1);
+    counters->fds[PERF_BRANCH_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1);
+
+    bool any = false;
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        any = any || counters->fds[e] >= 0;
+    }
+    return any;
+}
+
+// The instructions event is driven through its group leader, the cycles event
+static bool is_group_member(int event) { return event == PERF_INSTRUCTIONS; }
+
+void perf_counters_start(PerfCounters* counters) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (counters->fds[e] < 0 || is_group_member(e)) continue;
+        ioctl(counters->fds[e], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(counters->fds[e], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+void perf_counters_stop(PerfCounters* counters, PerfCounts* counts) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        counts->counts[e] = 0;
+        counts->valid[e] = false;
+    }
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (counters->fds[e] < 0 || is_group_member(e)) continue;
+        ioctl(counters->fds[e], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        if (e == PERF_CYCLES) {
+            // Group: number of events, time enabled, time running, one value per event
+            unsigned long long group[5];
+            ssize_t bytes = read(counters->fds[e], group, sizeof(group));
+            if (bytes < (ssize_t)(4 * sizeof(unsigned long long))) continue;
+            counts->valid[PERF_CYCLES] =
+                scale_count(group[3], group[1], group[2], &counts->counts[PERF_CYCLES]);
+            if (group[0] > 1 && counters->fds[PERF_INSTRUCTIONS] >= 0) {
+                counts->valid[PERF_INSTRUCTIONS] = scale_count(
+                    group[4], group[1], group[2], &counts->counts[PERF_INSTRUCTIONS]);
+            }
+            continue;
+        }
+
+        unsigned long long values[3];  // value, time enabled, time running
+        if (read(counters->fds[e], values, sizeof(values)) != sizeof(values)) continue;
+        counts->valid[e] = scale_count(values[0], values[1], values[2], &counts->counts[e]);
+    }
+}
+
+void perf_counters_close(PerfCounters* counters) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        if (counters->fds[e] >= 0) close(counters->fds[e]);
+        counters->fds[e] = -1;
+    }
+}
+
+#else  // Hardware counters are only supported on Linux
+
+bool perf_counters_open(PerfCounters* counters) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) counters->fds[e] = -1;
+    return false;
+}
+
+void perf_counters_start(PerfCounters* counters) { (void)counters; }
+
+void perf_counters_stop(PerfCounters* counters, PerfCounts* counts) {
+    (void)counters;
+    memset(counts, 0, sizeof(*counts));
+}
+
+void perf_counters_close(PerfCounters* counters) { (void)counters; }
+
+#endif
+
+void perf_counts_reset(PerfCounts* counts) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        counts->counts[e] = 0;
+        counts->valid[e] = true;
+    }
+}
+
+void perf_counts_add(PerfCounts* total, const PerfCounts* part) {
+    for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+        total->counts[e] += part->counts[e];
+        total->valid[e] = total->valid[e] && part->valid[e];
+    }
+}
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+        case PERF_CYCLES:
+            return "cycles";
+        case PERF_INSTRUCTIONS:
+            return "instructions";
+        case PERF_L1D_MISSES:
+            return "L1d misses";
+        case PERF_LLC_MISSES:
+            return "LLC misses";
+        case PERF_BRANCH_MISSES:
+            return "branch misses";
+        case PERF_NUM_EVENTS:
+            break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,45 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdbool.h>
+
+typedef enum {
+    PERF_CYCLES = 0,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_NUM_EVENTS
+} PerfEvent;
+
+// Counter values of one phase; events the CPU or kernel refused are marked invalid
+typedef struct {
+    long long counts[PERF_NUM_EVENTS];
+    bool valid[PERF_NUM_EVENTS];
+} PerfCounts;
+
+// Hardware counters of the calling thread (Linux perf_event_open, user space only)
+typedef struct {
+    int fds[PERF_NUM_EVENTS];
+} PerfCounters;
+
+// Open the counters for the calling thread; returns false if none could be opened
+bool perf_counters_open(PerfCounters* counters);
+
+// Reset and enable all open counters
+void perf_counters_start(PerfCounters* counters);
+
+// Disable the counters and store their values, scaled if the kernel had to multiplex them
+void perf_counters_stop(PerfCounters* counters, PerfCounts* counts);
+
+void perf_counters_close(PerfCounters* counters);
+
+// Zero counts that are valid, the starting point for perf_counts_add
+void perf_counts_reset(PerfCounts* counts);
+
+// Accumulate `part` into `total`; an event stays valid only if it is valid in both
+void perf_counts_add(PerfCounts* total, const PerfCounts* part);
+
+const char* perf_event_name(PerfEvent event);
+
+#endif  // PERF_COUNTERS_H
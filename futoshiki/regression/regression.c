@@ -0,0 +1,457 @@
+#define _POSIX_C_SOURCE 200809L  // rand_r
+
+#include <ctype.h>
+#include <math.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "comparison.h"
+#include "futoshiki.h"
+
+// Performance regression check of the solver against a committed baseline.
+//
+//   regression baseline.json            run the corpus, compare, exit 1 on a regression
+//   regression baseline.json --record   run the corpus and store the results as new baseline
+//   regression baseline.json --quick    skip the puzzles marked as slow
+//   regression --generate dir count     write `count` pinned random puzzles to dir
+//
+// Every puzzle is solved `runs` times with a fixed thread count. A puzzle regresses when its
+// median time exceeds the baseline median by more than `threshold` and a one-sided
+// Mann-Whitney U test over the individual run times gives p < `alpha`, when its node count
+// changes, or when its solution is invalid or differs from the known output. With fewer than
+// MIN_TEST_RUNS runs on either side the test can never reach a small p (one run against one
+// gives p >= 1/2), so such puzzles regress on the median ratio alone, against
+// FEW_RUNS_FACTOR times the threshold to allow for the noise of single runs.
+
+#define MAX_PUZZLES 64
+#define MAX_RUNS 20
+#define MAX_PATH 256
+#define MIN_TEST_RUNS 3    // Runs per side below which the rank test is not used
+#define FEW_RUNS_FACTOR 2  // Threshold multiplier of the ratio-only check
+
+typedef struct {
+    char file[MAX_PATH];      // Puzzle, relative to the directory the tool runs in
+    char expected[MAX_PATH];  // Known solver output to compare with ("" = validity check only)
+    int runs;                 // Timed runs (0 = use the global setting)
+    bool slow;                // Skipped by --quick
+    long long nodes;
+    int num_times;
+    double times[MAX_RUNS];
+} Entry;
+
+typedef struct {
+    int threads;
+    int runs;
+    double threshold;  // Relative slowdown of the median that is tolerated
+    double alpha;      // Significance level of the slowdown test
+    int num_entries;
+    Entry entries[MAX_PUZZLES];
+} Baseline;
+
+static char* read_file(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = malloc((size_t)size + 1);
+    size_t n = fread(text, 1, (size_t)size, file);
+    text[n] = '\0';
+    fclose(file);
+    return text;
+}
+
+// Minimal readers for the flat baseline format written by write_baseline: look up `"key":`
+// between begin and end
+static const char* json_find(const char* begin, const char* end, const char* key) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\"", key);
+    size_t len = strlen(pattern);
+    for (const char* p = begin; p + len < end; p++) {
+        if (strncmp(p, pattern, len) != 0) continue;
+        p += len;
+        while (p < end && (isspace((unsigned char)*p) || *p == ':')) p++;
+        return p;
+    }
+    return NULL;
+}
+
+static double json_number(const char* begin, const char* end, const char* key, double fallback) {
+    const char* p = json_find(begin, end, key);
+    return p ? strtod(p, NULL) : fallback;
+}
+
+static void json_string(const char* begin, const char* end, const char* key, char* out,
+                        size_t size) {
+    out[0] = '\0';
+    const char* p = json_find(begin, end, key);
+    if (!p || *p != '"') return;
+    size_t n = 0;
+    for (p++; p < end && *p != '"' && n + 1 < size; p++) out[n++] = *p;
+    out[n] = '\0';
+}
+
+static int json_numbers(const char* begin, const char* end, const char* key, double* out,
+                        int max) {
+    const char* p = json_find(begin, end, key);
+    if (!p || *p != '[') return 0;
+    int n = 0;
+    p++;
+    while (p < end && *p != ']' && n < max) {
+        char* next;
+        double value = strtod(p, &next);
+        if (next == p) {
+            p++;
+            continue;
+        }
+        out[n++] = value;
+        p = next;
+    }
+    return n;
+}
+
+static bool read_baseline(const char* path, Baseline* baseline) {
+    char* text = read_file(path);
+    if (!text) {
+        printf("Error: Could not open baseline %s\n", path);
+        return false;
+    }
+    const char* end = text + strlen(text);
+    const char* puzzles = json_find(text, end, "puzzles");
+    if (!puzzles) {
+        printf("Error: No puzzles in baseline %s\n", path);
+        free(text);
+        return false;
+    }
+
+    // Settings come before the puzzle list
+    baseline->threads = (int)json_number(text, puzzles, "threads", 1);
+    baseline->runs = (int)json_number(text, puzzles, "runs", 5);
+    baseline->threshold = json_number(text, puzzles, "threshold", 0.10);
+    baseline->alpha = json_number(text, puzzles, "alpha", 0.05);
+    if (baseline->runs < 1 || baseline->runs > MAX_RUNS) baseline->runs = 5;
+
+    baseline->num_entries = 0;
+    for (const char* p = strchr(puzzles, '{'); p && baseline->num_entries < MAX_PUZZLES;
+         p = strchr(p, '{')) {
+        const char* close = strchr(p, '}');
+        if (!close) break;
+        Entry* entry = &baseline->entries[baseline->num_entries++];
+        json_string(p, close, "file", entry->file, sizeof(entry->file));
+        json_string(p, close, "expected", entry->expected, sizeof(entry->expected));
+        entry->runs = (int)json_number(p, close, "runs", 0);
+        const char* slow = json_find(p, close, "slow");
+        entry->slow = slow && strncmp(slow, "true", 4) == 0;
+        if (entry->runs > MAX_RUNS) entry->runs = MAX_RUNS;
+        entry->nodes = (long long)json_number(p, close, "nodes", -1);
+        entry->num_times = json_numbers(p, close, "times", entry->times, MAX_RUNS);
+        p = close;
+    }
+
+    free(text);
+    return true;
+}
+
+static bool write_baseline(const char* path, const Baseline* baseline) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Error: Could not write baseline %s\n", path);
+        return false;
+    }
+    fprintf(file, "{\n");
+    fprintf(file, "  \"threads\": %d,\n", baseline->threads);
+    fprintf(file, "  \"runs\": %d,\n", baseline->runs);
+    fprintf(file, "  \"threshold\": %g,\n", baseline->threshold);
+    fprintf(file, "  \"alpha\": %g,\n", baseline->alpha);
+    fprintf(file, "  \"puzzles\": [\n");
+    for (int i = 0; i < baseline->num_entries; i++) {
+        const Entry* entry = &baseline->entries[i];
+        fprintf(file, "    {\"file\": \"%s\", ", entry->file);
+        if (entry->expected[0]) fprintf(file, "\"expected\": \"%s\", ", entry->expected);
+        if (entry->runs > 0) fprintf(file, "\"runs\": %d, ", entry->runs);
+        if (entry->slow) fprintf(file, "\"slow\": true, ");
+        fprintf(file, "\"nodes\": %lld, \"times\": [", entry->nodes);
+        for (int k = 0; k < entry->num_times; k++) {
+            fprintf(file, "%s%.6f", k > 0 ? ", " : "", entry->times[k]);
+        }
+        fprintf(file, "]}%s\n", i + 1 < baseline->num_entries ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double median(const double* values, int n) {
+    double sorted[MAX_RUNS];
+    memcpy(sorted, values, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), compare_doubles);
+    return n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+}
+
+// One-sided exact Mann-Whitney U test: probability of a U statistic at least as large as the
+// observed one if `current` and `base` came from the same distribution. Small p means the
+// current times are significantly larger.
+static double mann_whitney_p(const double* current, int n, const double* base, int m) {
+    double u = 0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < m; j++) {
+            u += current[i] > base[j] ? 1.0 : current[i] == base[j] ? 0.5 : 0.0;
+        }
+    }
+
+    // counts[i][j][k]: arrangements of i current and j base samples with U = k
+    int max_u = n * m;
+    double* counts = calloc((size_t)(n + 1) * (m + 1) * (max_u + 1), sizeof(double));
+#define COUNT(i, j, k) counts[((size_t)(i) * (m + 1) + (j)) * (max_u + 1) + (k)]
+    for (int i = 0; i <= n; i++) {
+        for (int j = 0; j <= m; j++) {
+            for (int k = 0; k <= i * j; k++) {
+                if (i == 0 || j == 0) {
+                    COUNT(i, j, k) = k == 0;
+                } else {
+                    // The largest sample is either a current one (beating all j base samples)
+                    // or a base one
+                    COUNT(i, j, k) = (k >= j ? COUNT(i - 1, j, k - j) : 0) + COUNT(i, j - 1, k);
+                }
+            }
+        }
+    }
+    double total = 0, tail = 0;
+    for (int k = 0; k <= max_u; k++) {
+        total += COUNT(n, m, k);
+        if (k >= ceil(u)) tail += COUNT(n, m, k);
+    }
+#undef COUNT
+    free(counts);
+    return tail / total;
+}
+
+// Compare with the "Solution:" section of a saved solver output
+static bool matches_expected(const char* path, int size, int solution[MAX_N][MAX_N]) {
+    char* text = read_file(path);
+    if (!text) {
+        printf("  Error: Could not open expected output %s\n", path);
+        return false;
+    }
+    char* section = strstr(text, "Solution:\n");
+    if (section) {
+        section += strlen("Solution:\n");
+        char* section_end = strstr(section, "\n\n");  // The board ends at the first blank line
+        if (section_end) section_end[1] = '\0';
+    }
+    static Futoshiki expected;
+    bool ok = section && parse_futoshiki(section, &expected) && expected.size == size;
+    for (int r = 0; ok && r < size; r++) {
+        for (int c = 0; c < size; c++) {
+            if (expected.board[r][c] != solution[r][c]) ok = false;
+        }
+    }
+    free(text);
+    return ok;
+}
+
+// Solve one puzzle `runs` times; returns false if a run did not produce a correct solution
+static bool run_entry(Entry* entry, int runs, double* times, long long* nodes) {
+    static Futoshiki puzzle;
+    if (!read_puzzle_from_file(entry->file, &puzzle)) {
+        printf("  Error: Could not read %s\n", entry->file);
+        return false;
+    }
+
+    bool ok = true;
+    for (int k = 0; k < runs; k++) {
+        int solution[MAX_N][MAX_N];
+        SolverStats stats = solve_puzzle_into(entry->file, true, false, solution);
+        times[k] = stats.total_time;
+        if (k == 0) *nodes = stats.nodes;
+        if (stats.status != SOLVER_SOLVED || !is_valid_solution(&puzzle, solution)) {
+            printf("  %s: run %d did not produce a valid solution (%s)\n", entry->file, k + 1,
+                   solver_status_name(stats.status));
+            ok = false;
+        } else if (entry->expected[0] &&
+                   !matches_expected(entry->expected, puzzle.size, solution)) {
+            printf("  %s: solution differs from %s\n", entry->file, entry->expected);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Random Latin square with a fixed share of givens and inequalities; generated once with a
+// pinned seed and committed so the corpus never changes under the baseline
+static void generate_puzzles(const char* dir, int count) {
+    unsigned int seed = 20240601u;
+    for (int i = 0; i < count; i++) {
+        int n = 6 + i % 4;
+        int square[MAX_N][MAX_N], symbols[MAX_N], rows[MAX_N];
+        for (int k = 0; k < n; k++) symbols[k] = rows[k] = k;
+        for (int k = n - 1; k > 0; k--) {
+            int a = rand_r(&seed) % (k + 1), b = rand_r(&seed) % (k + 1), t;
+            t = symbols[k], symbols[k] = symbols[a], symbols[a] = t;
+            t = rows[k], rows[k] = rows[b], rows[b] = t;
+        }
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) square[r][c] = symbols[(rows[r] + c) % n] + 1;
+        }
+
+        char path[MAX_PATH];
+        snprintf(path, sizeof(path), "%s/gen%02d_%dx%d.txt", dir, i + 1, n, n);
+        FILE* file = fopen(path, "w");
+        if (!file) {
+            printf("Error: Could not write %s\n", path);
+            return;
+        }
+        for (int r = 0; r < n; r++) {
+            for (int c = 0; c < n; c++) {
+                fprintf(file, "%d", rand_r(&seed) % 100 < 12 ? square[r][c] : 0);
+                if (c < n - 1) {
+                    char h = ' ';
+                    if (rand_r(&seed) % 100 < 25) h = square[r][c] < square[r][c + 1] ? '<' : '>';
+                    fprintf(file, " %c ", h);
+                }
+            }
+            fprintf(file, "\n");
+            if (r < n - 1) {
+                for (int c = 0; c < n; c++) {
+                    char v = ' ';
+                    if (rand_r(&seed) % 100 < 25) v = square[r][c] < square[r + 1][c] ? '^' : 'v';
+                    fprintf(file, "%c%s", v, c < n - 1 ? "   " : "\n");
+                }
+            }
+        }
+        fclose(file);
+        printf("Wrote %s\n", path);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <baseline.json> [--record] [--quick] [-r runs]\n", argv[0]);
+        printf("       %s --generate <dir> <count>\n", argv[0]);
+        printf("  --record: store the measured times and nodes as the new baseline\n");
+        printf("  --quick: skip the puzzles marked as slow\n");
+        printf("  -r: timed runs per puzzle (default: from the baseline)\n");
+        printf("Exit status: 0 no regression, 1 regression or wrong solution, 2 error\n");
+        return 2;
+    }
+
+    if (strcmp(argv[1], "--generate") == 0) {
+        if (argc < 4) {
+            printf("Error: --generate needs a directory and a count\n");
+            return 2;
+        }
+        generate_puzzles(argv[2], atoi(argv[3]));
+        return 0;
+    }
+
+    bool record = false;
+    bool quick = false;
+    int runs_override = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--record") == 0) {
+            record = true;
+        } else if (strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            runs_override = atoi(argv[++i]);
+        }
+    }
+
+    static Baseline baseline;
+    if (!read_baseline(argv[1], &baseline)) return 2;
+    if (runs_override > 0 && runs_override <= MAX_RUNS) baseline.runs = runs_override;
+
+    omp_set_num_threads(baseline.threads);
+    printf("Regression check: %d puzzles, %d threads, %d runs, threshold %.0f%%, alpha %g\n\n",
+           baseline.num_entries, baseline.threads, baseline.runs, baseline.threshold * 100,
+           baseline.alpha);
+    printf("%-40s %12s %12s %8s %8s %12s  %s\n", "Puzzle", "Base [s]", "Median [s]", "Change",
+           "p", "Nodes", "Result");
+
+    int regressions = 0, failures = 0, ratio_only = 0;
+    for (int i = 0; i < baseline.num_entries; i++) {
+        Entry* entry = &baseline.entries[i];
+        if (quick && entry->slow) {
+            printf("%-40s %12s %12s %8s %8s %12s  %s\n", entry->file, "", "", "", "", "",
+                   "skipped");
+            continue;
+        }
+        int runs = entry->runs > 0 ? entry->runs : baseline.runs;
+        double times[MAX_RUNS];
+        long long nodes = 0;
+        bool correct = run_entry(entry, runs, times, &nodes);
+        double current = median(times, runs);
+
+        const char* result = "ok";
+        double base = 0, change = 0, p = 1;
+        if (!correct) {
+            result = "WRONG SOLUTION";
+            failures++;
+        } else if (entry->num_times == 0) {
+            result = "no baseline";
+        } else {
+            base = median(entry->times, entry->num_times);
+            change = base > 0 ? current / base - 1 : 0;
+            bool testable = runs >= MIN_TEST_RUNS && entry->num_times >= MIN_TEST_RUNS;
+            p = testable ? mann_whitney_p(times, runs, entry->times, entry->num_times) : -1;
+            if (!testable) ratio_only++;
+            if (baseline.threads == 1 && entry->nodes >= 0 && nodes != entry->nodes) {
+                // The sequential search is deterministic: a different tree is a code change
+                result = "NODES CHANGED";
+                regressions++;
+            } else if (!testable) {
+                if (change > FEW_RUNS_FACTOR * baseline.threshold) {
+                    result = "SLOWER (ratio only)";
+                    regressions++;
+                } else {
+                    result = "ok (ratio only)";
+                }
+            } else if (change > baseline.threshold && p < baseline.alpha) {
+                result = "SLOWER";
+                regressions++;
+            } else if (change > baseline.threshold) {
+                result = "ok (not significant)";
+            }
+        }
+        char p_text[16] = "-";
+        if (p >= 0) snprintf(p_text, sizeof(p_text), "%.4f", p);
+        printf("%-40s %12.6f %12.6f %+7.1f%% %8s %12lld  %s\n", entry->file, base, current,
+               change * 100, p_text, nodes, result);
+
+        if (record) {
+            entry->nodes = nodes;
+            entry->num_times = runs;
+            memcpy(entry->times, times, runs * sizeof(double));
+        }
+    }
+
+    if (record) {
+        if (quick) {
+            printf("\nNot recording a baseline with skipped puzzles\n");
+            return 2;
+        }
+        if (failures > 0) {
+            printf("\nNot recording a baseline with wrong solutions\n");
+            return 1;
+        }
+        if (!write_baseline(argv[1], &baseline)) return 2;
+        printf("\nBaseline written to %s\n", argv[1]);
+        return 0;
+    }
+
+    if (ratio_only > 0) {
+        printf("\n%d puzzles with fewer than %d runs on one side: no significance test, they "
+               "regress when the median is more than %.0f%% slower\n",
+               ratio_only, MIN_TEST_RUNS, FEW_RUNS_FACTOR * baseline.threshold * 100);
+    }
+    printf("\n%d regressions, %d wrong solutions\n", regressions, failures);
+    return regressions > 0 || failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+#include "rowsearch.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "log.h"
+
+#define ROW_MASK_WORDS 2               // Bits of the (column, color) pairs of a row
+#define ROWS_PREFIXES_PER_THREAD 16    // Frontier prefixes per thread
+#define ROWS_MAX_PREFIXES (1 << 16)    // The frontier stops growing before it exceeds this
+#define ROWS_BUDGET_INTERVAL 4096      // Nodes between two checks of the shared limits
+
+typedef unsigned long long RowMask[ROW_MASK_WORDS];
+
+// One candidate of a row: the (column, color) pairs it takes, and the pairs that its vertical
+// inequalities rule out in the row above and the row below
+typedef struct {
+    RowMask cells;
+    RowMask up;
+    RowMask down;
+    unsigned char value[ROWS_MAX_N];
+} RowPermutation;
+
+// Candidates sorted by their colors, so that the ones that start with colors (a, b) are
+// perms[bucket[k]] to perms[bucket[k + 1] - 1] with k = a * (n + 1) + b. A search node only
+// scans the buckets whose first two cells are still free.
+typedef struct {
+    RowPermutation* perms;
+    int count;
+    int capacity;
+    bool overflow;  // More than ROWS_MAX_PERMUTATIONS candidates (or out of memory)
+    int bucket[(ROWS_MAX_N + 1) * (ROWS_MAX_N + 1) + 1];
+} RowTable;
+
+typedef struct {
+    const Futoshiki* puzzle;
+    int size;
+    RowTable tables[ROWS_MAX_N];
+    int order[ROWS_MAX_N];     // Row placed at every depth, smallest table first
+    int depth_of[ROWS_MAX_N];  // Depth at which every row is placed
+    bool count_all;
+    long long node_limit;
+    double deadline;  // Absolute wall-clock limit (0 = none)
+
+    // Shared between the tasks
+    bool stop;
+    SolverStatus stop_status;
+    long long nodes;
+    long long solutions;
+    int explored;
+    int best_depth;  // Rows of the deepest prefix
+    bool found;
+    int first_solution[ROWS_MAX_N];  // Candidate per depth of the first solution
+} RowSearch;
+
+// State of one task; `nodes` is added to the shared count every ROWS_BUDGET_INTERVAL nodes
+typedef struct {
+    int chosen[ROWS_MAX_N];  // Candidate per depth
+    long long nodes;
+    int best_depth;
+} RowWorker;
+
+static void mask_set(RowMask mask, int n, int col, int color) {
+    int bit = col * n + color - 1;
+    mask[bit >> 6] |= 1ULL << (bit & 63);
+}
+
+static bool mask_test(const RowMask mask, int n, int col, int color) {
+    int bit = col * n + color - 1;
+    return (mask[bit >> 6] >> (bit & 63)) & 1;
+}
+
+static bool masks_disjoint(const RowMask a, const RowMask b) {
+    return ((a[0] & b[0]) | (a[1] & b[1])) == 0;
+}
+
+static void append_permutation(const Futoshiki* puzzle, int row, const unsigned char* value,
+                               RowTable* table) {
+    int n = puzzle->size;
+    if (table->count == table->capacity) {
+        int capacity = table->capacity ? 2 * table->capacity : 256;
+        if (capacity > ROWS_MAX_PERMUTATIONS) capacity = ROWS_MAX_PERMUTATIONS;
+        RowPermutation* grown = NULL;
+        if (capacity > table->capacity) {
+            grown = realloc(table->perms, sizeof(RowPermutation) * capacity);
+        }
+        if (!grown) {
+            table->overflow = true;
+            return;
+        }
+        table->perms = grown;
+        table->capacity = capacity;
+    }
+
+    RowPermutation* perm = &table->perms[table->count++];
+    memset(perm, 0, sizeof(*perm));
+    for (int c = 0; c < n; c++) {
+        int x = value[c];
+        perm->value[c] = (unsigned char)x;
+        mask_set(perm->cells, n, c, x);
+        Constraint above = row > 0 ? puzzle->v_cons[row - 1][c] : NO_CONS;
+        Constraint below = row < n - 1 ? puzzle->v_cons[row][c] : NO_CONS;
+        for (int color = 1; color <= n; color++) {
+            // GREATER: the upper cell is the larger one
+            if ((above == GREATER && color <= x) || (above == SMALLER && color >= x)) {
+                mask_set(perm->up, n, c, color);
+            }
+            if ((below == GREATER && color >= x) || (below == SMALLER && color <= x)) {
+                mask_set(perm->down, n, c, color);
+            }
+        }
+    }
+}
+
+// All permutations of a row that fit its possible colors and horizontal inequalities
+static void enumerate_row(const Futoshiki* puzzle, int row, int col, unsigned int used,
+                          unsigned char* value, RowTable* table) {
+    if (table->overflow) return;
+    if (col == puzzle->size) {
+        append_permutation(puzzle, row, value, table);
+        return;
+    }
+
+    Constraint left = col > 0 ? puzzle->h_cons[row][col - 1] : NO_CONS;
+    for (int i = 0; i < puzzle->pc_lengths[row][col]; i++) {
+        int color = puzzle->pc_list[row][col][i];
+        if (used & (1u << color)) continue;
+        if ((left == GREATER && value[col - 1] <= color) ||
+            (left == SMALLER && value[col - 1] >= color)) {
+            continue;
+        }
+        value[col] = (unsigned char)color;
+        enumerate_row(puzzle, row, col + 1, used | (1u << color), value, table);
+    }
+}
+
+static int bucket_key(int n, const unsigned char* value) {
+    return value[0] * (n + 1) + (n > 1 ? value[1] : 0);
+}
+
+static int compare_permutations(const void* a, const void* b) {
+    return memcmp(((const RowPermutation*)a)->value, ((const RowPermutation*)b)->value,
+                  ROWS_MAX_N);
+}
+
+static void build_buckets(RowTable* table, int n) {
+    qsort(table->perms, table->count, sizeof(RowPermutation), compare_permutations);
+    int buckets = (n + 1) * (n + 1);
+    int i = 0;
+    for (int k = 0; k <= buckets; k++) {
+        while (i < table->count && bucket_key(n, table->perms[i].value) < k) i++;
+        table->bucket[k] = i;
+    }
+}
+
+static void free_tables(RowSearch* search) {
+    for (int row = 0; row < search->size; row++) free(search->tables[row].perms);
+}
+
+// Pairs that the rows placed before `depth` take or rule out for the row placed at `depth`
+static void blocked_pairs(const RowSearch* search, const int* chosen, int depth,
+                          RowMask blocked) {
+    int n = search->size, row = search->order[depth];
+    blocked[0] = blocked[1] = 0;
+    for (int d = 0; d < depth; d++) {
+        const RowPermutation* perm = &search->tables[search->order[d]].perms[chosen[d]];
+        blocked[0] |= perm->cells[0];
+        blocked[1] |= perm->cells[1];
+    }
+    if (row > 0 && search->depth_of[row - 1] < depth) {
+        const RowPermutation* perm =
+            &search->tables[row - 1].perms[chosen[search->depth_of[row - 1]]];
+        blocked[0] |= perm->down[0];
+        blocked[1] |= perm->down[1];
+    }
+    if (row < n - 1 && search->depth_of[row + 1] < depth) {
+        const RowPermutation* perm =
+            &search->tables[row + 1].perms[chosen[search->depth_of[row + 1]]];
+        blocked[0] |= perm->up[0];
+        blocked[1] |= perm->up[1];
+    }
+}
+
+static bool search_stopped(RowSearch* search) {
+    bool stop;
+#pragma omp atomic read
+    stop = search->stop;
+    return stop;
+}
+
+static void stop_search(RowSearch* search, SolverStatus status) {
+#pragma omp critical(row_search_stop)
+    {
+        if (!search->stop) {
+            search->stop_status = status;
+#pragma omp atomic write
+            search->stop = true;
+        }
+    }
+}
+
+// Add the worker's nodes to the shared count and stop the search when a budget is used up
+static bool check_budget(RowSearch* search, RowWorker* worker) {
+    long long total;
+#pragma omp atomic capture
+    total = search->nodes += worker->nodes;
+    worker->nodes = 0;
+
+    if (search->node_limit > 0 && total >= search->node_limit) {
+        stop_search(search, SOLVER_NODE_LIMIT);
+    } else if (search->deadline > 0 && timer_now() >= search->deadline) {
+        stop_search(search, SOLVER_TIMEOUT);
+    }
+    log_flush_if_due();
+    return !search_stopped(search);
+}
+
+static void record_solution(RowSearch* search, const RowWorker* worker) {
+#pragma omp critical(row_search_solution)
+    {
+        search->solutions++;
+        if (!search->found) {
+            memcpy(search->first_solution, worker->chosen, sizeof(search->first_solution));
+            search->found = true;
+        }
+    }
+    if (!search->count_all) stop_search(search, SOLVER_SOLVED);
+}
+
+static void search_from(RowSearch* search, RowWorker* worker, int depth) {
+    if (depth > worker->best_depth) worker->best_depth = depth;
+    if (depth == search->size) {
+        record_solution(search, worker);
+        return;
+    }
+
+    int n = search->size;
+    RowMask blocked;
+    blocked_pairs(search, worker->chosen, depth, blocked);
+    const RowTable* table = &search->tables[search->order[depth]];
+    for (int a = 1; a <= n; a++) {
+        if (mask_test(blocked, n, 0, a)) continue;
+        for (int b = n > 1 ? 1 : 0; b <= (n > 1 ? n : 0); b++) {
+            if (n > 1 && mask_test(blocked, n, 1, b)) continue;
+            int k = a * (n + 1) + b;
+            for (int i = table->bucket[k]; i < table->bucket[k + 1]; i++) {
+                if (!masks_disjoint(table->perms[i].cells, blocked)) continue;
+                worker->chosen[depth] = i;
+                if (++worker->nodes >= ROWS_BUDGET_INTERVAL && !check_budget(search, worker)) {
+                    return;
+                }
+                search_from(search, worker, depth + 1);
+                if (search_stopped(search)) return;
+            }
+        }
+    }
+}
+
+// Prefixes of the first rows with at least `target` entries (or as many as the frontier limit
+// allows), stored ROWS_MAX_N candidates apart. Returns the number of prefixes (0 when no
+// prefix extends to the frontier depth), or -1 when out of memory.
+static int build_frontier(RowSearch* search, int target, int** prefixes, int* depth) {
+    int n = search->size, count = 1;
+    int* current = calloc(ROWS_MAX_N, sizeof(int));
+    *depth = 0;
+    while (current && *depth < n && count < target) {
+        int children = 0;
+        RowMask blocked;
+        const RowTable* table = &search->tables[search->order[*depth]];
+        for (int p = 0; p < count; p++) {
+            blocked_pairs(search, &current[p * ROWS_MAX_N], *depth, blocked);
+            for (int i = 0; i < table->count; i++) {
+                children += masks_disjoint(table->perms[i].cells, blocked);
+            }
+        }
+        if (children > ROWS_MAX_PREFIXES) break;
+
+        int* next = malloc(sizeof(int) * ROWS_MAX_N * (children > 0 ? children : 1));
+        if (!next) {
+            free(current);
+            return -1;
+        }
+        int filled = 0;
+        for (int p = 0; p < count; p++) {
+            blocked_pairs(search, &current[p * ROWS_MAX_N], *depth, blocked);
+            for (int i = 0; i < table->count; i++) {
+                if (!masks_disjoint(table->perms[i].cells, blocked)) continue;
+                memcpy(&next[filled * ROWS_MAX_N], &current[p * ROWS_MAX_N],
+                       sizeof(int) * ROWS_MAX_N);
+                next[filled * ROWS_MAX_N + *depth] = i;
+                filled++;
+            }
+        }
+        free(current);
+        current = next;
+        count = children;
+        search->nodes += children;
+        (*depth)++;
+        if (count == 0) break;
+    }
+    *prefixes = current;
+    return current ? count : -1;
+}
+
+bool row_search_puzzle(Futoshiki* puzzle, int solution[MAX_N][MAX_N], SolverStats* stats) {
+    int n = puzzle->size;
+    if (n > ROWS_MAX_N) {
+        LOG_INFO("%dx%d rows do not fit the row search, using the cell search", n, n);
+        return search_puzzle(puzzle, solution, stats);
+    }
+    if (givens_conflict(puzzle)) {
+        stats->status = SOLVER_UNSATISFIABLE;
+        return false;
+    }
+
+    RowSearch* search = calloc(1, sizeof(RowSearch));
+    if (!search) {
+        printf("Error: Could not allocate the row search\n");
+        stats->status = SOLVER_ERROR;
+        return false;
+    }
+    search->puzzle = puzzle;
+    search->size = n;
+
+    // Rows are independent: every thread enumerates whole rows
+    double start = timer_now();
+#pragma omp parallel for schedule(dynamic, 1)
+    for (int row = 0; row < n; row++) {
+        unsigned char value[ROWS_MAX_N];
+        enumerate_row(puzzle, row, 0, 0u, value, &search->tables[row]);
+        if (!search->tables[row].overflow) build_buckets(&search->tables[row], n);
+    }
+    stats->row_table_time = timer_now() - start;
+
+    for (int row = 0; row < n; row++) {
+        if (search->tables[row].overflow) {
+            LOG_INFO("Row %d has more than %d candidates, using the cell search", row,
+                     ROWS_MAX_PERMUTATIONS);
+            free_tables(search);
+            free(search);
+            return search_puzzle(puzzle, solution, stats);
+        }
+        stats->row_permutations += search->tables[row].count;
+    }
+
+    // Fewest candidates first
+    for (int d = 0; d < n; d++) search->order[d] = d;
+    for (int d = 1; d < n; d++) {
+        int row = search->order[d], e = d;
+        for (; e > 0 && search->tables[search->order[e - 1]].count > search->tables[row].count;
+             e--) {
+            search->order[e] = search->order[e - 1];
+        }
+        search->order[e] = row;
+    }
+    for (int d = 0; d < n; d++) search->depth_of[search->order[d]] = d;
+
+    SolverLimits limits;
+    get_solver_limits(&limits);
+    search->count_all = get_count_mode();
+    search->node_limit = limits.node_limit;
+    search->deadline = limits.time_limit > 0 ? start + limits.time_limit : 0.0;
+    search->stop_status = SOLVER_UNSATISFIABLE;
+    LOG_PROGRESS("Row tables: %lld candidates in %.6f seconds", stats->row_permutations,
+                 stats->row_table_time);
+
+    int threads = omp_get_max_threads();
+    int* prefixes = NULL;
+    int depth = 0;
+    int count = build_frontier(search, ROWS_PREFIXES_PER_THREAD * threads, &prefixes, &depth);
+    if (count < 0) {
+        printf("Error: Could not allocate the row search frontier\n");
+        free_tables(search);
+        free(search);
+        stats->status = SOLVER_ERROR;
+        return false;
+    }
+    LOG_PROGRESS("Frontier of %d prefixes over the first %d rows", count, depth);
+
+#pragma omp parallel for schedule(dynamic, 1) if (count > 1)
+    for (int p = 0; p < count; p++) {
+        if (search_stopped(search)) continue;
+        RowWorker worker = {{0}, 0, depth};
+        memcpy(worker.chosen, &prefixes[p * ROWS_MAX_N], sizeof(worker.chosen));
+        search_from(search, &worker, depth);
+        check_budget(search, &worker);
+        bool complete = !search_stopped(search);
+#pragma omp critical(row_search_solution)
+        {
+            search->explored += complete;
+            if (worker.best_depth > search->best_depth) search->best_depth = worker.best_depth;
+        }
+    }
+
+    stats->strategy = threads > 1 && count > 1 ? STRATEGY_DEEP : STRATEGY_SEQUENTIAL;
+    stats->threads_used = count > 1 ? threads : 1;
+    stats->tasks_per_thread = (count + threads - 1) / threads;
+    stats->frontier_total = count;
+    stats->frontier_explored = search->explored;
+    stats->nodes = search->nodes;
+    stats->solutions = search->solutions;
+    stats->found_solution = search->found;
+    stats->best_depth = search->best_depth * n;
+    stats->status = search->stop && search->stop_status != SOLVER_SOLVED
+                        ? search->stop_status
+                        : (search->found ? SOLVER_SOLVED : SOLVER_UNSATISFIABLE);
+    if (search->found) {
+        for (int d = 0; d < n; d++) {
+            int row = search->order[d];
+            const RowPermutation* perm = &search->tables[row].perms[search->first_solution[d]];
+            for (int c = 0; c < n; c++) solution[row][c] = perm->value[c];
+        }
+    }
+    stats->coloring_time = timer_now() - start;
+
+    bool found = search->found;
+    free(prefixes);
+    free_tables(search);
+    free(search);
+    log_flush();
+    return found;
+}
+
+SolverStats solve_puzzle_rows(const char* filename, bool use_precoloring, bool print_solution) {
+    SolverStats stats = {0};
+    stats.status = SOLVER_ERROR;
+    Futoshiki* puzzle = malloc(sizeof(Futoshiki));
+    if (!puzzle || !read_puzzle_from_file(filename, puzzle)) {
+        free(puzzle);
+        return stats;
+    }
+
+    double start_precolor = timer_now();
+    stats.colors_removed = compute_pc_lists(puzzle, use_precoloring);
+    stats.precolor_time = timer_now() - start_precolor;
+    int n = puzzle->size;
+    for (int row = 0; row < n; row++) {
+        for (int col = 0; col < n; col++) stats.remaining_colors += puzzle->pc_lengths[row][col];
+    }
+    stats.total_processed = n * n * n;
+
+    int solution[MAX_N][MAX_N] = {{0}};
+    bool solved = row_search_puzzle(puzzle, solution, &stats);
+    stats.total_time = stats.precolor_time + stats.coloring_time;
+
+    if (print_solution) {
+        if (solved) {
+            printf("Solution:\n");
+            print_board(puzzle, solution);
+        } else {
+            printf("No solution found (%s).\n", solver_status_name(stats.status));
+        }
+    }
+    free(puzzle);
+    return stats;
+}
@@ -0,0 +1,27 @@
+#ifndef ROWSEARCH_H
+#define ROWSEARCH_H
+
+#include <stdbool.h>
+
+#include "comparison.h"
+#include "futoshiki.h"
+
+// Row-at-a-time search for boards up to ROWS_MAX_N. Every row's candidates (the permutations
+// that fit its possible colors and horizontal inequalities) are enumerated up front, one row
+// per thread. Each candidate carries bitmasks over (column, color) pairs: the pairs it takes,
+// and the pairs its vertical inequalities rule out in the rows above and below. Placing a row
+// is then one mask test per candidate instead of a safe() call per cell. Rows are searched
+// smallest table first; the prefixes of the first rows are the parallel tasks.
+
+#define ROWS_MAX_N 10                  // 10 * 10 (column, color) pairs fit in two words
+#define ROWS_MAX_PERMUTATIONS (1 << 19)  // Per row; larger tables fall back to search_puzzle
+
+// Search a pre-colored puzzle by rows; honors the solver limits and count mode and fills the
+// same fields of `stats` as search_puzzle. Puzzles whose tables do not fit are handed to
+// search_puzzle. Returns whether `solution` holds a solution.
+bool row_search_puzzle(Futoshiki* puzzle, int solution[MAX_N][MAX_N], SolverStats* stats);
+
+// As solve_puzzle, with the row search instead of the cell search
+SolverStats solve_puzzle_rows(const char* filename, bool use_precoloring, bool print_solution);
+
+#endif  // ROWSEARCH_H
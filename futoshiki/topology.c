@@ -0,0 +1,202 @@
+#define _GNU_SOURCE  // sched_setaffinity, sched_getcpu and the CPU_* macros
+
+#include "topology.h"
+
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SYSFS_CPU "/sys/devices/system/cpu"
+#define SYSFS_NODE "/sys/devices/system/node"
+#define MAX_NUMA_NODES 64
+
+static bool read_int(const char* path, int* value) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    bool ok = fscanf(file, "%d", value) == 1;
+    fclose(file);
+    return ok;
+}
+
+static bool read_line(const char* path, char* buffer, int size) {
+    FILE* file = fopen(path, "r");
+    if (!file) return false;
+    bool ok = fgets(buffer, size, file) != NULL;
+    fclose(file);
+    return ok;
+}
+
+// Number of CPUs in a sysfs cpulist ("0-3,8,10-11") that are smaller than `cpu`, or -1 if
+// `cpu` is not part of the list
+static int cpulist_rank(const char* list, int cpu) {
+    int rank = 0;
+    bool found = false;
+    const char* p = list;
+    while (*p) {
+        char* end;
+        int first = (int)strtol(p, &end, 10);
+        if (end == p) break;
+        int last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = (int)strtol(p, &end, 10);
+        }
+        if (cpu >= first && cpu <= last) found = true;
+        if (first < cpu) rank += (cpu <= last ? cpu : last + 1) - first;
+        p = (*end == ',') ? end + 1 : end;
+        if (*p == '\n') break;
+    }
+    return found ? rank : -1;
+}
+
+static int compare_placement(const void* a, const void* b) {
+    const CpuInfo* x = a;
+    const CpuInfo* y = b;
+    if (x->smt != y->smt) return x->smt - y->smt;
+    if (x->numa_node != y->numa_node) return x->numa_node - y->numa_node;
+    if (x->socket != y->socket) return x->socket - y->socket;
+    if (x->core != y->core) return x->core - y->core;
+    return x->cpu - y->cpu;
+}
+
+bool topology_discover(Topology* topo) {
+    memset(topo, 0, sizeof(*topo));
+
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return false;
+
+    // NUMA node cpulists; machines without the node directory are a single node
+    char node_lists[MAX_NUMA_NODES][1024];
+    int num_node_ids = 0;
+    for (int node = 0; node < MAX_NUMA_NODES; node++) {
+        char path[128];
+        snprintf(path, sizeof(path), SYSFS_NODE "/node%d/cpulist", node);
+        if (!read_line(path, node_lists[node], sizeof(node_lists[node]))) {
+            node_lists[node][0] = '\0';
+        } else {
+            num_node_ids = node + 1;
+        }
+    }
+
+    topo->cpus = malloc(sizeof(CpuInfo) * CPU_SETSIZE);
+    int socket_core[CPU_SETSIZE][2];  // (socket, core_id) of every physical core seen
+    bool node_used[MAX_NUMA_NODES] = {false};
+    bool socket_used[CPU_SETSIZE] = {false};
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+
+        char path[128];
+        int socket = 0, core_id = cpu;
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/physical_package_id", cpu);
+        read_int(path, &socket);
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/core_id", cpu);
+        read_int(path, &core_id);
+        if (socket < 0 || socket >= CPU_SETSIZE) socket = 0;
+
+        char siblings[1024];
+        int smt = 0;
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/thread_siblings_list", cpu);
+        if (read_line(path, siblings, sizeof(siblings))) {
+            smt = cpulist_rank(siblings, cpu);
+            if (smt < 0) smt = 0;
+        }
+
+        int numa_node = 0;
+        for (int node = 0; node < num_node_ids; node++) {
+            if (node_lists[node][0] && cpulist_rank(node_lists[node], cpu) >= 0) {
+                numa_node = node;
+                break;
+            }
+        }
+
+        int core = 0;
+        while (core < topo->num_cores &&
+               (socket_core[core][0] != socket || socket_core[core][1] != core_id)) {
+            core++;
+        }
+        if (core == topo->num_cores) {
+            socket_core[core][0] = socket;
+            socket_core[core][1] = core_id;
+            topo->num_cores++;
+        }
+
+        CpuInfo* info = &topo->cpus[topo->num_cpus++];
+        info->cpu = cpu;
+        info->socket = socket;
+        info->numa_node = numa_node;
+        info->core = core;
+        info->smt = smt;
+
+        if (!node_used[numa_node]) topo->num_numa_nodes++;
+        if (!socket_used[socket]) topo->num_sockets++;
+        node_used[numa_node] = true;
+        socket_used[socket] = true;
+        if (smt + 1 > topo->smt_per_core) topo->smt_per_core = smt + 1;
+    }
+
+    if (topo->num_cpus == 0) {
+        topology_free(topo);
+        return false;
+    }
+
+    qsort(topo->cpus, topo->num_cpus, sizeof(CpuInfo), compare_placement);
+    return true;
+}
+
+void topology_free(Topology* topo) {
+    free(topo->cpus);
+    topo->cpus = NULL;
+    topo->num_cpus = 0;
+}
+
+void topology_print(const Topology* topo) {
+    printf("Sockets: %d, NUMA nodes: %d, cores: %d, hardware threads per core: %d\n",
+           topo->num_sockets, topo->num_numa_nodes, topo->num_cores, topo->smt_per_core);
+    printf("%-6s %-6s %-6s %-6s %-4s\n", "place", "cpu", "socket", "node", "core/smt");
+    for (int i = 0; i < topo->num_cpus; i++) {
+        const CpuInfo* info = &topo->cpus[i];
+        printf("%-6d %-6d %-6d %-6d %d/%d\n", i, info->cpu, info->socket, info->numa_node,
+               info->core, info->smt);
+    }
+}
+
+const CpuInfo* topology_thread_cpu(const Topology* topo, int thread) {
+    return &topo->cpus[thread % topo->num_cpus];
+}
+
+bool topology_pin_thread(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+struct CpuAffinity {
+    cpu_set_t set;
+};
+
+CpuAffinity* topology_save_affinity(void) {
+    CpuAffinity* affinity = malloc(sizeof(CpuAffinity));
+    if (affinity && sched_getaffinity(0, sizeof(affinity->set), &affinity->set) != 0) {
+        free(affinity);
+        return NULL;
+    }
+    return affinity;
+}
+
+void topology_restore_affinity(CpuAffinity* affinity) {
+    if (!affinity) return;
+    sched_setaffinity(0, sizeof(affinity->set), &affinity->set);
+    free(affinity);
+}
+
+int topology_current_cpu(void) { return sched_getcpu(); }
+
+int topology_numa_node_of(const Topology* topo, int cpu) {
+    for (int i = 0; i < topo->num_cpus; i++) {
+        if (topo->cpus[i].cpu == cpu) return topo->cpus[i].numa_node;
+    }
+    return -1;
+}
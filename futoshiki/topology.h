@@ -0,0 +1,52 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <stdbool.h>
+
+typedef struct {
+    int cpu;        // Logical CPU id as used by the kernel
+    int socket;     // Physical package
+    int numa_node;  // NUMA node the CPU belongs to
+    int core;       // Index of the physical core (unique over all sockets)
+    int smt;        // Index of this hardware thread among the siblings of its core
+} CpuInfo;
+
+// CPUs this process may run on, read from sysfs and ordered for placement: first hardware
+// thread of every core before any SMT sibling, grouped by NUMA node (like OMP_PROC_BIND=close
+// with OMP_PLACES=cores)
+typedef struct {
+    int num_cpus;
+    int num_sockets;
+    int num_numa_nodes;
+    int num_cores;
+    int smt_per_core;  // Hardware threads per core (maximum)
+    CpuInfo* cpus;
+} Topology;
+
+bool topology_discover(Topology* topo);
+
+void topology_free(Topology* topo);
+
+void topology_print(const Topology* topo);
+
+// CPU that OpenMP thread `thread` is placed on
+const CpuInfo* topology_thread_cpu(const Topology* topo, int thread);
+
+// Bind the calling thread to a single CPU
+bool topology_pin_thread(int cpu);
+
+// Affinity mask of the calling thread, saved before pinning it (NULL if it cannot be read)
+typedef struct CpuAffinity CpuAffinity;
+
+CpuAffinity* topology_save_affinity(void);
+
+// Give the calling thread the saved mask back and free it; NULL does nothing
+void topology_restore_affinity(CpuAffinity* affinity);
+
+// CPU the calling thread is running on right now (-1 if unknown)
+int topology_current_cpu(void);
+
+// NUMA node of a logical CPU (-1 if unknown)
+int topology_numa_node_of(const Topology* topo, int cpu);
+
+#endif  // TOPOLOGY_H
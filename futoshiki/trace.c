@@ -0,0 +1,114 @@
+#include "trace.h"
+
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+
+#define TRACE_BUFFER_EVENTS 65536  // Events kept per thread
+
+typedef struct {
+    double ts;         // Microseconds since trace_open
+    const char* name;  // String literal
+    char phase;        // 'B' (begin), 'E' (end) or 'i' (instant)
+    long long arg;     // Prefix index, node count, status, ...
+} TraceEvent;
+
+// One buffer per thread, padded so that counters of neighbouring threads do not share a line
+typedef struct {
+    TraceEvent* events;
+    long long dropped;
+    int count;
+    char padding[64 - sizeof(TraceEvent*) - sizeof(long long) - sizeof(int)];
+} TraceBuffer;
+
+static bool g_enabled = false;
+static char* g_path = NULL;
+static TraceBuffer* g_buffers = NULL;
+static int g_num_buffers = 0;
+static double g_start = 0.0;
+
+static double now_us(void) { return timer_now() * 1e6; }
+
+bool trace_open(const char* path, int max_threads) {
+    g_buffers = calloc(max_threads, sizeof(TraceBuffer));
+    g_path = malloc(strlen(path) + 1);
+    if (!g_buffers || !g_path) return false;
+    strcpy(g_path, path);
+
+    for (int t = 0; t < max_threads; t++) {
+        g_buffers[t].events = malloc(sizeof(TraceEvent) * TRACE_BUFFER_EVENTS);
+        if (!g_buffers[t].events) return false;
+    }
+    g_num_buffers = max_threads;
+    g_start = now_us();
+    g_enabled = true;
+    atexit(trace_close);
+    return true;
+}
+
+bool trace_enabled(void) { return g_enabled; }
+
+static void record(char phase, const char* name, long long arg) {
+    if (!g_enabled) return;
+
+    int thread = omp_get_thread_num();
+    if (thread >= g_num_buffers) return;
+
+    TraceBuffer* buffer = &g_buffers[thread];
+    if (buffer->count == TRACE_BUFFER_EVENTS) {
+        buffer->dropped++;
+        return;
+    }
+    TraceEvent* event = &buffer->events[buffer->count++];
+    event->ts = now_us() - g_start;
+    event->name = name;
+    event->phase = phase;
+    event->arg = arg;
+}
+
+void trace_begin(const char* name, long long arg) { record('B', name, arg); }
+
+void trace_end(const char* name, long long arg) { record('E', name, arg); }
+
+void trace_instant(const char* name, long long arg) { record('i', name, arg); }
+
+void trace_close(void) {
+    if (!g_enabled) return;
+    g_enabled = false;
+
+    FILE* file = fopen(g_path, "w");
+    if (!file) {
+        printf("Error: Could not write trace %s\n", g_path);
+    } else {
+        long long dropped = 0;
+        fprintf(file, "{\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+                      "\"args\":{\"name\":\"futoshiki\"}}");
+        for (int t = 0; t < g_num_buffers; t++) {
+            const TraceBuffer* buffer = &g_buffers[t];
+            dropped += buffer->dropped;
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,"
+                          "\"args\":{\"name\":\"thread %d\"}}", t, t);
+            for (int i = 0; i < buffer->count; i++) {
+                const TraceEvent* e = &buffer->events[i];
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":0,\"tid\":%d,",
+                        e->name, e->phase, e->ts, t);
+                if (e->phase == 'i') fprintf(file, "\"s\":\"t\",");
+                fprintf(file, "\"args\":{\"value\":%lld}}", e->arg);
+            }
+        }
+        fprintf(file, "\n],\"otherData\":{\"dropped_events\":%lld}}\n", dropped);
+        fclose(file);
+        printf("Trace written to %s\n", g_path);
+    }
+
+    for (int t = 0; t < g_num_buffers; t++) free(g_buffers[t].events);
+    free(g_buffers);
+    free(g_path);
+    g_buffers = NULL;
+    g_path = NULL;
+    g_num_buffers = 0;
+}
@@ -0,0 +1,26 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+
+// Per-thread event timeline written as Chrome/Perfetto trace JSON (chrome://tracing,
+// ui.perfetto.dev). Every OpenMP thread appends to its own buffer, so recording takes no locks;
+// events of threads beyond `max_threads` or beyond a full buffer are dropped and counted.
+// `name` must be a string literal (only the pointer is stored).
+
+// Start recording; the file is written when the program exits
+bool trace_open(const char* path, int max_threads);
+
+bool trace_enabled(void);
+
+// Duration events, must nest properly per thread
+void trace_begin(const char* name, long long arg);
+void trace_end(const char* name, long long arg);
+
+// Point event on the calling thread's timeline
+void trace_instant(const char* name, long long arg);
+
+// Write the JSON file and stop recording
+void trace_close(void);
+
+#endif  // TRACE_H
@@ -0,0 +1,158 @@
+#include "hierarchy.h"
+
+#include <stdlib.h>
+
+static int g_keyval = MPI_KEYVAL_INVALID;
+static int g_finalize_keyval = MPI_KEYVAL_INVALID;
+
+// Communicators that carry a hierarchy, released before MPI_Finalize
+static MPI_Comm* g_comms = NULL;
+static int g_num_comms = 0;
+
+static void free_window(Hierarchy* hierarchy) {
+    if (hierarchy->window == MPI_WIN_NULL) return;
+    MPI_Win_unlock_all(hierarchy->window);
+    MPI_Win_free(&hierarchy->window);
+    hierarchy->base = NULL;
+    hierarchy->size = 0;
+}
+
+static void free_hierarchy(Hierarchy* hierarchy) {
+    free_window(hierarchy);
+    if (hierarchy->leader_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&hierarchy->leader_comm);
+    }
+    if (hierarchy->node_comm != MPI_COMM_NULL) {
+        MPI_Comm_free(&hierarchy->node_comm);
+    }
+    free(hierarchy->node_of);
+    free(hierarchy);
+}
+
+// Called by MPI when the communicator is freed
+static int delete_hierarchy(MPI_Comm comm, int keyval, void* attribute,
+                            void* extra_state) {
+    (void)keyval;
+    (void)extra_state;
+    for (int c = 0; c < g_num_comms; c++) {
+        if (g_comms[c] == comm) g_comms[c] = g_comms[--g_num_comms];
+    }
+    free_hierarchy(attribute);
+    return MPI_SUCCESS;
+}
+
+// MPI_Finalize deletes the attributes of MPI_COMM_SELF first, while the
+// windows and communicators can still be freed; the attributes of
+// MPI_COMM_WORLD would only be deleted after that, if at all
+static int finalize_hierarchies(MPI_Comm comm, int keyval, void* attribute,
+                                void* extra_state) {
+    (void)comm;
+    (void)keyval;
+    (void)attribute;
+    (void)extra_state;
+    while (g_num_comms > 0) {
+        int last = g_num_comms;
+        MPI_Comm_delete_attr(g_comms[g_num_comms - 1], g_keyval);
+        if (g_num_comms == last) break;  // not deleted, do not spin
+    }
+    free(g_comms);
+    g_comms = NULL;
+    return MPI_SUCCESS;
+}
+
+static int register_keyvals(void) {
+    int err = MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, delete_hierarchy,
+                                     &g_keyval, NULL);
+    if (err != MPI_SUCCESS) return err;
+    err = MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, finalize_hierarchies,
+                                 &g_finalize_keyval, NULL);
+    if (err != MPI_SUCCESS) return err;
+    return MPI_Comm_set_attr(MPI_COMM_SELF, g_finalize_keyval, NULL);
+}
+
+static int create_hierarchy(MPI_Comm comm, Hierarchy* hierarchy) {
+    int n_processes = 0, id = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Comm_rank(comm, &id);
+
+    int err = MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, id,
+                                  MPI_INFO_NULL, &hierarchy->node_comm);
+    if (err != MPI_SUCCESS) return err;
+    MPI_Comm_rank(hierarchy->node_comm, &hierarchy->node_rank);
+    MPI_Comm_size(hierarchy->node_comm, &hierarchy->node_size);
+
+    err = MPI_Comm_split(comm, hierarchy->node_rank == 0 ? 0 : MPI_UNDEFINED,
+                         id, &hierarchy->leader_comm);
+    if (err != MPI_SUCCESS) return err;
+
+    // Every rank learns its node's index among the leaders, then all of them
+    int node = 0;
+    if (hierarchy->leader_comm != MPI_COMM_NULL) {
+        MPI_Comm_rank(hierarchy->leader_comm, &node);
+        MPI_Comm_size(hierarchy->leader_comm, &hierarchy->n_nodes);
+    }
+    MPI_Bcast(&node, 1, MPI_INT, 0, hierarchy->node_comm);
+    MPI_Bcast(&hierarchy->n_nodes, 1, MPI_INT, 0, hierarchy->node_comm);
+
+    hierarchy->node_of = malloc(sizeof(int) * n_processes);
+    if (!hierarchy->node_of) return MPI_ERR_NO_MEM;
+    return MPI_Allgather(&node, 1, MPI_INT, hierarchy->node_of, 1, MPI_INT,
+                         comm);
+}
+
+int hierarchy_get(MPI_Comm comm, Hierarchy** hierarchy) {
+    int err = MPI_SUCCESS, found = 0;
+    if (g_keyval == MPI_KEYVAL_INVALID) {
+        err = register_keyvals();
+        if (err != MPI_SUCCESS) return err;
+    }
+    err = MPI_Comm_get_attr(comm, g_keyval, hierarchy, &found);
+    if (err != MPI_SUCCESS || found) return err;
+
+    Hierarchy* created = calloc(1, sizeof(Hierarchy));
+    MPI_Comm* comms = realloc(g_comms, sizeof(MPI_Comm) * (g_num_comms + 1));
+    if (comms) g_comms = comms;
+    if (!created || !comms) {
+        free(created);
+        return MPI_ERR_NO_MEM;
+    }
+    created->node_comm = MPI_COMM_NULL;
+    created->leader_comm = MPI_COMM_NULL;
+    created->window = MPI_WIN_NULL;
+    err = create_hierarchy(comm, created);
+    if (err == MPI_SUCCESS) err = MPI_Comm_set_attr(comm, g_keyval, created);
+    if (err != MPI_SUCCESS) {
+        free_hierarchy(created);
+        return err;
+    }
+    g_comms[g_num_comms++] = comm;
+    *hierarchy = created;
+    return MPI_SUCCESS;
+}
+
+int hierarchy_reserve(Hierarchy* hierarchy, MPI_Aint bytes) {
+    if (hierarchy->size >= bytes) return MPI_SUCCESS;
+    free_window(hierarchy);
+
+    // The leader allocates everything, so the window is one contiguous
+    // block that the others map through MPI_Win_shared_query
+    char* own = NULL;
+    int err = MPI_Win_allocate_shared(hierarchy->node_rank == 0 ? bytes : 0,
+                                      1, MPI_INFO_NULL, hierarchy->node_comm,
+                                      &own, &hierarchy->window);
+    if (err != MPI_SUCCESS) return err;
+    int displacement_unit = 0;
+    err = MPI_Win_shared_query(hierarchy->window, 0, &hierarchy->size,
+                               &displacement_unit, &hierarchy->base);
+    if (err != MPI_SUCCESS) return err;
+    // One passive epoch for the whole lifetime; hierarchy_sync orders the
+    // direct loads and stores within it
+    return MPI_Win_lock_all(MPI_MODE_NOCHECK, hierarchy->window);
+}
+
+int hierarchy_sync(const Hierarchy* hierarchy) {
+    MPI_Win_sync(hierarchy->window);
+    int err = MPI_Barrier(hierarchy->node_comm);
+    MPI_Win_sync(hierarchy->window);
+    return err;
+}
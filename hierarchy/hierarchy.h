@@ -0,0 +1,35 @@
+#ifndef HIERARCHY_H
+#define HIERARCHY_H
+
+#include <mpi.h>
+
+// Two-level view of a communicator for the hierarchical collectives: the
+// ranks sharing memory on every node (MPI_Comm_split_type SHARED), one
+// leader per node (node rank 0) and an MPI-3 shared-memory window that all
+// ranks of a node load from and store to directly. It is created on first
+// use and cached as an attribute of the communicator, so it lives until
+// MPI_Comm_free or MPI_Finalize.
+typedef struct {
+    MPI_Comm node_comm;
+    MPI_Comm leader_comm;  // the node leaders; MPI_COMM_NULL elsewhere
+    int node_rank;
+    int node_size;
+    int n_nodes;
+    int* node_of;   // leader_comm rank of the node of every rank of comm
+    MPI_Win window;  // owned by the leader; MPI_WIN_NULL until reserved
+    char* base;      // the window as seen by this rank
+    MPI_Aint size;
+} Hierarchy;
+
+// The hierarchy of `comm`; collective over `comm` on the first call
+int hierarchy_get(MPI_Comm comm, Hierarchy** hierarchy);
+
+// Grow the window to at least `bytes`; collective over the node, every
+// rank of a node must ask for the same size
+int hierarchy_reserve(Hierarchy* hierarchy, MPI_Aint bytes);
+
+// Node barrier that also orders the loads and stores to the window: what a
+// rank stored before the call is visible to every rank of the node after
+int hierarchy_sync(const Hierarchy* hierarchy);
+
+#endif  // HIERARCHY_H
@@ -0,0 +1,116 @@
+#include <inttypes.h>
+#include <math.h>
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "pi_montecarlo.h"
+
+// Monte Carlo pi on MPI ranks with OpenMP threads each (pi_montecarlo.c),
+// for 1, 2, 4, ... threads per rank up to the maximum.
+//
+//   montecarlo [-n samples] [-s seed] [-t max threads per rank]
+//
+// Rank r counts the hits of its contiguous share of the samples and
+// MPI_Reduce sums them on rank 0. Times are those of the slowest rank;
+// throughput is in millions of samples per second and per core (ranks x
+// threads). "same" tells whether the hits equal those on one thread per
+// rank; the hits of a seed and sample count are also the same for any
+// number of ranks, so runs of different sizes can be compared.
+
+#define DEFAULT_SAMPLES 10000000000ULL
+#define DEFAULT_SEED 20240601ULL
+#define PI 3.14159265358979323846
+
+// 1, 2, 4, ... and max_threads itself
+static int next_thread_count(int threads, int max_threads) {
+    if (threads < max_threads && 2 * threads > max_threads) {
+        return max_threads;
+    }
+    return 2 * threads;
+}
+
+int main(int argc, char* argv[]) {
+    int n_processes = 0;
+    int id = 0;
+    uint64_t n = DEFAULT_SAMPLES;
+    uint64_t seed = DEFAULT_SEED;
+    int max_threads = omp_get_max_threads();
+
+    // Only the master thread calls MPI, outside the parallel regions
+    int provided = MPI_THREAD_SINGLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    if (provided < MPI_THREAD_FUNNELED) {
+        if (id == 0) {
+            printf("Error: MPI does not support MPI_THREAD_FUNNELED\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    timer_init(TIMER_MPI);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        }
+    }
+    if (n < 1) n = DEFAULT_SAMPLES;
+    if (max_threads < 1) max_threads = omp_get_max_threads();
+
+    // Share of this rank, exact in 128 bits
+    uint64_t first = (uint64_t)((unsigned __int128)n * id / n_processes);
+    uint64_t last =
+        (uint64_t)((unsigned __int128)n * (id + 1) / n_processes);
+
+    if (id == 0) {
+        printf("Monte Carlo pi: %" PRIu64 " samples, seed %" PRIu64
+               ", %d processes\n",
+               n, seed, n_processes);
+        printf("throughput in Msamples/s per core\n\n");
+        printf("%8s %8s %12s %12s %20s %18s %12s %5s\n", "threads", "cores",
+               "time [s]", "throughput", "hits", "pi", "error", "same");
+    }
+    pi_montecarlo_hits(seed, first, 1000000, max_threads);  // thread pool
+
+    uint64_t reference = 0;
+    int failed = 0;
+    for (int t = 1; t <= max_threads; t = next_thread_count(t, max_threads)) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = timer_now();
+        uint64_t local = pi_montecarlo_hits(seed, first, last - first, t);
+        double time = timer_now() - start, slowest = 0;
+
+        uint64_t hits = 0;
+        MPI_Reduce(&local, &hits, 1, MPI_UINT64_T, MPI_SUM, 0,
+                   MPI_COMM_WORLD);
+        MPI_Reduce(&time, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0,
+                   MPI_COMM_WORLD);
+        if (id != 0) continue;
+
+        if (t == 1) reference = hits;
+        int same = hits == reference;
+        failed |= !same;
+        int cores = n_processes * t;
+        double pi = 4.0 * (double)hits / (double)n;
+        printf("%8d %8d %12.4f %12.1f %20" PRIu64 " %18.15f %12.3e %5s\n", t,
+               cores, slowest, (double)n / slowest / cores * 1e-6, hits, pi,
+               pi - PI, same ? "yes" : "NO");
+        fflush(stdout);
+    }
+    if (id == 0) {
+        printf("\nexpected error (one standard deviation): %.3e\n",
+               sqrt(PI * (4.0 - PI) / (double)n));
+    }
+
+    MPI_Bcast(&failed, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    MPI_Finalize();
+    return failed;
+}
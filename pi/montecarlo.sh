@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o one rank per chunk with 8 OpenMP threads, then the same samples on a
+#   single rank: the hits must match those of the first run exactly
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:30:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=4:ncpus=8:mem=1gb
+
+# get dependencies
+module load mpich-3.2
+# build
+mpicc ~/hpc/pi/montecarlo.c ~/hpc/pi/pi_montecarlo.c ~/hpc/timing/timer.c -DTIMER_WITH_MPI -fopenmp -O3 -march=native -Wall -std=c99 -o ~/hpc/pi/montecarlo -lm
+# run
+export OMP_NUM_THREADS=8
+export OMP_PROC_BIND=close
+export OMP_PLACES=cores
+mpirun.actual -n 4 ~/hpc/pi/montecarlo -n 100000000000
+mpirun.actual -n 1 ~/hpc/pi/montecarlo -n 100000000000 -t 8
\ No newline at end of file
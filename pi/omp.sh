@@ -16,7 +16,7 @@
 module load openmpi-4.0.4
 # build
 # mpicc ~/hpc/pi/omp.c -g -Wall -std=c99 -o ~/hpc/pi/omp
-gcc ~/hpc/pi/omp.c -g -Wall -fopenmp -std=c99 -o ~/hpc/pi/omp
+gcc ~/hpc/pi/omp.c ~/hpc/pi/pi_series.c ~/hpc/timing/timer.c -g -Wall -fopenmp -std=c99 -O2 -o ~/hpc/pi/omp -lm
 # run
 # mpirun.actual -n 4 ~/hpc/pi/omp
 ~/hpc/pi/omp 4
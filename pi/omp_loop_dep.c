@@ -3,6 +3,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../timing/timer.h"
+
 double calculate_pi(int n_terms, int n_threads) {
     double factor = 1.0;
     double sum = 0.0;
@@ -25,11 +27,14 @@ int main() {
 
     printf("Calculating π using %d threads...\n", n_threads);
 
+    double start = timer_now();
     double pi_approx = calculate_pi(n_terms, n_threads);
+    double elapsed = timer_now() - start;
 
     printf("Approximation of π: %.15f\n", pi_approx);
     printf("Actual value of π: 3.141592653589793\n");
     printf("Absolute error: %.15f\n", fabs(pi_approx - 3.141592653589793));
+    printf("Elapsed time: %.6f s\n", elapsed);
 
     return 0;
 }
\ No newline at end of file
@@ -16,7 +16,7 @@
 module load openmpi-4.0.4
 # build
 # mpicc ~/hpc/pi/omp_loop_dep.c -g -Wall -std=c99 -o ~/hpc/pi/omp_loop_dep
-gcc ~/hpc/pi/omp_loop_dep.c -g -Wall -fopenmp -std=c99 -o ~/hpc/pi/omp_loop_dep
+gcc ~/hpc/pi/omp_loop_dep.c ~/hpc/timing/timer.c -g -Wall -fopenmp -std=c99 -o ~/hpc/pi/omp_loop_dep -lm
 # run
 # mpirun.actual -n 4 ~/hpc/pi/omp_loop_dep
 ~/hpc/pi/omp_loop_dep 4
@@ -0,0 +1,49 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stdint.h>
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as
+// 1, 2, 3", SC 2011): a counter-based generator. Block `counter` of the
+// stream `key` is 4 random 32-bit words computed from the two alone, with
+// no state carried from one block to the next. Any thread can then
+// generate any part of the stream, in any order, and get the same numbers;
+// distinct counters or keys give independent blocks.
+//
+// The rounds only multiply, xor and add 32-bit words, so a loop over
+// consecutive counters vectorizes. Inline so that it can.
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u  // key increments between rounds
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+typedef struct {
+    uint32_t v[4];
+} PhiloxBlock;
+
+// Block `counter` (128 bits, the upper 64 zero) of the stream `key`
+static inline PhiloxBlock philox(uint64_t counter, uint64_t key) {
+    uint32_t c0 = (uint32_t)counter, c1 = (uint32_t)(counter >> 32);
+    uint32_t c2 = 0, c3 = 0;
+    uint32_t k0 = (uint32_t)key, k1 = (uint32_t)(key >> 32);
+
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t p0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t p1 = (uint64_t)PHILOX_M1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+
+    PhiloxBlock block = {{c0, c1, c2, c3}};
+    return block;
+}
+
+#endif  // PHILOX_H
@@ -0,0 +1,110 @@
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "pi_series.h"
+
+// Throughput and accuracy of pi_series against the plain loop it replaced
+// (one term per iteration, sign branch, naive reduction), for term counts
+// 10, 100, ... up to the maximum.
+//
+//   pi_bench [-m max terms] [-r repetitions] [-t threads]
+//
+// Times are medians over the repetitions; throughput is in millions of
+// terms per second and per thread. The truncation error of the series is
+// about 1/n, so n * error stays near +-1 as long as rounding does not
+// dominate. "same" tells whether pi_series gives bit-identical results on
+// one thread and on all of them.
+
+#define DEFAULT_MAX_TERMS 10000000000LL
+#define DEFAULT_REPETITIONS 5
+#define PI 3.14159265358979323846
+
+typedef struct {
+    double (*kernel)(long long, int);
+    long long n_terms;
+    int n_threads;
+    double result;
+} Run;
+
+static double naive_series(long long n_terms, int n_threads) {
+    double sum = 0.0;
+
+#pragma omp parallel for num_threads(n_threads) reduction(+ : sum)
+    for (long long alternate = 0; alternate < n_terms; alternate++) {
+        double factor = 1.0 / (2.0 * alternate + 1);
+        if (alternate % 2 != 0) {
+            factor = -factor;
+        }
+        sum += factor;
+    }
+
+    return 4.0 * sum;
+}
+
+static void run(void* arg) {
+    Run* r = arg;
+    r->result = r->kernel(r->n_terms, r->n_threads);
+    timer_escape(&r->result);
+}
+
+// Median time of `repetitions` runs; the last result is left in r->result
+static double median_time(Run* r, int repetitions) {
+    TimerStats stats = timer_repeat(run, r, 0, repetitions);
+    return stats.median;
+}
+
+// Millions of terms per second and thread; 0 when below the timer overhead
+static double throughput(long long n_terms, double time, int n_threads) {
+    return time > 0 ? n_terms / time / n_threads * 1e-6 : 0.0;
+}
+
+int main(int argc, char* argv[]) {
+    long long max_terms = DEFAULT_MAX_TERMS;
+    int repetitions = DEFAULT_REPETITIONS;
+    int n_threads = omp_get_max_threads();
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_terms = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            n_threads = atoi(argv[++i]);
+        }
+    }
+    if (max_terms < 1 || max_terms > PI_SERIES_MAX_TERMS) {
+        max_terms = DEFAULT_MAX_TERMS;
+    }
+    if (repetitions < 1) repetitions = DEFAULT_REPETITIONS;
+    if (n_threads < 1) n_threads = omp_get_max_threads();
+    timer_init(TIMER_TSC);
+
+    printf("pi series: %d threads, median of %d runs, timer %s\n", n_threads,
+           repetitions, timer_source_name(timer_source()));
+    printf("throughput in Mterms/s per thread\n\n");
+    printf("%14s %12s %12s %12s %10s %5s %12s %12s\n", "terms", "time [s]",
+           "throughput", "error", "n * error", "same", "naive thrpt",
+           "naive error");
+
+    pi_series(1000000, n_threads);  // start the thread pool
+    for (long long n = 10; n <= max_terms; n *= 10) {
+        Run series = {pi_series, n, n_threads, 0.0};
+        Run naive = {naive_series, n, n_threads, 0.0};
+        double time = median_time(&series, repetitions);
+        double naive_time = median_time(&naive, repetitions);
+        double serial = pi_series(n, 1);
+        int same = memcmp(&serial, &series.result, sizeof(double)) == 0;
+
+        double error = series.result - PI;
+        printf("%14lld %12.6f %12.1f %12.3e %10.4f %5s %12.1f %12.3e\n", n,
+               time, throughput(n, time, n_threads), error, n * error,
+               same ? "yes" : "NO", throughput(n, naive_time, n_threads),
+               naive.result - PI);
+        fflush(stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o one thread per core; the serial determinism check runs 1e10 terms alone
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:10:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=8:mem=1gb
+
+# get dependencies
+module load openmpi-4.0.4
+# build
+gcc ~/hpc/pi/pi_bench.c ~/hpc/pi/pi_series.c ~/hpc/timing/timer.c -O3 -march=native -Wall -fopenmp -std=c99 -o ~/hpc/pi/pi_bench -lm
+# run
+export OMP_NUM_THREADS=8
+~/hpc/pi/pi_bench
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "pi_montecarlo.h"
+
+#include <omp.h>
+
+#include "philox.h"
+
+#define BATCH 256               // Philox blocks generated before testing
+#define CHUNK_SAMPLES (1 << 22)  // samples per scheduled chunk
+#define RADIUS_SQUARED (1LL << 62)  // (2^31)^2
+
+// Point (x, y) in [0, 2^31)^2 from two random words; x^2 + y^2 < 2^63
+static int in_circle(uint32_t a, uint32_t b) {
+    int64_t x = a >> 1, y = b >> 1;
+    return x * x + y * y < RADIUS_SQUARED;
+}
+
+// Sample i alone: half of block i / 2
+static int sample_hit(uint64_t seed, uint64_t i) {
+    PhiloxBlock block = philox(i / 2, seed);
+    return i % 2 ? in_circle(block.v[2], block.v[3])
+                 : in_circle(block.v[0], block.v[1]);
+}
+
+// Hits of the samples of blocks [first, first + count), count <= BATCH
+static uint64_t batch_hits(uint64_t seed, uint64_t first, int count) {
+    uint32_t words[4][BATCH];
+#pragma omp simd
+    for (int j = 0; j < count; j++) {
+        PhiloxBlock block = philox(first + j, seed);
+        words[0][j] = block.v[0];
+        words[1][j] = block.v[1];
+        words[2][j] = block.v[2];
+        words[3][j] = block.v[3];
+    }
+
+    uint64_t hits = 0;
+#pragma omp simd reduction(+ : hits)
+    for (int j = 0; j < count; j++) {
+        hits += in_circle(words[0][j], words[1][j]) +
+                in_circle(words[2][j], words[3][j]);
+    }
+    return hits;
+}
+
+// Hits of the samples [first, last) on the calling thread
+static uint64_t range_hits(uint64_t seed, uint64_t first, uint64_t last) {
+    uint64_t hits = 0;
+    if (first < last && first % 2) hits += sample_hit(seed, first++);
+    if (first < last && last % 2) hits += sample_hit(seed, --last);
+
+    // Whole blocks remain
+    for (uint64_t k = first / 2; k < last / 2; k += BATCH) {
+        uint64_t left = last / 2 - k;
+        hits += batch_hits(seed, k, left < BATCH ? (int)left : BATCH);
+    }
+    return hits;
+}
+
+uint64_t pi_montecarlo_hits(uint64_t seed, uint64_t first, uint64_t count,
+                            int n_threads) {
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+    long long n_chunks = (long long)((count + CHUNK_SAMPLES - 1) /
+                                     CHUNK_SAMPLES);
+    uint64_t hits = 0;
+
+    // Integer sums: the result is the same in any order
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic) \
+    reduction(+ : hits)
+    for (long long c = 0; c < n_chunks; c++) {
+        uint64_t start = first + (uint64_t)c * CHUNK_SAMPLES;
+        uint64_t end = (uint64_t)(c + 1) * CHUNK_SAMPLES < count
+                           ? first + (uint64_t)(c + 1) * CHUNK_SAMPLES
+                           : first + count;
+        hits += range_hits(seed, start, end);
+    }
+    return hits;
+}
@@ -0,0 +1,22 @@
+#ifndef PI_MONTECARLO_H
+#define PI_MONTECARLO_H
+
+#include <stdint.h>
+
+// Monte Carlo estimate of pi: sample i of the stream `seed` is a point of
+// the unit square, and pi ~ 4 * hits / samples for the points that fall in
+// the quarter circle.
+//
+// The points come from Philox (philox.h): block k of the stream `seed`
+// gives samples 2k and 2k + 1, with 31-bit coordinates each, and the hit
+// test is exact in 64-bit integers. Every sample is thus fixed by its
+// index, and the hits of a range do not depend on how it is split: the
+// same across threads and MPI ranks, bit for bit.
+
+// Hits among the samples [first, first + count) on `n_threads` OpenMP
+// threads (0 = omp_get_max_threads()). The blocks are generated and tested
+// in batches of SIMD lanes.
+uint64_t pi_montecarlo_hits(uint64_t seed, uint64_t first, uint64_t count,
+                            int n_threads);
+
+#endif  // PI_MONTECARLO_H
@@ -0,0 +1,72 @@
+#include "pi_series.h"
+
+#include <omp.h>
+
+#define LANES 8                  // independent partial sums per chunk
+#define MAX_CHUNKS 1024          // chunk sums kept for the final combination
+#define MIN_CHUNK_PAIRS 4096     // smaller inputs use fewer chunks
+
+typedef struct {
+    double sum;
+    double compensation;  // low-order bits lost by sum, to subtract
+} Kahan;
+
+static void kahan_add(Kahan* kahan, double x) {
+    double y = x - kahan->compensation;
+    double t = kahan->sum + y;
+    kahan->compensation = (t - kahan->sum) - y;
+    kahan->sum = t;
+}
+
+// Sum of the pairs [first, last); pair k is 2/((4k+1)(4k+3))
+static double sum_pairs(long long first, long long last) {
+    double sum[LANES] = {0}, compensation[LANES] = {0};
+    double denominator = 4.0 * (double)first + 1.0;  // 4k+1, exact
+    long long k = first;
+
+    for (; k + LANES <= last; k += LANES) {
+#pragma omp simd
+        for (int l = 0; l < LANES; l++) {
+            double d = denominator + 4.0 * l;
+            double y = 2.0 / (d * (d + 2.0)) - compensation[l];
+            double t = sum[l] + y;
+            compensation[l] = (t - sum[l]) - y;
+            sum[l] = t;
+        }
+        denominator += 4.0 * LANES;
+    }
+
+    Kahan total = {0.0, 0.0};
+    for (int l = LANES - 1; l >= 0; l--) {
+        kahan_add(&total, sum[l]);
+        kahan_add(&total, -compensation[l]);
+    }
+    for (; k < last; k++) {
+        denominator = 4.0 * (double)k + 1.0;
+        kahan_add(&total, 2.0 / (denominator * (denominator + 2.0)));
+    }
+    return total.sum - total.compensation;
+}
+
+double pi_series(long long n_terms, int n_threads) {
+    if (n_terms <= 0 || n_terms > PI_SERIES_MAX_TERMS) return 0.0;
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+
+    long long n_pairs = n_terms / 2;
+    long long n_chunks = (n_pairs + MIN_CHUNK_PAIRS - 1) / MIN_CHUNK_PAIRS;
+    if (n_chunks > MAX_CHUNKS) n_chunks = MAX_CHUNKS;
+    if (n_chunks < 1) n_chunks = 1;
+    double chunks[MAX_CHUNKS];
+
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic)
+    for (long long c = 0; c < n_chunks; c++) {
+        chunks[c] = sum_pairs(n_pairs * c / n_chunks,
+                              n_pairs * (c + 1) / n_chunks);
+    }
+
+    // The tail holds the smallest terms: add it first
+    Kahan total = {0.0, 0.0};
+    if (n_terms % 2) kahan_add(&total, 1.0 / (4.0 * (double)n_pairs + 1.0));
+    for (long long c = n_chunks - 1; c >= 0; c--) kahan_add(&total, chunks[c]);
+    return 4.0 * (total.sum - total.compensation);
+}
@@ -0,0 +1,22 @@
+#ifndef PI_SERIES_H
+#define PI_SERIES_H
+
+// Largest term count: the denominators are counted in doubles, which stay
+// exact up to 2^53
+#define PI_SERIES_MAX_TERMS (1LL << 52)
+
+// 4 * (1 - 1/3 + 1/5 - ...) over the first `n_terms` terms (Leibniz series)
+// on `n_threads` OpenMP threads (0 = omp_get_max_threads()).
+//
+// Consecutive terms are added in pairs, 1/(4k+1) - 1/(4k+3) =
+// 2/((4k+1)(4k+3)), so the loop has no sign branch, no cancellation and one
+// division per pair; it runs in independent SIMD lanes with Kahan
+// compensation. The terms are cut into chunks that depend only on n_terms
+// and the chunk sums are combined in chunk order, so the result is
+// bit-identical for any thread count. Build without -ffast-math, which
+// would optimize the compensation away.
+//
+// Returns 0 for n_terms <= 0 or above PI_SERIES_MAX_TERMS.
+double pi_series(long long n_terms, int n_threads);
+
+#endif  // PI_SERIES_H
@@ -1,44 +1,51 @@
 #include <mpi.h>
 #include <stdio.h>
 
+#include "../timing/timer.h"
+
+// Bounces a counter between pairs of processes until it reaches 0. Nothing
+// is printed inside the loop, so the reported time is the exchange itself;
+// see pingpong_bench.c for proper latency and bandwidth measurements.
+
 int main() {
     int n_processes = 0;
     int id = 0;
     int v = 19;
+    int exchanges = 0;
 
     MPI_Init(NULL, NULL);
     MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
     MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    timer_init(TIMER_MPI);
 
     if ((n_processes % 2 == 0) || (id != n_processes - 1)) {
+        int partner = id % 2 == 0 ? id + 1 : id - 1;
+        double start = timer_now();
+
         if (id % 2 == 0) {
             while (v > 0) {
-                MPI_Recv(&v, 1, MPI_INT, id + 1, 0, MPI_COMM_WORLD,
+                MPI_Recv(&v, 1, MPI_INT, partner, 0, MPI_COMM_WORLD,
                          MPI_STATUS_IGNORE);
-                printf("received value %d from process %d on process %d\n", v,
-                       id + 1, id);
-
                 v--;
-
-                MPI_Send(&v, 1, MPI_INT, id + 1, 0, MPI_COMM_WORLD);
-                printf("send value %d from process %d to process %d\n", v, id,
-                       id + 1);
+                MPI_Send(&v, 1, MPI_INT, partner, 0, MPI_COMM_WORLD);
+                exchanges++;
             }
 
         } else {
             while (v > 0) {
-                MPI_Send(&v, 1, MPI_INT, id - 1, 0, MPI_COMM_WORLD);
-                printf("send value %d from process %d to process %d\n", v, id,
-                       id - 1);
-
-                MPI_Recv(&v, 1, MPI_INT, id - 1, 0, MPI_COMM_WORLD,
+                MPI_Send(&v, 1, MPI_INT, partner, 0, MPI_COMM_WORLD);
+                MPI_Recv(&v, 1, MPI_INT, partner, 0, MPI_COMM_WORLD,
                          MPI_STATUS_IGNORE);
-                printf("received value %d from process %d on process %d\n", v,
-                       id - 1, id);
-
                 v--;
+                exchanges++;
             }
         }
+
+        double elapsed = timer_now() - start;
+        printf("process %d: %d round trips with process %d in %.2f us "
+               "(%.2f us each)\n",
+               id, exchanges, partner, elapsed * 1e6,
+               elapsed * 1e6 / exchanges);
     } else {
         printf("process %d is not doing anything\n", id);
     }
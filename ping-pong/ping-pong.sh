@@ -14,6 +14,6 @@
 # get dependencies
 module load mpich-3.2
 # build
-mpicc ~/hpc/ping-pong/ping-pong.c -g -Wall -std=c99 -o ~/hpc/ping-pong/ping-pong
+mpicc ~/hpc/ping-pong/ping-pong.c ~/hpc/timing/timer.c -DTIMER_WITH_MPI -g -Wall -std=c99 -o ~/hpc/ping-pong/ping-pong -lm
 # run
 mpirun.actual -n 2 ~/hpc/ping-pong/ping-pong
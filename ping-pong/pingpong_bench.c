@@ -0,0 +1,419 @@
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+
+// Point-to-point microbenchmarks in the style of the OSU suite, for message
+// sizes from 1 B to 4 MB (powers of two).
+//
+//   pingpong_bench [-t test] [-b] [-c] [-m max bytes] [-i iterations]
+//                  [-w warmup] [-W window] [-p peer]
+//
+// Tests (-t, default all):
+//   latency  one-way latency: half of a ping-pong round trip
+//   bw       unidirectional bandwidth: windows of messages, then an ack
+//   bibw     bidirectional bandwidth: both ranks send a window at once
+//   mbw      multi-pair bandwidth: rank r sends to rank r + p / 2, all pairs
+//            at the same time (aggregate of all pairs)
+//   rate     multi-pair message rate, same traffic as mbw
+//
+// latency, bw and bibw run between rank 0 and the peer (-p, default 1).
+// Messages are sent with Isend/Irecv and a window of outstanding messages
+// (-W, default 64); -b uses blocking Send/Recv instead. -c prints CSV.
+//
+// Every sample is timed on its own: a round trip for latency, a window for
+// the other tests. The percentiles are taken over the sample times, so
+// "p99" is always the slow tail, i.e. the 99th percentile latency but the
+// 1st percentile bandwidth. "avg" is derived from the mean sample time.
+
+#define DEFAULT_MAX_BYTES (4 << 20)
+#define DEFAULT_ITERATIONS 1000
+#define DEFAULT_WARMUP 100
+#define DEFAULT_WINDOW 64
+#define MIN_ITERATIONS 5
+#define LARGE_MESSAGE (64 << 10)       // fewer iterations from here on
+#define WINDOW_BYTES (64 << 20)        // receive slots of a window
+#define BANDWIDTH_SAMPLES_DIVISOR 10   // a window is many messages
+#define PINGPONG_TAG 42
+#define ACK_TAG 43
+
+typedef enum {
+    TEST_LATENCY = 0,
+    TEST_BANDWIDTH,
+    TEST_BIDIRECTIONAL,
+    TEST_MULTI_BANDWIDTH,
+    TEST_MESSAGE_RATE,
+    N_TESTS
+} Test;
+
+static const char* test_names[N_TESTS] = {"latency", "bw", "bibw", "mbw",
+                                          "rate"};
+static const char* test_units[N_TESTS] = {"us", "MB/s", "MB/s", "MB/s",
+                                          "msg/s"};
+
+typedef struct {
+    int blocking;
+    int csv;
+    long max_bytes;
+    int iterations;
+    int warmup;
+    int window;
+    int peer;
+} Options;
+
+// Ranks taking part in a test: `sender` starts every exchange and times it
+typedef struct {
+    int active;
+    int sender;
+    int partner;
+    int n_pairs;
+    int inter_node_pairs;
+} Pairing;
+
+typedef char ProcessorName[MPI_MAX_PROCESSOR_NAME];
+
+static int is_multi_pair(Test test) {
+    return test == TEST_MULTI_BANDWIDTH || test == TEST_MESSAGE_RATE;
+}
+
+// Pairs of the test and how many of them cross nodes (valid on rank 0)
+static Pairing make_pairing(Test test, const Options* options, int id,
+                            int n_processes, ProcessorName* names) {
+    Pairing pairing = {0, 0, -1, 1, 0};
+    if (is_multi_pair(test)) {
+        pairing.n_pairs = n_processes / 2;
+        if (id < 2 * pairing.n_pairs) {
+            pairing.active = 1;
+            pairing.sender = id < pairing.n_pairs;
+            pairing.partner = pairing.sender ? id + pairing.n_pairs
+                                             : id - pairing.n_pairs;
+        }
+        for (int r = 0; r < pairing.n_pairs && names; r++) {
+            pairing.inter_node_pairs +=
+                strcmp(names[r], names[r + pairing.n_pairs]) != 0;
+        }
+    } else {
+        if (id == 0 || id == options->peer) {
+            pairing.active = 1;
+            pairing.sender = id == 0;
+            pairing.partner = id == 0 ? options->peer : 0;
+        }
+        if (names) {
+            pairing.inter_node_pairs =
+                strcmp(names[0], names[options->peer]) != 0;
+        }
+    }
+    return pairing;
+}
+
+// One ping-pong; returns the one-way time on the sender
+static double latency_sample(const Options* options, const Pairing* pairing,
+                             char* send_buffer, char* recv_buffer, int bytes) {
+    MPI_Request requests[2];
+    double start = timer_now();
+    if (pairing->sender) {
+        if (options->blocking) {
+            MPI_Send(send_buffer, bytes, MPI_CHAR, pairing->partner,
+                     PINGPONG_TAG, MPI_COMM_WORLD);
+            MPI_Recv(recv_buffer, bytes, MPI_CHAR, pairing->partner,
+                     PINGPONG_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        } else {
+            MPI_Irecv(recv_buffer, bytes, MPI_CHAR, pairing->partner,
+                      PINGPONG_TAG, MPI_COMM_WORLD, &requests[0]);
+            MPI_Isend(send_buffer, bytes, MPI_CHAR, pairing->partner,
+                      PINGPONG_TAG, MPI_COMM_WORLD, &requests[1]);
+            MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+        }
+        return (timer_now() - start) / 2;
+    }
+    if (options->blocking) {
+        MPI_Recv(recv_buffer, bytes, MPI_CHAR, pairing->partner, PINGPONG_TAG,
+                 MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Send(send_buffer, bytes, MPI_CHAR, pairing->partner, PINGPONG_TAG,
+                 MPI_COMM_WORLD);
+    } else {
+        MPI_Irecv(recv_buffer, bytes, MPI_CHAR, pairing->partner, PINGPONG_TAG,
+                  MPI_COMM_WORLD, &requests[0]);
+        MPI_Wait(&requests[0], MPI_STATUS_IGNORE);
+        MPI_Isend(send_buffer, bytes, MPI_CHAR, pairing->partner,
+                  PINGPONG_TAG, MPI_COMM_WORLD, &requests[1]);
+        MPI_Wait(&requests[1], MPI_STATUS_IGNORE);
+    }
+    return 0;
+}
+
+// One window of `window` messages (both ways when `bidirectional`), closed
+// by an ack from the receiver; returns the window time on the sender.
+// Message m is received into slot m of `recv_buffer`.
+static double window_sample(const Options* options, const Pairing* pairing,
+                            char* send_buffer, char* recv_buffer, int bytes,
+                            int window, int bidirectional,
+                            MPI_Request* requests) {
+    int partner = pairing->partner;
+    char ack = 0;
+    int sends = pairing->sender || bidirectional;
+    int receives = !pairing->sender || bidirectional;
+    double start = timer_now();
+
+    if (options->blocking) {
+        for (int m = 0; m < window; m++) {
+            char* slot = recv_buffer + (long)m * bytes;
+            if (sends && receives) {
+                MPI_Sendrecv(send_buffer, bytes, MPI_CHAR, partner,
+                             PINGPONG_TAG, slot, bytes, MPI_CHAR, partner,
+                             PINGPONG_TAG, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            } else if (sends) {
+                MPI_Send(send_buffer, bytes, MPI_CHAR, partner, PINGPONG_TAG,
+                         MPI_COMM_WORLD);
+            } else {
+                MPI_Recv(slot, bytes, MPI_CHAR, partner, PINGPONG_TAG,
+                         MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            }
+        }
+    } else {
+        int n = 0;
+        for (int m = 0; m < window && receives; m++) {
+            MPI_Irecv(recv_buffer + (long)m * bytes, bytes, MPI_CHAR, partner,
+                      PINGPONG_TAG, MPI_COMM_WORLD, &requests[n++]);
+        }
+        for (int m = 0; m < window && sends; m++) {
+            MPI_Isend(send_buffer, bytes, MPI_CHAR, partner, PINGPONG_TAG,
+                      MPI_COMM_WORLD, &requests[n++]);
+        }
+        MPI_Waitall(n, requests, MPI_STATUSES_IGNORE);
+    }
+
+    if (pairing->sender) {
+        MPI_Recv(&ack, 1, MPI_CHAR, partner, ACK_TAG, MPI_COMM_WORLD,
+                 MPI_STATUS_IGNORE);
+        return timer_now() - start;
+    }
+    MPI_Send(&ack, 1, MPI_CHAR, partner, ACK_TAG, MPI_COMM_WORLD);
+    return 0;
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static double percentile(const double* sorted, int n, double p) {
+    int index = (int)(p / 100 * n + 0.999999) - 1;
+    if (index < 0) index = 0;
+    if (index >= n) index = n - 1;
+    return sorted[index];
+}
+
+// Result of a sample time in the unit of the test
+static double convert(Test test, double seconds, long bytes, int window,
+                      int n_pairs) {
+    if (seconds <= 0) return 0;
+    double messages = (double)window * n_pairs;
+    if (test == TEST_BIDIRECTIONAL) messages *= 2;
+    switch (test) {
+        case TEST_LATENCY:
+            return seconds * 1e6;
+        case TEST_MESSAGE_RATE:
+            return messages / seconds;
+        default:
+            return messages * bytes / seconds / 1e6;
+    }
+}
+
+static void print_header(Test test, const Options* options,
+                         const Pairing* pairing, int n_processes,
+                         ProcessorName* names) {
+    const char* mode = options->blocking ? "blocking" : "non-blocking";
+    if (options->csv) return;
+    printf("# %s, %s", test_names[test], mode);
+    if (test != TEST_LATENCY) printf(", window of %d", options->window);
+    if (is_multi_pair(test)) {
+        printf(", %d pairs of %d processes (%d inter-node)\n",
+               pairing->n_pairs, n_processes, pairing->inter_node_pairs);
+    } else {
+        printf(", ranks 0 and %d on %s and %s (%s)\n", options->peer,
+               names[0], names[options->peer],
+               pairing->inter_node_pairs ? "inter-node" : "intra-node");
+    }
+    printf("# %s, percentiles of the sample times\n", test_units[test]);
+    printf("%10s %8s %6s %12s %12s %12s %12s %12s %12s\n", "bytes",
+           "samples", "window", "avg", "best", "p50", "p90", "p99", "worst");
+}
+
+static void print_row(Test test, const Options* options,
+                      const Pairing* pairing, long bytes, int window,
+                      double* times, int n) {
+    double mean = 0;
+    for (int s = 0; s < n; s++) mean += times[s];
+    mean /= n;
+    qsort(times, n, sizeof(double), compare_doubles);
+
+    double values[6] = {mean, times[0], percentile(times, n, 50),
+                        percentile(times, n, 90), percentile(times, n, 99),
+                        times[n - 1]};
+    for (int v = 0; v < 6; v++) {
+        values[v] = convert(test, values[v], bytes, window, pairing->n_pairs);
+    }
+
+    if (options->csv) {
+        printf("%s,%s,%d,%d,%ld,%d,%d,%s", test_names[test],
+               options->blocking ? "blocking" : "non-blocking",
+               pairing->n_pairs, pairing->inter_node_pairs, bytes, n, window,
+               test_units[test]);
+        for (int v = 0; v < 6; v++) printf(",%.3f", values[v]);
+        printf("\n");
+    } else {
+        printf("%10ld %8d %6d", bytes, n, window);
+        for (int v = 0; v < 6; v++) printf(" %12.2f", values[v]);
+        printf("\n");
+    }
+}
+
+static void run_test(Test test, const Options* options, int id,
+                     int n_processes, ProcessorName* names,
+                     char* send_buffer, char* recv_buffer, long recv_bytes,
+                     MPI_Request* requests, double* times,
+                     double* slowest) {
+    Pairing pairing = make_pairing(test, options, id, n_processes, names);
+    if (id == 0) print_header(test, options, &pairing, n_processes, names);
+
+    for (long bytes = 1; bytes <= options->max_bytes; bytes *= 2) {
+        int n = options->iterations, warmup = options->warmup;
+        if (test != TEST_LATENCY) {
+            n /= BANDWIDTH_SAMPLES_DIVISOR;
+            warmup /= BANDWIDTH_SAMPLES_DIVISOR;
+        }
+        if (bytes >= LARGE_MESSAGE) {
+            n /= 10;
+            warmup /= 10;
+        }
+        if (n < MIN_ITERATIONS) n = MIN_ITERATIONS;
+        if (warmup < 1) warmup = 1;
+
+        // Large messages shrink the window so that every message in flight
+        // has its own receive slot
+        int window = options->window;
+        if (window > recv_bytes / bytes) window = (int)(recv_bytes / bytes);
+        if (test == TEST_LATENCY) window = 1;
+
+        for (int s = 0; s < n; s++) times[s] = 0;
+        MPI_Barrier(MPI_COMM_WORLD);
+        for (int s = -warmup; s < n && pairing.active; s++) {
+            double t = test == TEST_LATENCY
+                           ? latency_sample(options, &pairing, send_buffer,
+                                            recv_buffer, (int)bytes)
+                           : window_sample(options, &pairing, send_buffer,
+                                           recv_buffer, (int)bytes, window,
+                                           test == TEST_BIDIRECTIONAL,
+                                           requests);
+            if (s >= 0) times[s] = t;
+        }
+        // Sample s of all pairs is as slow as the slowest of them
+        MPI_Reduce(times, slowest, n, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+        if (id == 0) {
+            print_row(test, options, &pairing, bytes, window, slowest, n);
+            fflush(stdout);
+        }
+    }
+    if (id == 0 && !options->csv) printf("\n");
+}
+
+int main(int argc, char* argv[]) {
+    int n_processes = 0;
+    int id = 0;
+    int selected = -1;  // all tests
+    Options options = {0, 0, DEFAULT_MAX_BYTES, DEFAULT_ITERATIONS,
+                       DEFAULT_WARMUP, DEFAULT_WINDOW, 1};
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    timer_init(TIMER_MPI);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            i++;
+            for (int t = 0; t < N_TESTS; t++) {
+                if (strcmp(argv[i], test_names[t]) == 0) selected = t;
+            }
+        } else if (strcmp(argv[i], "-b") == 0) {
+            options.blocking = 1;
+        } else if (strcmp(argv[i], "-c") == 0) {
+            options.csv = 1;
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            options.max_bytes = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            options.iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            options.warmup = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-W") == 0 && i + 1 < argc) {
+            options.window = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            options.peer = atoi(argv[++i]);
+        }
+    }
+    if (options.max_bytes < 1 || options.max_bytes > WINDOW_BYTES) {
+        options.max_bytes = DEFAULT_MAX_BYTES;
+    }
+    if (options.iterations < MIN_ITERATIONS) {
+        options.iterations = MIN_ITERATIONS;
+    }
+    if (options.warmup < 0) options.warmup = 0;
+    if (options.window < 1) options.window = 1;
+    if (n_processes < 2) {
+        if (id == 0) printf("Error: needs at least 2 processes\n");
+        MPI_Finalize();
+        return 1;
+    }
+    if (options.peer < 1 || options.peer >= n_processes) options.peer = 1;
+
+    // Rank 0 learns where every rank runs to tell intra- from inter-node
+    ProcessorName name = {0};
+    int name_length = 0;
+    MPI_Get_processor_name(name, &name_length);
+    ProcessorName* names = NULL;
+    if (id == 0) names = calloc(n_processes, sizeof(ProcessorName));
+
+    long recv_bytes = (long)options.window * options.max_bytes;
+    if (recv_bytes > WINDOW_BYTES) recv_bytes = WINDOW_BYTES;
+    char* send_buffer = malloc(options.max_bytes);
+    char* recv_buffer = malloc(recv_bytes);
+    MPI_Request* requests = malloc(sizeof(MPI_Request) * 2 * options.window);
+    double* times = malloc(sizeof(double) * options.iterations);
+    double* slowest = malloc(sizeof(double) * options.iterations);
+    int have_buffers = send_buffer && recv_buffer && requests && times &&
+                       slowest && (id != 0 || names),
+        all_have_buffers = 0;
+    MPI_Allreduce(&have_buffers, &all_have_buffers, 1, MPI_INT, MPI_LAND,
+                  MPI_COMM_WORLD);
+    if (!all_have_buffers) {
+        if (id == 0) printf("Error: could not allocate the buffers\n");
+        MPI_Finalize();
+        return 1;
+    }
+    MPI_Gather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, names,
+               MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, MPI_COMM_WORLD);
+    memset(send_buffer, 'a', options.max_bytes);
+
+    if (id == 0 && options.csv) {
+        printf("test,mode,pairs,inter_node_pairs,bytes,samples,window,unit,"
+               "avg,best,p50,p90,p99,worst\n");
+    }
+    for (int t = 0; t < N_TESTS; t++) {
+        if (selected >= 0 && t != selected) continue;
+        run_test((Test)t, &options, id, n_processes, names, send_buffer,
+                 recv_buffer, recv_bytes, requests, times, slowest);
+    }
+
+    free(slowest);
+    free(times);
+    free(requests);
+    free(recv_buffer);
+    free(send_buffer);
+    free(names);
+    MPI_Finalize();
+    return 0;
+}
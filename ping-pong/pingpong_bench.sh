@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o -ppn places ranks per node: 2 keeps a pair on one node (intra-node),
+#   1 puts it on two nodes (inter-node)
+# o the multi-pair run pairs every rank of the first node with one of the
+#   second node
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:20:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=2:ncpus=8:mem=2gb
+#PBS -l place=scatter
+
+# get dependencies
+module load mpich-3.2
+# build
+mpicc ~/hpc/ping-pong/pingpong_bench.c ~/hpc/timing/timer.c -DTIMER_WITH_MPI -O2 -Wall -std=c99 -o ~/hpc/ping-pong/pingpong_bench -lm
+# run
+mpirun.actual -n 2 -ppn 2 ~/hpc/ping-pong/pingpong_bench -t latency
+mpirun.actual -n 2 -ppn 1 ~/hpc/ping-pong/pingpong_bench -t latency
+mpirun.actual -n 2 -ppn 2 ~/hpc/ping-pong/pingpong_bench -t bw
+mpirun.actual -n 2 -ppn 1 ~/hpc/ping-pong/pingpong_bench -t bw
+mpirun.actual -n 2 -ppn 1 ~/hpc/ping-pong/pingpong_bench -t bw -b
+mpirun.actual -n 2 -ppn 1 ~/hpc/ping-pong/pingpong_bench -t bibw
+mpirun.actual -n 16 -ppn 8 ~/hpc/ping-pong/pingpong_bench -t mbw
+mpirun.actual -n 16 -ppn 8 ~/hpc/ping-pong/pingpong_bench -t rate
\ No newline at end of file
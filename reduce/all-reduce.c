@@ -1,6 +1,8 @@
 #include <mpi.h>
 #include <stdio.h>
 
+#include "allreduce.h"
+
 int main() {
     int n_processes = 0;
     int id = 0;
@@ -11,49 +13,11 @@ int main() {
     MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
     MPI_Comm_rank(MPI_COMM_WORLD, &id);
 
-    if (id == 0) {
-        for (int i = 1; i < n_processes; i++) {
-            MPI_Recv(&v, 1, MPI_INT, i, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            printf("received value %d from process %d on process %d\n", v, i,
-                   id);
-            sum += v;
-        }
-
-        MPI_Send(&sum, 1, MPI_INT, 1, 0, MPI_COMM_WORLD);
-        printf("send value %d from process %d to process %d\n", sum, id, 1);
-
-        MPI_Send(&sum, 1, MPI_INT, 2, 0, MPI_COMM_WORLD);
-        printf("send value %d from process %d to process %d\n", sum, id, 2);
-
-    } else {
-        // sending out own id
-        v = id;
-        MPI_Send(&v, 1, MPI_INT, 0, 0, MPI_COMM_WORLD);
-        printf("send value %d from process %d to process %d\n", v, id, 0);
-
-        if (id % 2 == 0) {
-            MPI_Recv(&sum, 1, MPI_INT, id / 2 - 1, 0, MPI_COMM_WORLD,
-                     MPI_STATUS_IGNORE);
-            printf("received value %d from process %d on process %d\n", sum,
-                   id / 2 - 1, id);
-        } else {
-            MPI_Recv(&sum, 1, MPI_INT, id / 2, 0, MPI_COMM_WORLD,
-                     MPI_STATUS_IGNORE);
-            printf("received value %d from process %d on process %d\n", sum,
-                   id / 2, id);
-        }
-
-        if ((id * 2 + 1) < n_processes) {
-            MPI_Send(&sum, 1, MPI_INT, id * 2 + 1, 0, MPI_COMM_WORLD);
-            printf("send value %d from process %d to process %d\n", sum, id,
-                   id * 2 + 1);
-        }
-        if ((id * 2 + 2) < n_processes) {
-            MPI_Send(&sum, 1, MPI_INT, id * 2 + 2, 0, MPI_COMM_WORLD);
-            printf("send value %d from process %d to process %d\n", sum, id,
-                   id * 2 + 2);
-        }
-    }
+    // every process contributes its own id and receives the total
+    v = id;
+    allreduce(&v, &sum, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD,
+              ALLREDUCE_RECURSIVE_DOUBLING);
+    printf("received sum %d on process %d of %d\n", sum, id, n_processes);
 
     MPI_Finalize();
     return 0;
@@ -14,6 +14,6 @@
 # get dependencies
 module load mpich-3.2
 # build
-mpicc ~/hpc/reduce/all-reduce.c -g -Wall -std=c99 -o ~/hpc/reduce/all-reduce
+mpicc ~/hpc/reduce/all-reduce.c ~/hpc/reduce/allreduce.c ~/hpc/hierarchy/hierarchy.c -fopenmp -g -Wall -std=c99 -o ~/hpc/reduce/all-reduce
 # run
 mpirun.actual -n 8 ~/hpc/reduce/all-reduce
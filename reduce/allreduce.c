@@ -0,0 +1,422 @@
+#include "allreduce.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../hierarchy/hierarchy.h"
+
+#define ALLREDUCE_TAG 41
+// Elements below which the local reduction stays on the calling thread
+#define PARALLEL_MIN_COUNT (1 << 16)
+// Bytes of every rank's slot in the node window, i.e. per round
+#define HIERARCHY_SLOT (1 << 20)
+// Bytes from which the leaders use Rabenseifner instead of recursive doubling
+// and the ranks of a node meet in shared memory instead of exchanging
+// messages (three node barriers cost more than short messages)
+#define HIERARCHY_LARGE (64 << 10)
+
+// inout[i] = in[i] op inout[i]
+#define REDUCE_LOOP(type, expression)                                      \
+    do {                                                                   \
+        const type* a = in;                                                \
+        type* b = inout;                                                   \
+        _Pragma("omp parallel for simd if (count >= PARALLEL_MIN_COUNT)") \
+        for (int i = 0; i < count; i++) b[i] = expression;                 \
+    } while (0)
+
+#define REDUCE_TYPE(type)                                           \
+    do {                                                            \
+        if (op == MPI_SUM) {                                        \
+            REDUCE_LOOP(type, a[i] + b[i]);                         \
+        } else if (op == MPI_PROD) {                                \
+            REDUCE_LOOP(type, a[i] * b[i]);                         \
+        } else if (op == MPI_MAX) {                                 \
+            REDUCE_LOOP(type, a[i] > b[i] ? a[i] : b[i]);           \
+        } else if (op == MPI_MIN) {                                 \
+            REDUCE_LOOP(type, a[i] < b[i] ? a[i] : b[i]);           \
+        } else {                                                    \
+            return MPI_Reduce_local(in, inout, count, datatype, op); \
+        }                                                           \
+        return MPI_SUCCESS;                                         \
+    } while (0)
+
+static int reduce_local(const void* in, void* inout, int count,
+                        MPI_Datatype datatype, MPI_Op op) {
+    if (count == 0) return MPI_SUCCESS;
+    if (datatype == MPI_INT) REDUCE_TYPE(int);
+    if (datatype == MPI_LONG) REDUCE_TYPE(long);
+    if (datatype == MPI_LONG_LONG) REDUCE_TYPE(long long);
+    if (datatype == MPI_FLOAT) REDUCE_TYPE(float);
+    if (datatype == MPI_DOUBLE) REDUCE_TYPE(double);
+    return MPI_Reduce_local(in, inout, count, datatype, op);
+}
+
+// Ranks of the power-of-two group that recursive doubling and Rabenseifner
+// run on: of the first 2 * rest ranks only the odd ones take part, holding
+// the reduction of themselves and the even rank below
+typedef struct {
+    int pof2;
+    int rest;
+    int new_rank;  // -1 for the even ranks that fold into their neighbour
+} Fold;
+
+static int real_rank(const Fold* fold, int new_rank) {
+    return new_rank < fold->rest ? 2 * new_rank + 1 : new_rank + fold->rest;
+}
+
+static int fold_in(Fold* fold, char* recvbuf, char* tmp, int count,
+                   MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+    int n_processes = 0, id = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Comm_rank(comm, &id);
+    fold->pof2 = 1;
+    while (fold->pof2 * 2 <= n_processes) fold->pof2 *= 2;
+    fold->rest = n_processes - fold->pof2;
+
+    if (id >= 2 * fold->rest) {
+        fold->new_rank = id - fold->rest;
+        return MPI_SUCCESS;
+    }
+    if (id % 2 == 0) {
+        fold->new_rank = -1;
+        return MPI_Send(recvbuf, count, datatype, id + 1, ALLREDUCE_TAG,
+                        comm);
+    }
+    fold->new_rank = id / 2;
+    int err = MPI_Recv(tmp, count, datatype, id - 1, ALLREDUCE_TAG, comm,
+                       MPI_STATUS_IGNORE);
+    // The lower rank's operand comes first
+    return err == MPI_SUCCESS
+               ? reduce_local(tmp, recvbuf, count, datatype, op)
+               : err;
+}
+
+static int fold_out(const Fold* fold, char* recvbuf, int count,
+                    MPI_Datatype datatype, MPI_Comm comm) {
+    int id = 0;
+    MPI_Comm_rank(comm, &id);
+    if (id >= 2 * fold->rest) return MPI_SUCCESS;
+    if (id % 2 == 0) {
+        return MPI_Recv(recvbuf, count, datatype, id + 1, ALLREDUCE_TAG, comm,
+                        MPI_STATUS_IGNORE);
+    }
+    return MPI_Send(recvbuf, count, datatype, id - 1, ALLREDUCE_TAG, comm);
+}
+
+static int recursive_doubling(const Fold* fold, char* recvbuf, char* tmp,
+                              int count, MPI_Aint extent,
+                              MPI_Datatype datatype, MPI_Op op,
+                              int commutative, MPI_Comm comm) {
+    int err = MPI_SUCCESS;
+    for (int mask = 1; mask < fold->pof2 && err == MPI_SUCCESS; mask <<= 1) {
+        int partner = fold->new_rank ^ mask;
+        err = MPI_Sendrecv(recvbuf, count, datatype, real_rank(fold, partner),
+                           ALLREDUCE_TAG, tmp, count, datatype,
+                           real_rank(fold, partner), ALLREDUCE_TAG, comm,
+                           MPI_STATUS_IGNORE);
+        if (err != MPI_SUCCESS) break;
+        if (commutative || partner < fold->new_rank) {
+            err = reduce_local(tmp, recvbuf, count, datatype, op);
+        } else {
+            // Keep rank order: ours first, then copy the result back
+            err = reduce_local(recvbuf, tmp, count, datatype, op);
+            memcpy(recvbuf, tmp, (size_t)count * extent);
+        }
+    }
+    return err;
+}
+
+// Elements and offsets of `n_blocks` nearly equal blocks of `count`
+static void split_blocks(int count, int n_blocks, int* counts,
+                         int* offsets) {
+    for (int b = 0, offset = 0; b < n_blocks; b++) {
+        counts[b] = count / n_blocks + (b < count % n_blocks);
+        offsets[b] = offset;
+        offset += counts[b];
+    }
+}
+
+static int sum_counts(const int* counts, int first, int last) {
+    int sum = 0;
+    for (int b = first; b < last; b++) sum += counts[b];
+    return sum;
+}
+
+// Recursive halving reduce-scatter leaves rank r of the power-of-two group
+// with the reduced block r; recursive doubling gathers all blocks back.
+// Every rank sends and receives about 2 * count elements in total.
+static int rabenseifner(const Fold* fold, char* recvbuf, char* tmp,
+                        int count, MPI_Aint extent, MPI_Datatype datatype,
+                        MPI_Op op, MPI_Comm comm) {
+    int pof2 = fold->pof2, new_rank = fold->new_rank;
+    int* counts = malloc(sizeof(int) * 2 * pof2);
+    if (!counts) return MPI_ERR_NO_MEM;
+    int* offsets = counts + pof2;
+    split_blocks(count, pof2, counts, offsets);
+
+    // Window [send_block, last_block) of blocks this rank is responsible for
+    int err = MPI_SUCCESS;
+    int send_block = 0, recv_block = 0, last_block = pof2;
+    int mask = 1;
+    for (; mask < pof2 && err == MPI_SUCCESS; mask <<= 1) {
+        int partner = new_rank ^ mask, half = pof2 / (mask * 2);
+        int send_count, recv_count;
+        if (new_rank < partner) {
+            // Keep the lower half, send the upper half
+            send_block = recv_block + half;
+            send_count = sum_counts(counts, send_block, last_block);
+            recv_count = sum_counts(counts, recv_block, send_block);
+        } else {
+            recv_block = send_block + half;
+            send_count = sum_counts(counts, send_block, recv_block);
+            recv_count = sum_counts(counts, recv_block, last_block);
+        }
+        err = MPI_Sendrecv(recvbuf + offsets[send_block] * extent, send_count,
+                           datatype, real_rank(fold, partner), ALLREDUCE_TAG,
+                           tmp + offsets[recv_block] * extent, recv_count,
+                           datatype, real_rank(fold, partner), ALLREDUCE_TAG,
+                           comm, MPI_STATUS_IGNORE);
+        if (err == MPI_SUCCESS) {
+            err = reduce_local(tmp + offsets[recv_block] * extent,
+                               recvbuf + offsets[recv_block] * extent,
+                               recv_count, datatype, op);
+        }
+        send_block = recv_block;
+        last_block = recv_block + half;
+    }
+
+    // Undo the halving steps in reverse order
+    for (mask = pof2 >> 1; mask > 0 && err == MPI_SUCCESS; mask >>= 1) {
+        int partner = new_rank ^ mask, half = pof2 / (mask * 2);
+        int send_count, recv_count;
+        if (new_rank < partner) {
+            recv_block = send_block + half;
+            last_block = recv_block + half;
+            send_count = sum_counts(counts, send_block, recv_block);
+            recv_count = sum_counts(counts, recv_block, last_block);
+        } else {
+            recv_block = send_block - half;
+            send_count = sum_counts(counts, send_block, last_block);
+            recv_count = sum_counts(counts, recv_block, send_block);
+        }
+        err = MPI_Sendrecv(recvbuf + offsets[send_block] * extent, send_count,
+                           datatype, real_rank(fold, partner), ALLREDUCE_TAG,
+                           recvbuf + offsets[recv_block] * extent, recv_count,
+                           datatype, real_rank(fold, partner), ALLREDUCE_TAG,
+                           comm, MPI_STATUS_IGNORE);
+        if (new_rank > partner) send_block = recv_block;
+    }
+
+    free(counts);
+    return err;
+}
+
+// p - 1 steps reduce one block each around the ring until rank r holds the
+// reduced block r + 1, then p - 1 steps pass the reduced blocks around
+static int ring(char* recvbuf, char* tmp, int count, MPI_Aint extent,
+                MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+    int n_processes = 0, id = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Comm_rank(comm, &id);
+    int* counts = malloc(sizeof(int) * 2 * n_processes);
+    if (!counts) return MPI_ERR_NO_MEM;
+    int* offsets = counts + n_processes;
+    split_blocks(count, n_processes, counts, offsets);
+
+    int left = (id - 1 + n_processes) % n_processes;
+    int right = (id + 1) % n_processes;
+    int err = MPI_SUCCESS;
+    for (int s = 0; s < n_processes - 1 && err == MPI_SUCCESS; s++) {
+        int send = (id - s + n_processes) % n_processes;
+        int recv = (id - s - 1 + n_processes) % n_processes;
+        err = MPI_Sendrecv(recvbuf + offsets[send] * extent, counts[send],
+                           datatype, right, ALLREDUCE_TAG,
+                           tmp + offsets[recv] * extent, counts[recv],
+                           datatype, left, ALLREDUCE_TAG, comm,
+                           MPI_STATUS_IGNORE);
+        if (err == MPI_SUCCESS) {
+            err = reduce_local(tmp + offsets[recv] * extent,
+                               recvbuf + offsets[recv] * extent, counts[recv],
+                               datatype, op);
+        }
+    }
+    for (int s = 0; s < n_processes - 1 && err == MPI_SUCCESS; s++) {
+        int send = (id + 1 - s + n_processes) % n_processes;
+        int recv = (id - s + n_processes) % n_processes;
+        err = MPI_Sendrecv(recvbuf + offsets[send] * extent, counts[send],
+                           datatype, right, ALLREDUCE_TAG,
+                           recvbuf + offsets[recv] * extent, counts[recv],
+                           datatype, left, ALLREDUCE_TAG, comm,
+                           MPI_STATUS_IGNORE);
+    }
+
+    free(counts);
+    return err;
+}
+
+// Short vectors: binomial reduce to the leader over node_comm, all-reduce
+// between the leaders, then the same tree backwards to broadcast
+static int two_level(char* recvbuf, char* tmp, int count,
+                     MPI_Datatype datatype, MPI_Op op,
+                     const Hierarchy* hierarchy) {
+    int rank = hierarchy->node_rank, size = hierarchy->node_size;
+    int err = MPI_SUCCESS, mask = 1;
+    for (; mask < size && err == MPI_SUCCESS; mask <<= 1) {
+        if (rank & mask) {
+            err = MPI_Send(recvbuf, count, datatype, rank - mask,
+                           ALLREDUCE_TAG, hierarchy->node_comm);
+            break;
+        }
+        if (rank + mask < size) {
+            err = MPI_Recv(tmp, count, datatype, rank + mask, ALLREDUCE_TAG,
+                           hierarchy->node_comm, MPI_STATUS_IGNORE);
+            if (err == MPI_SUCCESS) {
+                err = reduce_local(tmp, recvbuf, count, datatype, op);
+            }
+        }
+    }
+    if (hierarchy->leader_comm != MPI_COMM_NULL && hierarchy->n_nodes > 1 &&
+        err == MPI_SUCCESS) {
+        err = allreduce(MPI_IN_PLACE, recvbuf, count, datatype, op,
+                        hierarchy->leader_comm, ALLREDUCE_RECURSIVE_DOUBLING);
+    }
+
+    // mask is the lowest set bit of rank (the step that sent to the parent)
+    if (rank > 0 && err == MPI_SUCCESS) {
+        err = MPI_Recv(recvbuf, count, datatype, rank - mask, ALLREDUCE_TAG,
+                       hierarchy->node_comm, MPI_STATUS_IGNORE);
+    }
+    for (mask >>= 1; mask > 0 && err == MPI_SUCCESS; mask >>= 1) {
+        if (rank + mask < size) {
+            err = MPI_Send(recvbuf, count, datatype, rank + mask,
+                           ALLREDUCE_TAG, hierarchy->node_comm);
+        }
+    }
+    return err;
+}
+
+// Every rank stores a chunk into its slot of the node window; node rank r
+// then reduces the r-th part of the chunk over all slots into the result
+// slot, so the ranks of a node share the reduction work without a single
+// intra-node message. The leaders combine the results of the nodes and
+// everyone loads the final chunk. A rank only stores into its slot or its
+// part of the result after a sync that all loads of the previous round
+// happened before.
+static int hierarchical(char* recvbuf, int count, MPI_Aint extent,
+                        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+    Hierarchy* hierarchy = NULL;
+    int err = hierarchy_get(comm, &hierarchy);
+    if (err != MPI_SUCCESS) return err;
+    if (count * extent < HIERARCHY_LARGE) {
+        char* tmp = malloc((size_t)count * extent);
+        if (!tmp) return MPI_ERR_NO_MEM;
+        err = two_level(recvbuf, tmp, count, datatype, op, hierarchy);
+        free(tmp);
+        return err;
+    }
+    int node_rank = hierarchy->node_rank, node_size = hierarchy->node_size;
+
+    int chunk = (int)(HIERARCHY_SLOT / extent);
+    if (chunk < 1) chunk = 1;
+    if (chunk > count) chunk = count;
+    MPI_Aint slot = chunk * extent;
+    err = hierarchy_reserve(hierarchy, (node_size + 1) * slot);
+    char* own = hierarchy->base + node_rank * slot;
+    char* result = hierarchy->base + node_size * slot;
+    int inter_node = hierarchy->leader_comm != MPI_COMM_NULL &&
+                     hierarchy->n_nodes > 1;
+
+    for (int offset = 0; offset < count && err == MPI_SUCCESS;
+         offset += chunk) {
+        int n = count - offset < chunk ? count - offset : chunk;
+        memcpy(own, recvbuf + offset * extent, n * extent);
+        err = hierarchy_sync(hierarchy);
+
+        int first = (int)((long)n * node_rank / node_size);
+        int last = (int)((long)n * (node_rank + 1) / node_size);
+        if (last > first && err == MPI_SUCCESS) {
+            memcpy(result + first * extent, hierarchy->base + first * extent,
+                   (last - first) * extent);
+            for (int r = 1; r < node_size && err == MPI_SUCCESS; r++) {
+                err = reduce_local(hierarchy->base + r * slot + first * extent,
+                                   result + first * extent, last - first,
+                                   datatype, op);
+            }
+        }
+        if (err == MPI_SUCCESS) err = hierarchy_sync(hierarchy);
+
+        if (inter_node && err == MPI_SUCCESS) {
+            err = allreduce(MPI_IN_PLACE, result, n, datatype, op,
+                            hierarchy->leader_comm,
+                            n * extent >= HIERARCHY_LARGE
+                                ? ALLREDUCE_RABENSEIFNER
+                                : ALLREDUCE_RECURSIVE_DOUBLING);
+        }
+        if (err == MPI_SUCCESS) err = hierarchy_sync(hierarchy);
+        memcpy(recvbuf + offset * extent, result, n * extent);
+    }
+    return err;
+}
+
+int allreduce(const void* sendbuf, void* recvbuf, int count,
+              MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+              AllreduceAlgorithm algorithm) {
+    if (count < 0 || algorithm < 0 || algorithm >= ALLREDUCE_NUM_ALGORITHMS) {
+        return MPI_ERR_ARG;
+    }
+    MPI_Aint lower_bound = 0, extent = 0;
+    MPI_Type_get_extent(datatype, &lower_bound, &extent);
+    if (sendbuf != MPI_IN_PLACE) {
+        memcpy(recvbuf, sendbuf, (size_t)count * extent);
+    }
+
+    int n_processes = 0, commutative = 0;
+    MPI_Comm_size(comm, &n_processes);
+    MPI_Op_commutative(op, &commutative);
+    if (n_processes == 1 || count == 0) return MPI_SUCCESS;
+    if (!commutative) algorithm = ALLREDUCE_RECURSIVE_DOUBLING;
+    if (algorithm == ALLREDUCE_HIERARCHICAL) {
+        return hierarchical(recvbuf, count, extent, datatype, op, comm);
+    }
+
+    char* tmp = malloc((size_t)count * extent);
+    if (!tmp) return MPI_ERR_NO_MEM;
+
+    int err;
+    if (algorithm == ALLREDUCE_RING) {
+        err = ring(recvbuf, tmp, count, extent, datatype, op, comm);
+    } else {
+        Fold fold;
+        err = fold_in(&fold, recvbuf, tmp, count, datatype, op, comm);
+        if (err == MPI_SUCCESS && fold.new_rank >= 0) {
+            if (algorithm == ALLREDUCE_RABENSEIFNER && count >= fold.pof2) {
+                err = rabenseifner(&fold, recvbuf, tmp, count, extent,
+                                   datatype, op, comm);
+            } else {
+                err = recursive_doubling(&fold, recvbuf, tmp, count, extent,
+                                         datatype, op, commutative, comm);
+            }
+        }
+        if (err == MPI_SUCCESS) {
+            err = fold_out(&fold, recvbuf, count, datatype, comm);
+        }
+    }
+
+    free(tmp);
+    return err;
+}
+
+const char* allreduce_algorithm_name(AllreduceAlgorithm algorithm) {
+    switch (algorithm) {
+        case ALLREDUCE_RECURSIVE_DOUBLING:
+            return "recursive-doubling";
+        case ALLREDUCE_RABENSEIFNER:
+            return "rabenseifner";
+        case ALLREDUCE_RING:
+            return "ring";
+        case ALLREDUCE_HIERARCHICAL:
+            return "hierarchical";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef ALLREDUCE_H
+#define ALLREDUCE_H
+
+#include <mpi.h>
+
+typedef enum {
+    ALLREDUCE_RECURSIVE_DOUBLING = 0,  // log2(p) exchanges of the whole
+                                       // vector: best for short vectors
+    ALLREDUCE_RABENSEIFNER,            // recursive halving reduce-scatter,
+                                       // then recursive doubling allgather
+    ALLREDUCE_RING,                    // ring reduce-scatter, then ring
+                                       // allgather: 2 (p - 1) / p of the
+                                       // vector per rank, any p
+    ALLREDUCE_HIERARCHICAL,            // reduction in shared memory inside
+                                       // every node, all-reduce between the
+                                       // node leaders
+    ALLREDUCE_NUM_ALGORITHMS
+} AllreduceAlgorithm;
+
+// Combine `count` elements of `datatype` of every rank with `op` and leave
+// the result on every rank, like MPI_Allreduce (sendbuf may be
+// MPI_IN_PLACE). Any process count works: for recursive doubling and
+// Rabenseifner the first 2 * (p - 2^k) ranks fold pairwise into 2^k ranks
+// first. Built-in operations on int, long, long long, float and double are
+// reduced locally with OpenMP SIMD loops, everything else (user operations
+// included) with MPI_Reduce_local. Ring, Rabenseifner and hierarchical
+// reorder the operands, so non-commutative operations always use recursive
+// doubling, which keeps rank order. Datatypes must be contiguous.
+// Returns MPI_SUCCESS or the error code of the first failing MPI call.
+int allreduce(const void* sendbuf, void* recvbuf, int count,
+              MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+              AllreduceAlgorithm algorithm);
+
+const char* allreduce_algorithm_name(AllreduceAlgorithm algorithm);
+
+#endif  // ALLREDUCE_H
@@ -0,0 +1,135 @@
+#include <mpi.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "allreduce.h"
+
+// Compare the all-reduce algorithms of allreduce.c with MPI_Allreduce on
+// MPI_SUM over double vectors from 1 element to 2^25 (256 MB).
+//
+//   allreduce_bench [-m max elements] [-i iterations]
+//
+// Every time is the average over the iterations of the slowest rank, in
+// microseconds. Before timing, every algorithm must produce exactly the
+// MPI_Allreduce result (the inputs are small integers, so sums are exact).
+
+#define DEFAULT_MAX_COUNT (1 << 25)
+#define DEFAULT_ITERATIONS 100
+#define MIN_ITERATIONS 3
+#define ELEMENTS_PER_SIZE (8 << 20)  // iterations shrink with the size
+
+// MPI_Allreduce is column 0, the algorithms follow
+#define N_COLUMNS (ALLREDUCE_NUM_ALGORITHMS + 1)
+
+static int run(int column, const double* x, double* y, int count) {
+    if (column == 0) {
+        return MPI_Allreduce(x, y, count, MPI_DOUBLE, MPI_SUM,
+                             MPI_COMM_WORLD);
+    }
+    return allreduce(x, y, count, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD,
+                     (AllreduceAlgorithm)(column - 1));
+}
+
+static const char* column_name(int column) {
+    return column == 0
+               ? "MPI_Allreduce"
+               : allreduce_algorithm_name((AllreduceAlgorithm)(column - 1));
+}
+
+static double time_column(int column, const double* x, double* y, int count,
+                          int iterations) {
+    run(column, x, y, count);  // warmup
+    MPI_Barrier(MPI_COMM_WORLD);
+    double start = timer_now();
+    for (int i = 0; i < iterations; i++) run(column, x, y, count);
+    double local = (timer_now() - start) / iterations, slowest = 0;
+    MPI_Reduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    return slowest * 1e6;
+}
+
+int main(int argc, char* argv[]) {
+    int n_processes = 0;
+    int id = 0;
+    long max_count = DEFAULT_MAX_COUNT;
+    int max_iterations = DEFAULT_ITERATIONS;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &n_processes);
+    MPI_Comm_rank(MPI_COMM_WORLD, &id);
+    timer_init(TIMER_MPI);
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_count = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+            max_iterations = atoi(argv[++i]);
+        }
+    }
+    if (max_count < 1 || max_count > DEFAULT_MAX_COUNT) {
+        max_count = DEFAULT_MAX_COUNT;
+    }
+    if (max_iterations < MIN_ITERATIONS) max_iterations = MIN_ITERATIONS;
+
+    double* x = malloc(sizeof(double) * max_count);
+    double* y = malloc(sizeof(double) * max_count);
+    double* expected = malloc(sizeof(double) * max_count);
+    int have_buffers = x && y && expected, all_have_buffers = 0;
+    MPI_Allreduce(&have_buffers, &all_have_buffers, 1, MPI_INT, MPI_LAND,
+                  MPI_COMM_WORLD);
+    if (!all_have_buffers) {
+        if (id == 0) {
+            printf("Error: could not allocate %ld doubles\n", max_count);
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    for (long i = 0; i < max_count; i++) x[i] = (double)((i + id) % 7);
+
+    if (id == 0) {
+        printf("all-reduce: %d processes, %d OpenMP threads, "
+               "MPI_SUM on doubles\n",
+               n_processes, omp_get_max_threads());
+        printf("average time of the slowest rank [us]\n\n");
+        printf("%12s %12s", "elements", "bytes");
+        for (int c = 0; c < N_COLUMNS; c++) printf(" %18s", column_name(c));
+        printf("\n");
+    }
+
+    int failed = 0;
+    for (long count = 1; count <= max_count; count *= 2) {
+        int iterations = (int)(ELEMENTS_PER_SIZE / count);
+        if (iterations > max_iterations) iterations = max_iterations;
+        if (iterations < MIN_ITERATIONS) iterations = MIN_ITERATIONS;
+
+        MPI_Allreduce(x, expected, (int)count, MPI_DOUBLE, MPI_SUM,
+                      MPI_COMM_WORLD);
+        if (id == 0) printf("%12ld %12ld", count, count * (long)sizeof(double));
+        for (int c = 0; c < N_COLUMNS; c++) {
+            memset(y, 0, sizeof(double) * count);
+            int ok = run(c, x, y, (int)count) == MPI_SUCCESS &&
+                     memcmp(y, expected, sizeof(double) * count) == 0;
+            int all_ok = 0;
+            MPI_Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+            if (!all_ok) {
+                failed = 1;
+                if (id == 0) printf(" %18s", "WRONG");
+                continue;
+            }
+            double us = time_column(c, x, y, (int)count, iterations);
+            if (id == 0) printf(" %18.2f", us);
+        }
+        if (id == 0) {
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+
+    free(expected);
+    free(y);
+    free(x);
+    MPI_Finalize();
+    return failed;
+}
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o every rank allocates three 256 MB buffers
+# o 4 ranks per chunk with 2 OpenMP threads each for the local reduction
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:30:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=4:ncpus=8:mem=4gb
+
+# get dependencies
+module load mpich-3.2
+# build
+mpicc ~/hpc/reduce/allreduce_bench.c ~/hpc/reduce/allreduce.c ~/hpc/hierarchy/hierarchy.c ~/hpc/timing/timer.c -DTIMER_WITH_MPI -fopenmp -O2 -Wall -std=c99 -o ~/hpc/reduce/allreduce_bench -lm
+# run
+export OMP_NUM_THREADS=2
+mpirun.actual -n 16 ~/hpc/reduce/allreduce_bench
\ No newline at end of file
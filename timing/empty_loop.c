@@ -0,0 +1,43 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "timer.h"
+
+// Overhead and resolution of every clock, then the cost of an empty loop.
+// The loop counter escapes on every iteration, so the compiler has to keep
+// the loop even at -O3; what is timed is one increment and compare per
+// iteration.
+
+static void empty_loop(void* arg) {
+    long iterations = *(long*)arg;
+    for (long i = 0; i < iterations; i++) {
+        timer_escape(&i);  // Empty loop body
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("USAGE: %s loop-iterations [repetitions]\n", argv[0]);
+        return 1;
+    }
+
+    long iterations = atol(argv[1]);
+    int repetitions = argc > 2 ? atoi(argv[2]) : 31;
+
+    for (int s = 0; s < TIMER_NUM_SOURCES; s++) {
+        if (!timer_init((TimerSource)s)) continue;
+        TimerProperties properties = timer_measure();
+        printf("%-14s overhead %8.2f ns, resolution %8.2f ns\n",
+               timer_source_name((TimerSource)s), properties.overhead * 1e9,
+               properties.resolution * 1e9);
+    }
+    timer_init(TIMER_MONOTONIC);
+
+    TimerStats stats = timer_repeat(empty_loop, &iterations, 1, repetitions);
+    timer_print_stats("empty loop", &stats, 1e6, "us");
+    if (iterations > 0) {
+        printf("%.3f ns per iteration\n", stats.median * 1e9 / iterations);
+    }
+
+    return 0;
+}
\ No newline at end of file
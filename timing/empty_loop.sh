@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o -O3 on purpose: the loop has to survive the optimizer
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:01:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=1:mem=2gb
+
+# build
+gcc ~/hpc/timing/empty_loop.c ~/hpc/timing/timer.c -O3 -Wall -std=c99 -o ~/hpc/timing/empty_loop -lm
+# run
+~/hpc/timing/empty_loop 100000000
\ No newline at end of file
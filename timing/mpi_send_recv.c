@@ -1,65 +1,75 @@
-#include <limits.h>
 #include <mpi.h>
 #include <stdio.h>
-#include <sys/time.h>
+#include <stdlib.h>
 
-#define US_PER_S 1000000.0
+#include "timer.h"
 
-double get_timespan_s(struct timeval *start, struct timeval *end) {
-    double timespan;
+// Round trips of 1 int up to 64 Mi ints (256 MB) between ranks 0 and 1.
+// The buffer is allocated once; every size is repeated and the median
+// round trip (with its 95% confidence interval) gives the bandwidth.
+//
+// The bandwidth is one way: the message size over half the round trip,
+// 2 * bytes / median. Runs from before the shared timer module printed
+// bytes / (2 * round trip), a quarter of this figure; multiply old
+// numbers by 4 to compare them.
 
-    // Get the number of seconds, express it in microseconds
-    timespan = (end->tv_sec - start->tv_sec) * US_PER_S;
-    // Now add the microseconds
-    timespan = (timespan + (end->tv_usec - start->tv_usec));
-
-    return timespan / US_PER_S;
-}
+#define MAX_COUNT (1L << 26)
+#define REPETITIONS 21
 
 int main() {
     int id, n;
-
-    struct timeval start, end;
-    double time_taken, bandwidth;
-
-    int *v;
+    double samples[REPETITIONS];
 
     MPI_Init(NULL, NULL);
 
     MPI_Comm_rank(MPI_COMM_WORLD, &id);
     MPI_Comm_size(MPI_COMM_WORLD, &n);
 
-    if (id == 0) {
-        printf("%-15s %-15s %-20s\n", "n", "time (sec)", "bandwidth (B/s)");
+    if (n < 2) {
+        if (id == 0) printf("Error: needs 2 processes\n");
+        MPI_Finalize();
+        return 1;
     }
-    for (int i = 1; i < INT_MAX; i = i * 2) {
-        if (id == 0) {
-            v = malloc(i * (sizeof(int)));
-
-            gettimeofday(&start, NULL);
-
-            MPI_Send(v, i, MPI_INT, 1, 0, MPI_COMM_WORLD);
-            MPI_Recv(v, i, MPI_INT, 1, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-
-            gettimeofday(&end, NULL);
+    timer_init(TIMER_MPI);
 
-            free(v);
-
-            time_taken = get_timespan_s(&start, &end);
-
-            bandwidth = ((i * (sizeof(int))) / time_taken) / 2.0;
-
-            printf("%-15d %-15.6f %-12.6f\n", i, time_taken, bandwidth);
-        } else {
-            v = malloc(i * (sizeof(int)));
+    int* v = calloc(MAX_COUNT, sizeof(int));
+    if (!v) {
+        printf("Error: could not allocate %ld ints on process %d\n",
+               MAX_COUNT, id);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
-            MPI_Recv(v, i, MPI_INT, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
-            MPI_Send(v, i, MPI_INT, 0, 0, MPI_COMM_WORLD);
+    if (id == 0) {
+        printf("%-12s %-14s %-27s %-20s\n", "n", "median (sec)",
+               "95% CI (sec)", "bandwidth (B/s)");
+    }
+    for (long i = 1; i <= MAX_COUNT; i = i * 2) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        for (int r = -1; r < REPETITIONS; r++) {  // r = -1 is the warmup
+            if (id == 0) {
+                double start = timer_now();
+
+                MPI_Send(v, (int)i, MPI_INT, 1, 0, MPI_COMM_WORLD);
+                MPI_Recv(v, (int)i, MPI_INT, 1, 0, MPI_COMM_WORLD,
+                         MPI_STATUS_IGNORE);
+
+                if (r >= 0) samples[r] = timer_now() - start;
+            } else if (id == 1) {
+                MPI_Recv(v, (int)i, MPI_INT, 0, 0, MPI_COMM_WORLD,
+                         MPI_STATUS_IGNORE);
+                MPI_Send(v, (int)i, MPI_INT, 0, 0, MPI_COMM_WORLD);
+            }
+        }
 
-            free(v);
+        if (id == 0) {
+            TimerStats stats = timer_stats(samples, REPETITIONS);
+            double bandwidth = ((i * (sizeof(int))) / stats.median) * 2.0;
+            printf("%-12ld %-14.6f [%-11.6f, %-11.6f] %-12.1f\n", i,
+                   stats.median, stats.ci_low, stats.ci_high, bandwidth);
         }
     }
 
+    free(v);
     MPI_Finalize();
     return 0;
-}
+}
\ No newline at end of file
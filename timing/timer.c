@@ -0,0 +1,204 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+
+#include "timer.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef TIMER_WITH_MPI
+#include <mpi.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define TIMER_HAVE_TSC 1
+#else
+#define TIMER_HAVE_TSC 0
+#endif
+
+#define TSC_CALIBRATION_S 0.02
+#define OVERHEAD_CALLS 1001
+#define RESOLUTION_READS 100000
+
+static TimerSource g_source = TIMER_MONOTONIC;
+static double g_seconds_per_tick = 0.0;  // TSC only
+
+static double monotonic_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#if TIMER_HAVE_TSC
+static unsigned long long read_tsc(void) {
+    _mm_lfence();  // do not let the read move before earlier instructions
+    return __rdtsc();
+}
+
+// The TSC ticks at a constant rate regardless of frequency scaling and
+// sleep states only when CPUID reports it invariant
+static bool tsc_is_invariant(void) {
+    unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) ||
+        eax < 0x80000007) {
+        return false;
+    }
+    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx);
+    return (edx >> 8) & 1;
+}
+
+static bool calibrate_tsc(void) {
+    if (!tsc_is_invariant()) return false;
+    double start = monotonic_now(), end = start;
+    unsigned long long start_ticks = read_tsc(), end_ticks = start_ticks;
+    while (end - start < TSC_CALIBRATION_S) {
+        end = monotonic_now();
+        end_ticks = read_tsc();
+    }
+    if (end_ticks <= start_ticks) return false;
+    g_seconds_per_tick = (end - start) / (double)(end_ticks - start_ticks);
+    return true;
+}
+#endif
+
+bool timer_init(TimerSource source) {
+    switch (source) {
+        case TIMER_MONOTONIC:
+            break;
+        case TIMER_TSC:
+#if TIMER_HAVE_TSC
+            if (!calibrate_tsc()) return false;
+            break;
+#else
+            return false;
+#endif
+        case TIMER_MPI:
+#ifdef TIMER_WITH_MPI
+            break;
+#else
+            return false;
+#endif
+        default:
+            return false;
+    }
+    g_source = source;
+    return true;
+}
+
+TimerSource timer_source(void) { return g_source; }
+
+const char* timer_source_name(TimerSource source) {
+    switch (source) {
+        case TIMER_MONOTONIC:
+            return "clock_gettime";
+        case TIMER_TSC:
+            return "tsc";
+        case TIMER_MPI:
+            return "MPI_Wtime";
+        default:
+            return "unknown";
+    }
+}
+
+double timer_now(void) {
+#if TIMER_HAVE_TSC
+    if (g_source == TIMER_TSC) return read_tsc() * g_seconds_per_tick;
+#endif
+#ifdef TIMER_WITH_MPI
+    if (g_source == TIMER_MPI) return MPI_Wtime();
+#endif
+    return monotonic_now();
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+TimerProperties timer_measure(void) {
+    TimerProperties properties = {0.0, 0.0};
+
+    // Median of single back-to-back differences: robust against the
+    // interrupts that hit some of them
+    double deltas[OVERHEAD_CALLS];
+    for (int i = 0; i < OVERHEAD_CALLS; i++) {
+        double start = timer_now();
+        deltas[i] = timer_now() - start;
+    }
+    qsort(deltas, OVERHEAD_CALLS, sizeof(double), compare_doubles);
+    properties.overhead = deltas[OVERHEAD_CALLS / 2];
+
+    double previous = timer_now(), smallest = 0.0;
+    for (int i = 0; i < RESOLUTION_READS; i++) {
+        double now = timer_now();
+        double step = now - previous;
+        if (step > 0 && (smallest == 0.0 || step < smallest)) smallest = step;
+        previous = now;
+    }
+    properties.resolution = smallest;
+    return properties;
+}
+
+TimerStats timer_stats(double* samples, int n) {
+    TimerStats stats = {0};
+    if (n <= 0) return stats;
+    qsort(samples, n, sizeof(double), compare_doubles);
+
+    double sum = 0.0, squares = 0.0;
+    for (int i = 0; i < n; i++) sum += samples[i];
+    stats.mean = sum / n;
+    for (int i = 0; i < n; i++) {
+        squares += (samples[i] - stats.mean) * (samples[i] - stats.mean);
+    }
+    stats.n = n;
+    stats.min = samples[0];
+    stats.max = samples[n - 1];
+    stats.median = n % 2 ? samples[n / 2]
+                         : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats.stddev = n > 1 ? sqrt(squares / (n - 1)) : 0.0;
+
+    // The median lies between the order statistics n/2 -+ 1.96 sqrt(n)/2
+    // with 95% probability (normal approximation of the binomial)
+    double half_width = 1.96 * sqrt((double)n) / 2;
+    int low = (int)floor(n / 2.0 - half_width);
+    int high = (int)ceil(n / 2.0 + half_width);
+    if (low < 0) low = 0;
+    if (high > n - 1) high = n - 1;
+    stats.ci_low = samples[low];
+    stats.ci_high = samples[high];
+    return stats;
+}
+
+TimerStats timer_repeat(void (*kernel)(void*), void* arg, int warmup,
+                        int repetitions) {
+    TimerStats stats = {0};
+    if (repetitions < 1) return stats;
+    double* samples = malloc(sizeof(double) * repetitions);
+    if (!samples) return stats;
+
+    double overhead = timer_measure().overhead;
+    for (int i = 0; i < warmup; i++) kernel(arg);
+    for (int i = 0; i < repetitions; i++) {
+        double start = timer_now();
+        kernel(arg);
+        timer_clobber();
+        double elapsed = timer_now() - start - overhead;
+        samples[i] = elapsed > 0 ? elapsed : 0.0;
+    }
+
+    stats = timer_stats(samples, repetitions);
+    free(samples);
+    return stats;
+}
+
+void timer_print_stats(const char* label, const TimerStats* stats,
+                       double scale, const char* unit) {
+    printf("%s: median %.3f %s [%.3f, %.3f], min %.3f, mean %.3f "
+           "+- %.3f, n %d\n",
+           label, stats->median * scale, unit, stats->ci_low * scale,
+           stats->ci_high * scale, stats->min * scale, stats->mean * scale,
+           stats->stddev * scale, stats->n);
+}
@@ -0,0 +1,76 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdbool.h>
+
+// Shared timing module of all programs in the repository.
+//
+// timer_now() reads the selected clock in seconds from an arbitrary origin:
+//   TIMER_MONOTONIC  clock_gettime(CLOCK_MONOTONIC), the default
+//   TIMER_TSC        time stamp counter of x86 CPUs with an invariant TSC,
+//                    calibrated against the monotonic clock
+//   TIMER_MPI        MPI_Wtime, only when timer.c is built with
+//                    -DTIMER_WITH_MPI
+// The source is process-wide; select it once before starting threads.
+
+typedef enum {
+    TIMER_MONOTONIC = 0,
+    TIMER_TSC,
+    TIMER_MPI,
+    TIMER_NUM_SOURCES
+} TimerSource;
+
+// Select the clock behind timer_now; false (and no change) when `source` is
+// not available on this machine or build. Selecting the TSC takes ~20 ms.
+bool timer_init(TimerSource source);
+
+TimerSource timer_source(void);
+const char* timer_source_name(TimerSource source);
+
+double timer_now(void);
+
+// Cost of one timer_now call and smallest step it can report, in seconds
+typedef struct {
+    double overhead;    // median over many back-to-back calls
+    double resolution;  // smallest nonzero difference of consecutive reads
+} TimerProperties;
+
+TimerProperties timer_measure(void);
+
+// Optimization barriers: timer_escape makes the compiler assume that `p`
+// (and whatever it points to) is read and written by unknown code, so that
+// computations whose result is only stored there are not deleted.
+// timer_clobber forces every pending store to memory.
+static inline void timer_escape(void* p) {
+    __asm__ volatile("" : : "g"(p) : "memory");
+}
+
+static inline void timer_clobber(void) { __asm__ volatile("" : : : "memory"); }
+
+// Summary of repeated measurements, in the unit of the samples
+typedef struct {
+    int n;
+    double min;
+    double median;
+    double mean;
+    double max;
+    double stddev;
+    double ci_low;   // 95% confidence interval of the median, from the
+    double ci_high;  // order statistics (no normality assumed)
+} TimerStats;
+
+// Statistics of `n` samples; sorts `samples` in place
+TimerStats timer_stats(double* samples, int n);
+
+// Time `repetitions` calls of `kernel(arg)` after `warmup` untimed calls;
+// samples are in seconds, minus the timer overhead. n is 0 when the sample
+// buffer cannot be allocated.
+TimerStats timer_repeat(void (*kernel)(void*), void* arg, int warmup,
+                        int repetitions);
+
+// One line "label: median x [ci_low, ci_high], min y, n z" with the values
+// multiplied by `scale` (1e6 prints seconds as microseconds)
+void timer_print_stats(const char* label, const TimerStats* stats,
+                       double scale, const char* unit);
+
+#endif  // TIMER_H
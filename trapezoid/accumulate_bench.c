@@ -0,0 +1,215 @@
+#include <math.h>
+#include <omp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+
+// The trapezoid sum of f(x) = x * x from omp.c, omp_reduction.c and
+// omp_return.c under every way of accumulating the contributions of the
+// threads, for thread counts 1, 2, 4, ... and sizes 10^3, 10^4, ...
+//
+//   accumulate_bench [-m max trapezoids] [-t max threads] [-r repetitions]
+//
+// Every trapezoid is one update of the accumulator. Times are the median
+// over the repetitions, in nanoseconds per update (wall time / updates).
+// The per-thread slots are updated through volatile pointers, so that every
+// update reaches memory; otherwise the compiler keeps the sum in a register
+// and padded and unpadded slots cannot be told apart.
+
+#define DEFAULT_MAX_TRAPEZOIDS 10000000
+#define DEFAULT_REPETITIONS 5
+#define MIN_TRAPEZOIDS 1000
+#define MAX_THREADS 256
+#define CACHE_LINE 64
+
+typedef enum {
+    CRITICAL = 0,  // omp critical around every update
+    ATOMIC,        // omp atomic update
+    REDUCTION,     // reduction(+ : sum) clause
+    SLOTS,         // one double per thread, adjacent: false sharing
+    PADDED_SLOTS,  // one cache line per thread
+    TREE,          // padded slots combined pairwise in log2(p) rounds
+    NUM_STRATEGIES
+} Strategy;
+
+static const char* STRATEGY_NAMES[NUM_STRATEGIES] = {
+    "critical", "atomic", "reduction", "slots", "padded slots", "tree"};
+
+typedef struct {
+    double value;
+} __attribute__((aligned(CACHE_LINE))) PaddedSlot;
+
+static double g_slots[MAX_THREADS];
+static PaddedSlot g_padded[MAX_THREADS];
+
+typedef struct {
+    Strategy strategy;
+    int n_threads;
+    long long n_trapezoids;
+    double a, b;
+    double result;
+} Run;
+
+static double f(double x) { return x * x; }
+
+// Sums of the inner points of the trapezoid rule, a + i * h for i in
+// [1, n), one function per strategy
+
+static double critical_sum(double a, double h, long long n, int n_threads) {
+    double sum = 0.0;
+#pragma omp parallel for num_threads(n_threads)
+    for (long long i = 1; i < n; i++) {
+        double value = f(a + i * h);
+#pragma omp critical
+        sum += value;
+    }
+    return sum;
+}
+
+static double atomic_sum(double a, double h, long long n, int n_threads) {
+    double sum = 0.0;
+#pragma omp parallel for num_threads(n_threads)
+    for (long long i = 1; i < n; i++) {
+        double value = f(a + i * h);
+#pragma omp atomic
+        sum += value;
+    }
+    return sum;
+}
+
+static double reduction_sum(double a, double h, long long n, int n_threads) {
+    double sum = 0.0;
+#pragma omp parallel for num_threads(n_threads) reduction(+ : sum)
+    for (long long i = 1; i < n; i++) sum += f(a + i * h);
+    return sum;
+}
+
+static double slots_sum(double a, double h, long long n, int n_threads) {
+#pragma omp parallel num_threads(n_threads)
+    {
+        volatile double* slot = &g_slots[omp_get_thread_num()];
+        *slot = 0.0;
+#pragma omp for
+        for (long long i = 1; i < n; i++) *slot += f(a + i * h);
+    }
+    double sum = 0.0;
+    for (int t = 0; t < n_threads; t++) sum += g_slots[t];
+    return sum;
+}
+
+static double padded_sum(double a, double h, long long n, int n_threads,
+                         bool tree) {
+#pragma omp parallel num_threads(n_threads)
+    {
+        int id = omp_get_thread_num();
+        volatile double* slot = &g_padded[id].value;
+        *slot = 0.0;
+#pragma omp for
+        for (long long i = 1; i < n; i++) *slot += f(a + i * h);
+
+        // The barrier of the loop completes every slot; in the round of
+        // `stride` thread id adds the slot of id + stride to its own
+        for (int stride = 1; tree && stride < n_threads; stride *= 2) {
+            if (id % (2 * stride) == 0 && id + stride < n_threads) {
+                g_padded[id].value += g_padded[id + stride].value;
+            }
+#pragma omp barrier
+        }
+    }
+    if (tree) return g_padded[0].value;
+    double sum = 0.0;
+    for (int t = 0; t < n_threads; t++) sum += g_padded[t].value;
+    return sum;
+}
+
+static double inner_sum(const Run* run) {
+    long long n = run->n_trapezoids;
+    double h = (run->b - run->a) / n;
+    switch (run->strategy) {
+        case CRITICAL:
+            return critical_sum(run->a, h, n, run->n_threads);
+        case ATOMIC:
+            return atomic_sum(run->a, h, n, run->n_threads);
+        case REDUCTION:
+            return reduction_sum(run->a, h, n, run->n_threads);
+        case SLOTS:
+            return slots_sum(run->a, h, n, run->n_threads);
+        case PADDED_SLOTS:
+            return padded_sum(run->a, h, n, run->n_threads, false);
+        case TREE:
+            return padded_sum(run->a, h, n, run->n_threads, true);
+        default:
+            return 0.0;
+    }
+}
+
+static void trapezoid(void* arg) {
+    Run* run = arg;
+    double h = (run->b - run->a) / run->n_trapezoids;
+    run->result = h * ((f(run->a) + f(run->b)) / 2.0 + inner_sum(run));
+    timer_escape(&run->result);
+}
+
+// 1, 2, 4, ... and max_threads itself
+static int next_thread_count(int threads, int max_threads) {
+    if (threads < max_threads && 2 * threads > max_threads) {
+        return max_threads;
+    }
+    return 2 * threads;
+}
+
+int main(int argc, char* argv[]) {
+    long long max_trapezoids = DEFAULT_MAX_TRAPEZOIDS;
+    int max_threads = omp_get_max_threads();
+    int repetitions = DEFAULT_REPETITIONS;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            max_trapezoids = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            max_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repetitions = atoi(argv[++i]);
+        }
+    }
+    if (max_trapezoids < MIN_TRAPEZOIDS) max_trapezoids = MIN_TRAPEZOIDS;
+    if (max_threads < 1 || max_threads > MAX_THREADS) {
+        max_threads = max_threads < 1 ? omp_get_max_threads() : MAX_THREADS;
+    }
+    if (repetitions < 1) repetitions = DEFAULT_REPETITIONS;
+    timer_init(TIMER_TSC);
+
+    printf("trapezoid sum of x * x on [-1, 1], median of %d runs, %d cores\n",
+           repetitions, omp_get_num_procs());
+    printf("ns per update (WRONG: differs from the reduction clause)\n");
+
+    for (long long n = MIN_TRAPEZOIDS; n <= max_trapezoids; n *= 10) {
+        printf("\n%12s %8s", "trapezoids", "threads");
+        for (int s = 0; s < NUM_STRATEGIES; s++) {
+            printf(" %12s", STRATEGY_NAMES[s]);
+        }
+        printf("\n");
+        for (int threads = 1; threads <= max_threads;
+             threads = next_thread_count(threads, max_threads)) {
+            Run reference = {REDUCTION, threads, n, -1.0, 1.0, 0.0};
+            trapezoid(&reference);
+            printf("%12lld %8d", n, threads);
+            for (int s = 0; s < NUM_STRATEGIES; s++) {
+                Run run = {(Strategy)s, threads, n, -1.0, 1.0, 0.0};
+                TimerStats stats = timer_repeat(trapezoid, &run, 1,
+                                                repetitions);
+                if (fabs(run.result - reference.result) > 1e-9) {
+                    printf(" %12s", "WRONG");
+                } else {
+                    printf(" %12.2f", stats.median / n * 1e9);
+                }
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
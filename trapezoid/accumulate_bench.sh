@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o the whole chunk for one process, so that thread counts up to 16 run on
+#   their own cores
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:20:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=16:mem=1gb
+
+# get dependencies
+module load openmpi-4.0.4
+# build
+gcc ~/hpc/trapezoid/accumulate_bench.c ~/hpc/timing/timer.c -O2 -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/accumulate_bench -lm
+# run
+export OMP_PROC_BIND=close
+export OMP_PLACES=cores
+~/hpc/trapezoid/accumulate_bench -t 16
\ No newline at end of file
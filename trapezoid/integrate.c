@@ -0,0 +1,169 @@
+#include <math.h>
+#include <omp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../timing/timer.h"
+#include "quadrature.h"
+
+// Integrate one of the functions below with every method of quadrature.c
+// and compare with the exact value.
+//
+//   integrate [-f function] [-a left] [-b right] [-n intervals]
+//             [-e tolerance] [-p threads]
+//
+// The uniform rules use n intervals, the adaptive one the tolerance.
+
+#define DEFAULT_INTERVALS 1000000
+#define DEFAULT_TOLERANCE 1e-10
+#define PEAK_CENTER 0.3
+#define PEAK_WIDTH 0.01
+#define FREQUENCY 50.0
+
+static double square(double x, const void* params) {
+    (void)params;
+    return x * x;
+}
+
+static void square_batch(const double* x, double* y, int n,
+                         const void* params) {
+    (void)params;
+#pragma omp simd
+    for (int i = 0; i < n; i++) y[i] = x[i] * x[i];
+}
+
+static double square_integral(double x) { return x * x * x / 3; }
+
+// Unbounded derivative at 0: the uniform rules converge slowly there
+static double root(double x, const void* params) {
+    (void)params;
+    return sqrt(x);
+}
+
+static void root_batch(const double* x, double* y, int n,
+                       const void* params) {
+    (void)params;
+#pragma omp simd
+    for (int i = 0; i < n; i++) y[i] = sqrt(x[i]);
+}
+
+static double root_integral(double x) { return 2.0 / 3.0 * x * sqrt(x); }
+
+// Narrow peak at PEAK_CENTER: almost all the work of the adaptive rule
+// ends up in a small part of the interval
+static double peak(double x, const void* params) {
+    (void)params;
+    double d = x - PEAK_CENTER;
+    return 1.0 / (PEAK_WIDTH * PEAK_WIDTH + d * d);
+}
+
+static void peak_batch(const double* x, double* y, int n,
+                       const void* params) {
+    (void)params;
+#pragma omp simd
+    for (int i = 0; i < n; i++) {
+        double d = x[i] - PEAK_CENTER;
+        y[i] = 1.0 / (PEAK_WIDTH * PEAK_WIDTH + d * d);
+    }
+}
+
+static double peak_integral(double x) {
+    return atan((x - PEAK_CENTER) / PEAK_WIDTH) / PEAK_WIDTH;
+}
+
+// No batch version: evaluated one point at a time
+static double oscillating(double x, const void* params) {
+    (void)params;
+    double s = sin(FREQUENCY * x);
+    return s * s;
+}
+
+static double oscillating_integral(double x) {
+    return x / 2 - sin(2 * FREQUENCY * x) / (4 * FREQUENCY);
+}
+
+typedef struct {
+    const char* name;
+    Integrand integrand;
+    double (*integral)(double x);  // antiderivative, for the exact value
+    double a, b;                   // default interval
+} Function;
+
+static const Function FUNCTIONS[] = {
+    {"square", {square, square_batch, NULL}, square_integral, -1, 1},
+    {"sqrt", {root, root_batch, NULL}, root_integral, 0, 1},
+    {"peak", {peak, peak_batch, NULL}, peak_integral, 0, 1},
+    {"oscillating", {oscillating, NULL, NULL}, oscillating_integral, 0, 1},
+};
+
+#define N_FUNCTIONS (int)(sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]))
+
+int main(int argc, char* argv[]) {
+    const Function* function = &FUNCTIONS[0];
+    long long n_intervals = DEFAULT_INTERVALS;
+    double tolerance = DEFAULT_TOLERANCE;
+    int n_threads = omp_get_max_threads();
+    const char* a_arg = NULL;
+    const char* b_arg = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            function = NULL;
+            for (int k = 0; k < N_FUNCTIONS; k++) {
+                if (strcmp(FUNCTIONS[k].name, name) == 0) {
+                    function = &FUNCTIONS[k];
+                }
+            }
+            if (!function) {
+                printf("Error: unknown function %s (", name);
+                for (int k = 0; k < N_FUNCTIONS; k++) {
+                    printf("%s%s", k ? ", " : "", FUNCTIONS[k].name);
+                }
+                printf(")\n");
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+            a_arg = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            b_arg = argv[++i];
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            n_intervals = atoll(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            n_threads = atoi(argv[++i]);
+        }
+    }
+    double a = a_arg ? atof(a_arg) : function->a;
+    double b = b_arg ? atof(b_arg) : function->b;
+    if (n_intervals < 1) n_intervals = DEFAULT_INTERVALS;
+    if (tolerance <= 0) tolerance = DEFAULT_TOLERANCE;
+    if (n_threads < 1) n_threads = omp_get_max_threads();
+
+    double exact = function->integral(b) - function->integral(a);
+    printf("%s from %g to %g = %.15e, %d threads\n", function->name, a, b,
+           exact, n_threads);
+    printf("%lld intervals for the uniform rules, tolerance %g\n\n",
+           n_intervals, tolerance);
+    printf("%10s %22s %10s %10s %12s %10s\n", "method", "value", "error",
+           "estimate", "evaluations", "time [s]");
+
+    for (int m = 0; m < QUADRATURE_NUM_METHODS; m++) {
+        QuadratureMethod method = (QuadratureMethod)m;
+        double start = timer_now();
+        QuadratureResult result =
+            method == QUADRATURE_ADAPTIVE
+                ? integrate_adaptive(&function->integrand, a, b, tolerance,
+                                     n_threads)
+                : integrate_uniform(&function->integrand, a, b, n_intervals,
+                                    method, n_threads);
+        double elapsed = timer_now() - start;
+        printf("%10s %22.15e %10.2e %10.2e %12lld %10.6f\n",
+               quadrature_method_name(method), result.value,
+               fabs(result.value - exact), result.error, result.evaluations,
+               elapsed);
+    }
+    return 0;
+}
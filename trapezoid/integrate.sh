@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# Notes
+# -----
+# o absolute paths for consistency across nodes
+# o every function on its default interval, with 8 threads and 1 thread
+
+# max walltime 6h
+#PBS -q short_cpuQ
+# expected timespan for execution
+#PBS -l walltime=00:05:00
+# chunks (~nodes) : cores per chunk : shared memory per chunk (?)
+#PBS -l select=1:ncpus=8:mem=1gb
+
+# get dependencies
+module load openmpi-4.0.4
+# build
+gcc ~/hpc/trapezoid/integrate.c ~/hpc/trapezoid/quadrature.c ~/hpc/timing/timer.c -O3 -march=native -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/integrate -lm
+# run
+for function in square sqrt peak oscillating; do
+    ~/hpc/trapezoid/integrate -f $function -n 100000000 -e 1e-12 -p 8
+    ~/hpc/trapezoid/integrate -f $function -n 100000000 -e 1e-12 -p 1
+done
\ No newline at end of file
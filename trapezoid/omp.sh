@@ -16,7 +16,7 @@
 module load openmpi-4.0.4
 # build
 # mpicc ~/hpc/trapezoid/omp.c -g -Wall -std=c99 -o ~/hpc/trapezoid/omp
-gcc ~/hpc/trapezoid/omp.c -g -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/omp
+gcc ~/hpc/trapezoid/omp.c ~/hpc/timing/timer.c -g -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/omp -lm
 # run
 # mpirun.actual -n 4 ~/hpc/trapezoid/omp
 ~/hpc/trapezoid/omp 4
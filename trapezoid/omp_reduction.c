@@ -2,21 +2,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../timing/timer.h"
+
 // Mathematical function that you want to integrate using the trapezoidal rule
 double f(double x) { return x * x; }
 
 double trapezoid(double endpoint_l, double endpoint_r, int n_trapezoids) {
     double h, x, result_thread;
     double local_a, local_b;
-    int i, local_n;
+    int i, local_first, local_n;
     int id_thread = omp_get_thread_num();
     int n_threads = omp_get_num_threads();
 
     h = (endpoint_r - endpoint_l) / n_trapezoids;
-    local_n = n_trapezoids / n_threads;
-    local_a = endpoint_l + id_thread * local_n * h;
+    // Block t spans [n * t / T, n * (t + 1) / T): sizes differ by at most one
+    local_first = (int)((long long)n_trapezoids * id_thread / n_threads);
+    local_n = (int)((long long)n_trapezoids * (id_thread + 1) / n_threads) -
+              local_first;
+    local_a = endpoint_l + local_first * h;
     local_b = local_a + local_n * h;
-    result_thread = (f(local_a) + f(local_b)) / 2.0;
+    result_thread = local_n > 0 ? (f(local_a) + f(local_b)) / 2.0 : 0.0;
 
     for (i = 1; i <= local_n - 1; i++) {
         x = local_a + i * h;
@@ -38,13 +43,16 @@ int main(int argc, char* argv[]) {
     // printf("Enter left, right endpoint and total number of trapezoids\n");
     // scanf("%lf %lf %d", &endpoint_l, &endpoint_r, &n_trapezoids);
 
+    double start = timer_now();
 #pragma omp parallel num_threads(n_threads) reduction(+ : result_global)
     result_global += trapezoid(endpoint_l, endpoint_r, n_trapezoids);
+    double elapsed = timer_now() - start;
 
     printf("With total number of trapezoids = %d, our estimate\n",
            n_trapezoids);
     printf("of the integral from %f to %f = %.14e\n", endpoint_l, endpoint_r,
            result_global);
+    printf("Elapsed time: %.6f s\n", elapsed);
 
     return 0;
 }
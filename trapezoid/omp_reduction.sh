@@ -16,7 +16,7 @@
 module load openmpi-4.0.4
 # build
 # mpicc ~/hpc/trapezoid/omp_reduction.c -g -Wall -std=c99 -o ~/hpc/trapezoid/omp_reduction
-gcc ~/hpc/trapezoid/omp_reduction.c -g -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/omp_reduction
+gcc ~/hpc/trapezoid/omp_reduction.c ~/hpc/timing/timer.c -g -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/omp_reduction -lm
 # run
 # mpirun.actual -n 4 ~/hpc/trapezoid/omp_reduction
 ~/hpc/trapezoid/omp_reduction 4
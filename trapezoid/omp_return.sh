@@ -16,7 +16,7 @@
 module load openmpi-4.0.4
 # build
 # mpicc ~/hpc/trapezoid/omp_return.c -g -Wall -std=c99 -o ~/hpc/trapezoid/omp_return
-gcc ~/hpc/trapezoid/omp_return.c -g -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/omp_return
+gcc ~/hpc/trapezoid/omp_return.c ~/hpc/timing/timer.c -g -Wall -fopenmp -std=c99 -o ~/hpc/trapezoid/omp_return -lm
 # run
 # mpirun.actual -n 4 ~/hpc/trapezoid/omp_return
 ~/hpc/trapezoid/omp_return 4
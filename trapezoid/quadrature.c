@@ -0,0 +1,157 @@
+#include "quadrature.h"
+
+#include <math.h>
+#include <omp.h>
+
+#define BLOCK 256            // points evaluated and summed at once
+#define PANELS 16            // adaptive: equal panels refined independently
+#define MAX_DEPTH 50         // adaptive: halvings of a panel at most
+#define TASK_DEPTH 16        // adaptive: deeper halves run in their parent
+
+static void evaluate(const Integrand* f, const double* x, double* y, int n) {
+    if (f->f_batch) {
+        f->f_batch(x, y, n, f->params);
+        return;
+    }
+    for (int i = 0; i < n; i++) y[i] = f->f(x[i], f->params);
+}
+
+// Sum of f(start + i * h) over i in [first, last)
+static double sum_points(const Integrand* f, double start, double h,
+                         long long first, long long last, int n_threads) {
+    long long n_blocks = (last - first + BLOCK - 1) / BLOCK;
+    double sum = 0.0;
+
+#pragma omp parallel for num_threads(n_threads) reduction(+ : sum)
+    for (long long block = 0; block < n_blocks; block++) {
+        double x[BLOCK], y[BLOCK];
+        long long begin = first + block * BLOCK;
+        int n = last - begin < BLOCK ? (int)(last - begin) : BLOCK;
+
+#pragma omp simd
+        for (int i = 0; i < n; i++) x[i] = start + (double)(begin + i) * h;
+        evaluate(f, x, y, n);
+
+        double block_sum = 0.0;
+#pragma omp simd reduction(+ : block_sum)
+        for (int i = 0; i < n; i++) block_sum += y[i];
+        sum += block_sum;
+    }
+    return sum;
+}
+
+QuadratureResult integrate_uniform(const Integrand* f, double a, double b,
+                                   long long n_intervals,
+                                   QuadratureMethod method, int n_threads) {
+    QuadratureResult result = {0.0, 0.0, 0};
+    if (n_intervals < 1 || method == QUADRATURE_ADAPTIVE ||
+        method < 0 || method >= QUADRATURE_NUM_METHODS) {
+        return result;
+    }
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+
+    double h = (b - a) / n_intervals;
+    double ends = f->f(a, f->params) + f->f(b, f->params);
+    double nodes = sum_points(f, a, h, 1, n_intervals, n_threads);
+    if (method == QUADRATURE_TRAPEZOID) {
+        result.value = h * (ends / 2 + nodes);
+        result.evaluations = n_intervals + 1;
+    } else {
+        double midpoints = sum_points(f, a + h / 2, h, 0, n_intervals,
+                                      n_threads);
+        result.value = h / 6 * (ends + 2 * nodes + 4 * midpoints);
+        result.evaluations = 2 * n_intervals + 1;
+    }
+    return result;
+}
+
+// Refine [a, b], whose Simpson estimate from fa, fm and fb is `whole`. The
+// two halves are summed left + right whatever thread computed them, which
+// keeps the result independent of the schedule.
+static QuadratureResult adaptive_simpson(const Integrand* f, double a,
+                                         double b, double fa, double fm,
+                                         double fb, double whole,
+                                         double tolerance, int depth) {
+    double m = (a + b) / 2;
+    double x[2] = {(a + m) / 2, (m + b) / 2}, y[2];
+    evaluate(f, x, y, 2);
+    double left = (m - a) / 6 * (fa + 4 * y[0] + fm);
+    double right = (b - m) / 6 * (fm + 4 * y[1] + fb);
+    double delta = left + right - whole;
+
+    QuadratureResult result = {0.0, 0.0, 2};
+    if (fabs(delta) <= 15 * tolerance || depth >= MAX_DEPTH) {
+        // Richardson extrapolation; the difference estimates the error
+        result.value = left + right + delta / 15;
+        result.error = fabs(delta) / 15;
+        return result;
+    }
+
+    QuadratureResult l, r;
+    if (depth < TASK_DEPTH) {
+#pragma omp task shared(l)
+        l = adaptive_simpson(f, a, m, fa, y[0], fm, left, tolerance / 2,
+                             depth + 1);
+        r = adaptive_simpson(f, m, b, fm, y[1], fb, right, tolerance / 2,
+                             depth + 1);
+#pragma omp taskwait
+    } else {
+        l = adaptive_simpson(f, a, m, fa, y[0], fm, left, tolerance / 2,
+                             depth + 1);
+        r = adaptive_simpson(f, m, b, fm, y[1], fb, right, tolerance / 2,
+                             depth + 1);
+    }
+    result.value = l.value + r.value;
+    result.error = l.error + r.error;
+    result.evaluations += l.evaluations + r.evaluations;
+    return result;
+}
+
+QuadratureResult integrate_adaptive(const Integrand* f, double a, double b,
+                                    double tolerance, int n_threads) {
+    if (n_threads <= 0) n_threads = omp_get_max_threads();
+
+    // Starting from several panels keeps a few samples from missing a
+    // feature of f altogether
+    double x[2 * PANELS + 1], y[2 * PANELS + 1];
+    double h = (b - a) / PANELS;
+    for (int i = 0; i <= 2 * PANELS; i++) x[i] = a + i * h / 2;
+    x[2 * PANELS] = b;
+    evaluate(f, x, y, 2 * PANELS + 1);
+
+    QuadratureResult panels[PANELS];
+#pragma omp parallel num_threads(n_threads)
+#pragma omp single
+    for (int p = 0; p < PANELS; p++) {
+#pragma omp task
+        {
+            const double* fp = y + 2 * p;
+            double whole = (x[2 * p + 2] - x[2 * p]) / 6 *
+                           (fp[0] + 4 * fp[1] + fp[2]);
+            panels[p] = adaptive_simpson(f, x[2 * p], x[2 * p + 2], fp[0],
+                                         fp[1], fp[2], whole,
+                                         tolerance / PANELS, 0);
+        }
+    }
+
+    QuadratureResult result = {0.0, 0.0, 2 * PANELS + 1};
+    for (int p = 0; p < PANELS; p++) {
+        result.value += panels[p].value;
+        result.error += panels[p].error;
+        result.evaluations += panels[p].evaluations;
+    }
+    return result;
+}
+
+const char* quadrature_method_name(QuadratureMethod method) {
+    switch (method) {
+        case QUADRATURE_TRAPEZOID:
+            return "trapezoid";
+        case QUADRATURE_SIMPSON:
+            return "simpson";
+        case QUADRATURE_ADAPTIVE:
+            return "adaptive";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,47 @@
+#ifndef QUADRATURE_H
+#define QUADRATURE_H
+
+// Function to integrate. `f` is required; `f_batch`, when not NULL, fills
+// y[i] = f(x[i]) for n points at once, so that the integrand can be written
+// as a SIMD loop. `params` is passed through to both.
+typedef struct {
+    double (*f)(double x, const void* params);
+    void (*f_batch)(const double* x, double* y, int n, const void* params);
+    const void* params;
+} Integrand;
+
+typedef enum {
+    QUADRATURE_TRAPEZOID = 0,  // composite trapezoid rule, n + 1 evaluations
+    QUADRATURE_SIMPSON,        // Simpson's rule on every interval (midpoint
+                               // included), 2n + 1 evaluations
+    QUADRATURE_ADAPTIVE,       // adaptive Simpson, refined where the local
+                               // error estimate is above the tolerance
+    QUADRATURE_NUM_METHODS
+} QuadratureMethod;
+
+typedef struct {
+    double value;
+    double error;  // estimated absolute error; 0 for the uniform rules
+    long long evaluations;
+} QuadratureResult;
+
+// Integral of `f` over [a, b] with a uniform rule on `n_intervals` equal
+// intervals, on `n_threads` OpenMP threads (0 = omp_get_max_threads()).
+// The points are handed out in blocks, so any interval and thread count
+// works; every block is summed with an OpenMP SIMD reduction.
+QuadratureResult integrate_uniform(const Integrand* f, double a, double b,
+                                   long long n_intervals,
+                                   QuadratureMethod method, int n_threads);
+
+// Integral of `f` over [a, b] to an absolute `tolerance` with adaptive
+// Simpson. Every interval whose two halves disagree by more than 15 times
+// its share of the tolerance is split, and the halves become OpenMP tasks,
+// so threads keep busy however unevenly the refinement is spread. Intervals
+// stop splitting after 50 levels; the error estimate then stays above the
+// tolerance. The result does not depend on the thread count.
+QuadratureResult integrate_adaptive(const Integrand* f, double a, double b,
+                                    double tolerance, int n_threads);
+
+const char* quadrature_method_name(QuadratureMethod method);
+
+#endif  // QUADRATURE_H